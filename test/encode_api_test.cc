@@ -360,4 +360,75 @@ TEST(EncodeAPI, ConfigChangeThreadCount) {
   }
 }
 
+#if CONFIG_VP9_ENCODER
+TEST(EncodeAPI, VP9LadderInfo) {
+  constexpr int kWidth = 320;
+  constexpr int kHeight = 240;
+  constexpr unsigned int kRows = (kHeight + 7) / 8;
+  constexpr unsigned int kCols = (kWidth + 7) / 8;
+  const vpx_codec_iface_t *const iface = vpx_codec_vp9_cx();
+  vpx_codec_enc_cfg_t cfg;
+  vpx_codec_ctx_t analysis;
+  vpx_codec_ctx_t dependent;
+  vpx_ladder_block_t blocks[kRows * kCols];
+  vpx_ladder_info_t info;
+
+  EXPECT_NO_FATAL_FAILURE(InitCodec(*iface, kWidth, kHeight, &analysis, &cfg));
+  EXPECT_NO_FATAL_FAILURE(
+      InitCodec(*iface, kWidth / 2, kHeight / 2, &dependent, &cfg));
+
+  info.blocks = blocks;
+  info.rows = kRows;
+  info.cols = kCols;
+  // Nothing was encoded yet.
+  EXPECT_EQ(vpx_codec_control(&analysis, VP9E_GET_LADDER_INFO, &info),
+            VPX_CODEC_INVALID_PARAM);
+
+  libvpx_test::DummyVideoSource video;
+  libvpx_test::DummyVideoSource small_video;
+  video.SetSize(kWidth, kHeight);
+  small_video.SetSize(kWidth / 2, kHeight / 2);
+  video.Begin();
+  small_video.Begin();
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(vpx_codec_encode(&analysis, video.img(), video.pts(),
+                               video.duration(), 0, VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+
+    info.rows = kRows - 1;
+    EXPECT_EQ(vpx_codec_control(&analysis, VP9E_GET_LADDER_INFO, &info),
+              VPX_CODEC_INVALID_PARAM);
+    info.rows = kRows;
+    ASSERT_EQ(vpx_codec_control(&analysis, VP9E_GET_LADDER_INFO, &info),
+              VPX_CODEC_OK);
+    EXPECT_EQ(info.width, static_cast<unsigned int>(kWidth));
+    EXPECT_EQ(info.height, static_cast<unsigned int>(kHeight));
+    for (const vpx_ladder_block_t &block : blocks) {
+      EXPECT_GE(block.width, 4);
+      EXPECT_LE(block.width, 64);
+      EXPECT_GE(block.height, 4);
+      EXPECT_LE(block.height, 64);
+      EXPECT_GE(block.motion.ref_frame, 0);
+      EXPECT_LE(block.motion.ref_frame, 3);
+    }
+
+    info.width = kWidth + 8;
+    EXPECT_EQ(vpx_codec_control(&dependent, VP9E_SET_LADDER_INFO, &info),
+              VPX_CODEC_INVALID_PARAM);
+    info.width = kWidth;
+    EXPECT_EQ(vpx_codec_control(&dependent, VP9E_SET_LADDER_INFO, &info),
+              VPX_CODEC_OK);
+    ASSERT_EQ(vpx_codec_encode(&dependent, small_video.img(),
+                               small_video.pts(), small_video.duration(), 0,
+                               VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+    video.Next();
+    small_video.Next();
+  }
+
+  EXPECT_EQ(vpx_codec_destroy(&analysis), VPX_CODEC_OK);
+  EXPECT_EQ(vpx_codec_destroy(&dependent), VPX_CODEC_OK);
+}
+#endif  // CONFIG_VP9_ENCODER
+
 }  // namespace
@@ -59,7 +59,8 @@ class VP9EncodePerfTest
  protected:
   VP9EncodePerfTest()
       : EncoderTest(GET_PARAM(0)), min_psnr_(kMaxPsnr), nframes_(0),
-        encoding_mode_(GET_PARAM(1)), speed_(0), threads_(1) {}
+        encoding_mode_(GET_PARAM(1)), speed_(0), threads_(1),
+        thread_change_interval_(0) {}
 
   virtual ~VP9EncodePerfTest() {}
 
@@ -84,6 +85,33 @@ class VP9EncodePerfTest
 
   virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
                                   ::libvpx_test::Encoder *encoder) {
+    if (thread_change_interval_ > 0) {
+      // Attribute the time since the last frame to that frame.
+      if (video->frame() > 0) {
+        vpx_usec_timer_mark(&frame_timer_);
+        const int64_t elapsed = vpx_usec_timer_elapsed(&frame_timer_);
+        if (thread_changed_) {
+          changed_frame_usecs_ += elapsed;
+          ++changed_frames_;
+        } else {
+          steady_frame_usecs_ += elapsed;
+          ++steady_frames_;
+        }
+      }
+      thread_changed_ = false;
+      if (video->img() != NULL && video->frame() > 0 &&
+          video->frame() % thread_change_interval_ == 0) {
+        cfg_.g_threads = (cfg_.g_threads == threads_) ? 1 : threads_;
+        cfg_.g_w = video->img()->d_w;
+        cfg_.g_h = video->img()->d_h;
+        vpx_usec_timer t;
+        vpx_usec_timer_start(&t);
+        encoder->Config(&cfg_);
+        vpx_usec_timer_mark(&t);
+        config_usecs_ += vpx_usec_timer_elapsed(&t);
+        thread_changed_ = true;
+      }
+    }
     if (video->frame() == 0) {
       const int log2_tile_columns = 3;
       encoder->Control(VP8E_SET_CPUUSED, speed_);
@@ -91,11 +119,18 @@ class VP9EncodePerfTest
       encoder->Control(VP9E_SET_FRAME_PARALLEL_DECODING, 1);
       encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 0);
     }
+    if (thread_change_interval_ > 0) vpx_usec_timer_start(&frame_timer_);
   }
 
   virtual void BeginPassHook(unsigned int /*pass*/) {
     min_psnr_ = kMaxPsnr;
     nframes_ = 0;
+    thread_changed_ = false;
+    config_usecs_ = 0;
+    changed_frame_usecs_ = 0;
+    steady_frame_usecs_ = 0;
+    changed_frames_ = 0;
+    steady_frames_ = 0;
   }
 
   virtual void PSNRPktHook(const vpx_codec_cx_pkt_t *pkt) {
@@ -113,12 +148,26 @@ class VP9EncodePerfTest
 
   void set_threads(unsigned int threads) { threads_ = threads; }
 
+  // Switches between threads_ and a single thread every interval frames.
+  void set_thread_change_interval(int interval) {
+    thread_change_interval_ = interval;
+  }
+
+  int64_t config_usecs_;
+  int64_t changed_frame_usecs_;
+  int64_t steady_frame_usecs_;
+  int changed_frames_;
+  int steady_frames_;
+
  private:
   double min_psnr_;
   unsigned int nframes_;
   libvpx_test::TestMode encoding_mode_;
   unsigned speed_;
   unsigned int threads_;
+  int thread_change_interval_;
+  bool thread_changed_;
+  vpx_usec_timer frame_timer_;
 };
 
 TEST_P(VP9EncodePerfTest, PerfTest) {
@@ -183,6 +232,46 @@ TEST_P(VP9EncodePerfTest, PerfTest) {
   }
 }
 
+// Measures the latency of changing the number of threads between frames:
+// the vpx_codec_enc_config_set() call and the encode time of the first frame
+// after each change, compared with the other frames.
+TEST_P(VP9EncodePerfTest, ThreadChangePerfTest) {
+  const EncodePerfTestVideo &test_video = kVP9EncodePerfTestVectors[8];
+  const int kThreadChangeInterval = 10;
+  const unsigned int kThreads = 4;
+
+  set_threads(kThreads);
+  set_thread_change_interval(kThreadChangeInterval);
+  SetUp();
+
+  const vpx_rational timebase = { 33333333, 1000000000 };
+  cfg_.g_timebase = timebase;
+  cfg_.rc_target_bitrate = test_video.bitrate;
+  init_flags_ = VPX_CODEC_USE_PSNR;
+
+  libvpx_test::I420VideoSource video(test_video.name, test_video.width,
+                                     test_video.height, timebase.den,
+                                     timebase.num, 0, test_video.frames);
+  set_speed(7);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_GT(changed_frames_, 0);
+  ASSERT_GT(steady_frames_, 0);
+
+  printf("{\n");
+  printf("\t\"type\" : \"encode_thread_change_perf_test\",\n");
+  printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
+  printf("\t\"videoName\" : \"%s\",\n", test_video.name);
+  printf("\t\"threadChanges\" : %d,\n", changed_frames_);
+  printf("\t\"configSetUsecs\" : %f,\n",
+         static_cast<double>(config_usecs_) / changed_frames_);
+  printf("\t\"changedFrameUsecs\" : %f,\n",
+         static_cast<double>(changed_frame_usecs_) / changed_frames_);
+  printf("\t\"steadyFrameUsecs\" : %f,\n",
+         static_cast<double>(steady_frame_usecs_) / steady_frames_);
+  printf("\t\"threads\" : %u\n", kThreads);
+  printf("}\n");
+}
+
 VP9_INSTANTIATE_TEST_SUITE(VP9EncodePerfTest,
                            ::testing::Values(::libvpx_test::kRealTime));
 }  // namespace
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+
+namespace {
+
+const int kMaxPSNR = 100;
+
+class MotionHintsTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith3Params<libvpx_test::TestMode, int,
+                                                 int> {
+ protected:
+  static const int kWidth = 208;
+  static const int kHeight = 144;
+  static const int kCols = (kWidth + 7) / 8;
+  static const int kRows = (kHeight + 7) / 8;
+
+  MotionHintsTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)), trusted_(GET_PARAM(3)), min_psnr_(kMaxPSNR),
+        hints_(kRows * kCols) {}
+  virtual ~MotionHintsTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    if (encoding_mode_ != ::libvpx_test::kRealTime) {
+      cfg_.g_lag_in_frames = 25;
+      cfg_.rc_end_usage = VPX_VBR;
+    } else {
+      cfg_.g_lag_in_frames = 0;
+      cfg_.rc_end_usage = VPX_CBR;
+    }
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) { min_psnr_ = kMaxPSNR; }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, cpu_used_);
+      return;
+    }
+    // Mostly small motion, with some hints far outside of the frame.
+    libvpx_test::ACMRandom rnd(video->frame());
+    for (size_t i = 0; i < hints_.size(); ++i) {
+      const int range = rnd(8) == 0 ? 4096 : 64;
+      hints_[i].mv_row = static_cast<int16_t>(rnd(2 * range) - range);
+      hints_[i].mv_col = static_cast<int16_t>(rnd(2 * range) - range);
+      hints_[i].ref_frame = static_cast<int8_t>(rnd(4));
+    }
+    vpx_motion_hints_t motion_hints = vpx_motion_hints_t();
+    motion_hints.hints = &hints_[0];
+    motion_hints.rows = kRows;
+    motion_hints.cols = kCols;
+    motion_hints.trusted = trusted_;
+    encoder->Control(VP9E_SET_MOTION_HINTS, &motion_hints);
+  }
+
+  virtual void PSNRPktHook(const vpx_codec_cx_pkt_t *pkt) {
+    if (pkt->data.psnr.psnr[0] < min_psnr_) min_psnr_ = pkt->data.psnr.psnr[0];
+  }
+
+  ::libvpx_test::TestMode encoding_mode_;
+  int cpu_used_;
+  int trusted_;
+  double min_psnr_;
+  std::vector<vpx_motion_hint_t> hints_;
+};
+
+TEST_P(MotionHintsTest, TestQ0) {
+  // The hints must only steer the motion search: the lossless encode stays
+  // lossless and decodes without a mismatch.
+  cfg_.rc_target_bitrate = 400;
+  cfg_.rc_max_quantizer = 0;
+  cfg_.rc_min_quantizer = 0;
+
+  ::libvpx_test::I420VideoSource video("hantro_odd.yuv", kWidth, kHeight, 30, 1,
+                                       0, 20);
+
+  init_flags_ = VPX_CODEC_USE_PSNR;
+
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_GE(min_psnr_, kMaxPSNR);
+}
+
+TEST_P(MotionHintsTest, TestLowBitrate) {
+  cfg_.rc_target_bitrate = 200;
+  cfg_.rc_min_quantizer = 40;
+
+  ::libvpx_test::I420VideoSource video("hantro_odd.yuv", kWidth, kHeight, 30, 1,
+                                       0, 20);
+
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+}
+
+VP9_INSTANTIATE_TEST_SUITE(MotionHintsTest,
+                           ::testing::Values(::libvpx_test::kTwoPassGood,
+                                             ::libvpx_test::kOnePassGood,
+                                             ::libvpx_test::kRealTime),
+                           ::testing::Values(1, 7), ::testing::Values(0, 1));
+}  // namespace
@@ -37,6 +37,8 @@ typedef void (*VP8Quantize)(BLOCK *b, BLOCKD *d);
 
 typedef std::tuple<VP8Quantize, VP8Quantize> VP8QuantizeParam;
 
+typedef void (*VP8QuantizeBlocks)(BLOCK *b, BLOCKD *d, int count);
+
 using libvpx_test::ACMRandom;
 using std::make_tuple;
 
@@ -181,12 +183,76 @@ TEST_P(QuantizeTest, DISABLED_Speed) {
   PrintMedian("vp8 quantize");
 }
 
+// Quantizes the planes of a macroblock in one call each and compares with
+// the per block C quantizer.
+class QuantizeBlocksTest : public QuantizeTestBase,
+                           public ::testing::TestWithParam<VP8QuantizeBlocks>,
+                           public AbstractBench {
+ protected:
+  virtual void SetUp() {
+    SetupCompressor();
+    quant_blocks_ = GetParam();
+  }
+
+  virtual void Run() {
+    quant_blocks_(&vp8_comp_->mb.block[0], &macroblockd_dst_->block[0], 16);
+    quant_blocks_(&vp8_comp_->mb.block[16], &macroblockd_dst_->block[16], 8);
+  }
+
+  void RunComparison() {
+    for (int i = 0; i < kNumBlocks; ++i) {
+      vp8_fast_quantize_b_c(&vp8_comp_->mb.block[i],
+                            &vp8_comp_->mb.e_mbd.block[i]);
+    }
+    ASM_REGISTER_STATE_CHECK(Run());
+    // The second order block is not part of a plane.
+    vp8_fast_quantize_b_c(&vp8_comp_->mb.block[24],
+                          &macroblockd_dst_->block[24]);
+
+    CheckOutput();
+  }
+
+ private:
+  VP8QuantizeBlocks quant_blocks_;
+};
+
+TEST_P(QuantizeBlocksTest, TestZeroInput) {
+  FillCoeffConstant(0);
+  RunComparison();
+}
+
+TEST_P(QuantizeBlocksTest, TestRandomInput) {
+  FillCoeffRandom();
+  RunComparison();
+}
+
+TEST_P(QuantizeBlocksTest, TestMultipleQ) {
+  for (int q = 0; q < QINDEX_RANGE; ++q) {
+    UpdateQuantizer(q);
+    FillCoeffRandom();
+    RunComparison();
+  }
+}
+
+TEST_P(QuantizeBlocksTest, DISABLED_Speed) {
+  FillCoeffRandom();
+
+  RunNTimes(1000000);
+  PrintMedian("vp8 quantize 24 blocks");
+}
+
+INSTANTIATE_TEST_SUITE_P(C, QuantizeBlocksTest,
+                         ::testing::Values(&vp8_fast_quantize_blocks_c));
+
 #if HAVE_SSE2
 INSTANTIATE_TEST_SUITE_P(
     SSE2, QuantizeTest,
     ::testing::Values(
         make_tuple(&vp8_fast_quantize_b_sse2, &vp8_fast_quantize_b_c),
         make_tuple(&vp8_regular_quantize_b_sse2, &vp8_regular_quantize_b_c)));
+
+INSTANTIATE_TEST_SUITE_P(SSE2, QuantizeBlocksTest,
+                         ::testing::Values(&vp8_fast_quantize_blocks_sse2));
 #endif  // HAVE_SSE2
 
 #if HAVE_SSSE3
@@ -203,6 +269,15 @@ INSTANTIATE_TEST_SUITE_P(
                                  &vp8_regular_quantize_b_c)));
 #endif  // HAVE_SSE4_1
 
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, QuantizeTest,
+                         ::testing::Values(make_tuple(&vp8_fast_quantize_b_avx2,
+                                                      &vp8_fast_quantize_b_c)));
+
+INSTANTIATE_TEST_SUITE_P(AVX2, QuantizeBlocksTest,
+                         ::testing::Values(&vp8_fast_quantize_blocks_avx2));
+#endif  // HAVE_AVX2
+
 #if HAVE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, QuantizeTest,
                          ::testing::Values(make_tuple(&vp8_fast_quantize_b_neon,
@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstdio>
+#include <tuple>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+#include "vpx/vpx_encoder.h"
+#include "vpx_ports/vpx_timer.h"
+
+namespace {
+
+#if CONFIG_ERROR_CONCEALMENT && CONFIG_VP8_DECODER
+const int kNumFrames = 30;
+
+typedef std::vector<uint8_t> Packet;
+
+// Encodes the clip with 4 token partitions, the way a lossy conferencing
+// stream is sent.
+void EncodeClip(std::vector<Packet> *packets) {
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       30, 1, 0, kNumFrames);
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(&vpx_codec_vp8_cx_algo, &cfg, 0));
+  cfg.g_w = 352;
+  cfg.g_h = 288;
+  cfg.g_lag_in_frames = 0;
+  cfg.g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT;
+  cfg.rc_end_usage = VPX_CBR;
+  cfg.rc_target_bitrate = 800;
+  cfg.kf_mode = VPX_KF_DISABLED;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_init(&enc, &vpx_codec_vp8_cx_algo, &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, -6));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP8E_SET_TOKEN_PARTITIONS,
+                              VP8_FOUR_TOKENPARTITION));
+
+  ASSERT_NO_FATAL_FAILURE(video.Begin());
+  for (; video.img(); video.Next()) {
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc, video.img(), video.pts(), video.duration(),
+                               0, VPX_DL_REALTIME));
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      const uint8_t *const buf =
+          reinterpret_cast<const uint8_t *>(pkt->data.frame.buf);
+      packets->push_back(Packet(buf, buf + pkt->data.frame.sz));
+    }
+  }
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+// Returns the part of frame i that arrives. The tail of some frames is lost,
+// down into the modes and motion vectors for some of them, and others are lost
+// completely.
+size_t ReceivedSize(int i, const Packet &packet) {
+  if (i == 0) return packet.size();
+  switch (i % 6) {
+    case 1: return packet.size() / 2;
+    case 3: return packet.size() / 10;
+    case 5: return 2;
+    default: return packet.size();
+  }
+}
+
+class VP8ErrorConcealmentTest
+    : public ::testing::TestWithParam<std::tuple<int, int> > {
+ protected:
+  static void SetUpTestSuite() {
+    packets_ = new std::vector<Packet>;
+    EncodeClip(packets_);
+  }
+
+  static void TearDownTestSuite() {
+    delete packets_;
+    packets_ = NULL;
+  }
+
+  // Decodes the lossy stream, returns the average PSNR of the frames.
+  double DecodeLossyStream(int threads, int row_ec) {
+    vpx_codec_ctx_t dec;
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352,
+                                         288, 30, 1, 0, kNumFrames);
+    double psnr_sum = 0.0;
+    int frames = 0;
+
+    cfg.threads = threads;
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_dec_init(&dec, &vpx_codec_vp8_dx_algo, &cfg,
+                                 VPX_CODEC_USE_ERROR_CONCEALMENT));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP8D_SET_ROW_EC, row_ec));
+
+    video.Begin();
+    for (size_t i = 0; i < packets_->size() && video.img(); ++i) {
+      const Packet &packet = (*packets_)[i];
+      vpx_codec_iter_t iter = NULL;
+      vpx_image_t *img;
+      EXPECT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(&dec, &packet[0],
+                                 static_cast<unsigned int>(
+                                     ReceivedSize(static_cast<int>(i), packet)),
+                                 NULL, 0))
+          << "frame " << i << ": " << vpx_codec_error_detail(&dec);
+      img = vpx_codec_get_frame(&dec, &iter);
+      EXPECT_TRUE(img != NULL) << "frame " << i;
+      if (img != NULL) {
+        psnr_sum += compute_psnr(video.img(), img);
+        ++frames;
+      }
+      video.Next();
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+    return frames ? psnr_sum / frames : 0.0;
+  }
+
+  static std::vector<Packet> *packets_;
+};
+
+std::vector<Packet> *VP8ErrorConcealmentTest::packets_ = NULL;
+
+TEST_P(VP8ErrorConcealmentTest, ConcealsLostData) {
+  const int threads = std::get<0>(GetParam());
+  const int row_ec = std::get<1>(GetParam());
+
+  ASSERT_EQ(static_cast<size_t>(kNumFrames), packets_->size());
+
+  // Every frame is decoded and concealed, also by the multithreaded decoder.
+  // Concealing row by row may be a little worse than with the whole frame
+  // estimate of the motion, but not much.
+  const double frame_psnr = DecodeLossyStream(1, 0);
+  const double psnr = DecodeLossyStream(threads, row_ec);
+  EXPECT_GT(psnr, 20.0);
+  EXPECT_GT(psnr, frame_psnr - 1.0);
+}
+
+TEST_P(VP8ErrorConcealmentTest, DISABLED_Speed) {
+  const int threads = std::get<0>(GetParam());
+  const int row_ec = std::get<1>(GetParam());
+  const int kRuns = 20;
+  vpx_usec_timer timer;
+
+  vpx_usec_timer_start(&timer);
+  for (int i = 0; i < kRuns; ++i) DecodeLossyStream(threads, row_ec);
+  vpx_usec_timer_mark(&timer);
+
+  const int elapsed_time = static_cast<int>(vpx_usec_timer_elapsed(&timer));
+  printf("threads %d row_ec %d: %5d us per lossy stream\n", threads, row_ec,
+         elapsed_time / kRuns);
+}
+
+INSTANTIATE_TEST_SUITE_P(VP8, VP8ErrorConcealmentTest,
+                         ::testing::Combine(::testing::Values(1, 4),
+                                            ::testing::Values(0, 1)));
+#endif  // CONFIG_ERROR_CONCEALMENT && CONFIG_VP8_DECODER
+
+}  // namespace
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+
+namespace {
+
+class VP8EncoderThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<libvpx_test::TestMode, int> {
+ protected:
+  VP8EncoderThreadTest()
+      : EncoderTest(GET_PARAM(0)), encoder_initialized_(false),
+        encoding_mode_(GET_PARAM(1)), token_partitions_(GET_PARAM(2)) {}
+  virtual ~VP8EncoderThreadTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+
+    if (encoding_mode_ == ::libvpx_test::kRealTime) {
+      cfg_.g_lag_in_frames = 0;
+      cfg_.rc_end_usage = VPX_CBR;
+    } else {
+      cfg_.g_lag_in_frames = 25;
+      cfg_.rc_end_usage = VPX_VBR;
+    }
+    cfg_.rc_target_bitrate = 1000;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) {
+    encoder_initialized_ = false;
+  }
+
+  virtual void StatsPktHook(const vpx_codec_cx_pkt_t *pkt) {
+    first_pass_stats_.append(
+        reinterpret_cast<const char *>(pkt->data.twopass_stats.buf),
+        pkt->data.twopass_stats.sz);
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource * /*video*/,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (!encoder_initialized_) {
+      encoder->Control(VP8E_SET_TOKEN_PARTITIONS, token_partitions_);
+      if (encoding_mode_ == ::libvpx_test::kRealTime) {
+        encoder->Control(VP8E_SET_CPUUSED, -6);
+      } else {
+        encoder->Control(VP8E_SET_CPUUSED, 2);
+        encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
+        encoder->Control(VP8E_SET_ARNR_MAXFRAMES, 7);
+        encoder->Control(VP8E_SET_ARNR_STRENGTH, 5);
+        encoder->Control(VP8E_SET_ARNR_TYPE, 3);
+      }
+      encoder_initialized_ = true;
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    ::libvpx_test::MD5 md5_res;
+    md5_res.Add(reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
+                pkt->data.frame.sz);
+    md5_.push_back(md5_res.Get());
+  }
+
+  bool encoder_initialized_;
+  ::libvpx_test::TestMode encoding_mode_;
+  int token_partitions_;
+  std::vector<std::string> md5_;
+  std::string first_pass_stats_;
+};
+
+TEST_P(VP8EncoderThreadTest, EncoderResultTest) {
+  ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       30, 1, 0, 20);
+
+  // The threads encode rows of macroblocks and pack the token partitions. The
+  // rows coded on the threads do not match a single thread encode, but the
+  // output must not depend on the scheduling of the threads, and the decoder
+  // must match the encoder.
+  cfg_.g_threads = 4;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> first_md5 = md5_;
+  md5_.clear();
+
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> second_md5 = md5_;
+  md5_.clear();
+
+  ASSERT_EQ(first_md5, second_md5);
+}
+
+TEST_P(VP8EncoderThreadTest, FirstPassStatsTest) {
+  if (encoding_mode_ != ::libvpx_test::kTwoPassGood) return;
+
+  ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       30, 1, 0, 20);
+
+  // The first pass rows are shared between the threads, the statistics must
+  // match the single thread first pass.
+  cfg_.g_threads = 1;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::string single_thr_stats = first_pass_stats_;
+  first_pass_stats_.clear();
+
+  cfg_.g_threads = 4;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::string multi_thr_stats = first_pass_stats_;
+  first_pass_stats_.clear();
+
+  ASSERT_FALSE(single_thr_stats.empty());
+  ASSERT_TRUE(single_thr_stats == multi_thr_stats);
+}
+
+VP8_INSTANTIATE_TEST_SUITE(VP8EncoderThreadTest,
+                           ::testing::Values(::libvpx_test::kTwoPassGood,
+                                             ::libvpx_test::kRealTime),
+                           ::testing::Range(0, 4));
+}  // namespace
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vp8_rtcd.h"
+#include "./vpx_config.h"
+#include "test/acm_random.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "vp8/encoder/mr_scale.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+namespace {
+
+#if CONFIG_MULTITHREAD
+const int kNumResolutions = 3;
+const int kNumFrames = 20;
+
+void ImageToYv12(const vpx_image_t *img, YV12_BUFFER_CONFIG *yv12) {
+  memset(yv12, 0, sizeof(*yv12));
+  yv12->y_buffer = img->planes[VPX_PLANE_Y];
+  yv12->u_buffer = img->planes[VPX_PLANE_U];
+  yv12->v_buffer = img->planes[VPX_PLANE_V];
+  yv12->y_crop_width = img->d_w;
+  yv12->y_crop_height = img->d_h;
+  yv12->uv_crop_width = (img->d_w + 1) / 2;
+  yv12->uv_crop_height = (img->d_h + 1) / 2;
+  yv12->y_stride = img->stride[VPX_PLANE_Y];
+  yv12->uv_stride = img->stride[VPX_PLANE_U];
+}
+
+class VP8MultiResTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    vpx_rational_t dsf = { 2, 1 };
+    for (int i = 0; i < kNumResolutions; ++i) {
+      dsf_[i] = dsf;
+      ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_config_default(
+                                  &vpx_codec_vp8_cx_algo, &cfg_[i], 0));
+      cfg_[i].g_w = 352 >> i;
+      cfg_[i].g_h = 288 >> i;
+      cfg_[i].g_timebase.num = 1;
+      cfg_[i].g_timebase.den = 30;
+      cfg_[i].g_lag_in_frames = 0;
+      cfg_[i].rc_end_usage = VPX_CBR;
+      cfg_[i].rc_dropframe_thresh = 0;
+      cfg_[i].rc_target_bitrate = 600 >> i;
+      scaled_[i] = NULL;
+    }
+  }
+
+  virtual void TearDown() {
+    for (int i = 0; i < kNumResolutions; ++i) vpx_img_free(scaled_[i]);
+  }
+
+  // Encodes the clip at all the resolutions, returns the MD5 of the frames
+  // of each of them. The sequential encode is given the sources that the
+  // pipeline scales itself.
+  void Encode(bool pipeline, std::vector<std::string> *md5) {
+    vpx_codec_ctx_t enc[kNumResolutions];
+    const vpx_codec_flags_t flags = pipeline ? VPX_CODEC_USE_MR_PIPELINE : 0;
+    ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352,
+                                         288, 30, 1, 0, kNumFrames);
+
+    memset(enc, 0, sizeof(enc));
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init_multi(&enc[0], &vpx_codec_vp8_cx_algo, cfg_,
+                                       kNumResolutions, flags, dsf_));
+    for (int i = 0; i < kNumResolutions; ++i) {
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_control(&enc[i], VP8E_SET_CPUUSED, -6));
+    }
+
+    ASSERT_NO_FATAL_FAILURE(video.Begin());
+    for (; video.img(); video.Next()) {
+      vpx_image_t img[kNumResolutions];
+
+      img[0] = *video.img();
+      if (!pipeline) {
+        for (int i = 1; i < kNumResolutions; ++i) {
+          YV12_BUFFER_CONFIG src;
+          YV12_BUFFER_CONFIG dst;
+          if (!scaled_[i]) {
+            scaled_[i] = vpx_img_alloc(NULL, VPX_IMG_FMT_I420, cfg_[i].g_w,
+                                       cfg_[i].g_h, 16);
+            ASSERT_TRUE(scaled_[i] != NULL);
+          }
+          ImageToYv12(&img[i - 1], &src);
+          ImageToYv12(scaled_[i], &dst);
+          vp8_mr_scale_frame(&src, &dst);
+          img[i] = *scaled_[i];
+        }
+      }
+
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_encode(&enc[0], img, video.pts(), video.duration(),
+                                 0, VPX_DL_REALTIME));
+
+      for (int i = 0; i < kNumResolutions; ++i) {
+        vpx_codec_iter_t iter = NULL;
+        const vpx_codec_cx_pkt_t *pkt;
+        while ((pkt = vpx_codec_get_cx_data(&enc[i], &iter)) != NULL) {
+          if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+          ::libvpx_test::MD5 md5_res;
+          md5_res.Add(reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
+                      pkt->data.frame.sz);
+          md5[i].push_back(md5_res.Get());
+        }
+      }
+    }
+
+    for (int i = 0; i < kNumResolutions; ++i) {
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc[i]));
+    }
+  }
+
+  vpx_codec_enc_cfg_t cfg_[kNumResolutions];
+  vpx_rational_t dsf_[kNumResolutions];
+  vpx_image_t *scaled_[kNumResolutions];
+};
+
+TEST_F(VP8MultiResTest, PipelineMatchesSequentialEncode) {
+  std::vector<std::string> sequential_md5[kNumResolutions];
+  std::vector<std::string> pipeline_md5[kNumResolutions];
+
+  // The lower resolutions share their hints row by row while the higher ones
+  // are coded, the streams must not depend on the scheduling of the threads.
+  ASSERT_NO_FATAL_FAILURE(Encode(false, sequential_md5));
+  ASSERT_NO_FATAL_FAILURE(Encode(true, pipeline_md5));
+
+  for (int i = 0; i < kNumResolutions; ++i) {
+    ASSERT_EQ(static_cast<size_t>(kNumFrames), sequential_md5[i].size());
+    EXPECT_EQ(sequential_md5[i], pipeline_md5[i]) << "resolution " << i;
+  }
+}
+
+TEST_F(VP8MultiResTest, PipelineNeedsMultiResInit) {
+  vpx_codec_ctx_t enc;
+  EXPECT_NE(VPX_CODEC_OK,
+            vpx_codec_enc_init(&enc, &vpx_codec_vp8_cx_algo, &cfg_[0],
+                               VPX_CODEC_USE_MR_PIPELINE));
+}
+#endif  // CONFIG_MULTITHREAD
+
+#if HAVE_SSE2
+TEST(VP8MrDownscaleTest, SSE2MatchesC) {
+  const int kSrcStride = 96;
+  const int kDstStride = 48;
+  ::libvpx_test::ACMRandom rnd(::libvpx_test::ACMRandom::DeterministicSeed());
+  unsigned char src[kSrcStride * 64];
+  unsigned char ref[kDstStride * 32];
+  unsigned char dst[kDstStride * 32];
+
+  for (int i = 0; i < kSrcStride * 64; ++i) src[i] = rnd.Rand8();
+
+  // Widths around the 16 pixel step of the SIMD loop.
+  for (int width = 1; width <= 40; ++width) {
+    const int height = 1 + width % 32;
+    memset(ref, 0, sizeof(ref));
+    memset(dst, 0, sizeof(dst));
+    vp8_mr_downscale_2to1_c(src, kSrcStride, ref, kDstStride, width, height);
+    vp8_mr_downscale_2to1_sse2(src, kSrcStride, dst, kDstStride, width,
+                               height);
+    ASSERT_EQ(0, memcmp(ref, dst, sizeof(ref))) << "width " << width;
+  }
+}
+#endif  // HAVE_SSE2
+
+}  // namespace
@@ -10,9 +10,11 @@
 
 #include <fstream>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "./vpx_config.h"
 #include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
 #include "test/codec_factory.h"
 #include "test/encode_test_driver.h"
 #include "test/i420_video_source.h"
@@ -21,6 +23,7 @@
 #include "vp8/vp8_ratectrl_rtc.h"
 #include "vpx/vpx_codec.h"
 #include "vpx_ports/bitops.h"
+#include "vpx_ports/vpx_timer.h"
 
 namespace {
 
@@ -340,4 +343,214 @@ VP8_INSTANTIATE_TEST_SUITE(Vp8RcInterfaceTest,
                            ::testing::Values(200, 400, 1000),
                            ::testing::ValuesIn(kVp8RCTestVectors));
 
+// A stream of the batch: its configuration and the key frame interval.
+struct Vp8RcBatchStream {
+  int width;
+  int height;
+  int bitrate;
+  int layers;
+  int key_interval;
+};
+
+const Vp8RcBatchStream kVp8RcBatchStreams[] = {
+  { 640, 480, 400, 1, 100 },  { 320, 240, 200, 3, 3000 },
+  { 1280, 720, 1000, 2, 60 }, { 176, 144, 100, 1, 3000 },
+  { 640, 360, 600, 3, 90 },
+};
+const int kVp8RcBatchNumStreams =
+    sizeof(kVp8RcBatchStreams) / sizeof(kVp8RcBatchStreams[0]);
+
+libvpx::VP8RateControlRtcConfig BatchStreamConfig(
+    const Vp8RcBatchStream &stream) {
+  libvpx::VP8RateControlRtcConfig rc_cfg;
+  rc_cfg.width = stream.width;
+  rc_cfg.height = stream.height;
+  rc_cfg.max_quantizer = 60;
+  rc_cfg.min_quantizer = 2;
+  rc_cfg.target_bandwidth = stream.bitrate;
+  rc_cfg.buf_initial_sz = 600;
+  rc_cfg.buf_optimal_sz = 600;
+  rc_cfg.buf_sz = 1000;
+  rc_cfg.undershoot_pct = 50;
+  rc_cfg.overshoot_pct = 50;
+  rc_cfg.max_intra_bitrate_pct = 1000;
+  rc_cfg.framerate = 30.0;
+  rc_cfg.ts_number_layers = stream.layers;
+  if (stream.layers == 1) {
+    rc_cfg.layer_target_bitrate[0] = stream.bitrate;
+  } else {
+    for (int i = 0; i < stream.layers; ++i) {
+      rc_cfg.layer_target_bitrate[i] =
+          stream.bitrate * (i + 1 == stream.layers ? 100 : 40 + 20 * i) / 100;
+      rc_cfg.ts_rate_decimator[i] = 1 << (stream.layers - 1 - i);
+    }
+  }
+  return rc_cfg;
+}
+
+// Same pattern as Vp8RcInterfaceTest::SetLayerId(): frames 0, 4, 8... are on
+// layer 0, frames 2, 6... on layer 1 and the odd ones on the top layer.
+int BatchStreamLayerId(const Vp8RcBatchStream &stream, int frame) {
+  int phase = frame % (1 << (stream.layers - 1));
+  int layer = stream.layers - 1;
+  if (phase == 0) return 0;
+  while (phase % 2 == 0) {
+    phase /= 2;
+    --layer;
+  }
+  return layer;
+}
+
+// Size in bytes of a frame coded at |qp|, with some noise.
+uint64_t BatchStreamFrameSize(const Vp8RcBatchStream &stream,
+                              FRAME_TYPE frame_type, int qp,
+                              ::libvpx_test::ACMRandom *rnd) {
+  const int mbs = (stream.width >> 4) * (stream.height >> 4);
+  const int bits_per_mb = (frame_type == KEY_FRAME ? 40000 : 6000) / (qp + 4);
+  return (static_cast<uint64_t>(mbs) * bits_per_mb * (80 + rnd->Rand8() % 40)) /
+         (100 * 8);
+}
+
+// The streams of a batch are updated interleaved on one workspace, they must
+// get the same QPs as with a rate controller each.
+TEST(Vp8RcBatchTest, MatchesRateControlPerStream) {
+  const int kNumFrames = 400;
+  ::libvpx_test::ACMRandom rnd(::libvpx_test::ACMRandom::DeterministicSeed());
+  std::vector<std::unique_ptr<libvpx::VP8RateControlRTC> > rc_apis;
+  std::unique_ptr<libvpx::VP8RateControlRtcBatch> batch =
+      libvpx::VP8RateControlRtcBatch::Create();
+  ASSERT_TRUE(batch != nullptr);
+
+  for (int i = 0; i < kVp8RcBatchNumStreams; ++i) {
+    const libvpx::VP8RateControlRtcConfig rc_cfg =
+        BatchStreamConfig(kVp8RcBatchStreams[i]);
+    rc_apis.push_back(libvpx::VP8RateControlRTC::Create(rc_cfg));
+    ASSERT_TRUE(rc_apis.back() != nullptr);
+    EXPECT_EQ(i, batch->AddStream(rc_cfg));
+  }
+
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    int streams[kVp8RcBatchNumStreams];
+    FRAME_TYPE frame_types[kVp8RcBatchNumStreams];
+    int layer_ids[kVp8RcBatchNumStreams];
+    int qps[kVp8RcBatchNumStreams];
+    uint64_t sizes[kVp8RcBatchNumStreams];
+    int count = 0;
+
+    // Change the rate of some streams on the way, skip frames of others.
+    if (frame == kNumFrames / 2) {
+      for (int i = 0; i < kVp8RcBatchNumStreams; i += 2) {
+        Vp8RcBatchStream stream = kVp8RcBatchStreams[i];
+        stream.bitrate = stream.bitrate * 3 / 2;
+        const libvpx::VP8RateControlRtcConfig rc_cfg =
+            BatchStreamConfig(stream);
+        rc_apis[i]->UpdateRateControl(rc_cfg);
+        batch->UpdateRateControl(i, rc_cfg);
+      }
+    }
+    for (int i = kVp8RcBatchNumStreams - 1; i >= 0; --i) {
+      if (i == 3 && frame % 3 == 1) continue;
+      const Vp8RcBatchStream &stream = kVp8RcBatchStreams[i];
+      libvpx::VP8FrameParamsQpRTC frame_params;
+      frame_params.frame_type =
+          frame % stream.key_interval == 0 ? KEY_FRAME : INTER_FRAME;
+      frame_params.temporal_layer_id = BatchStreamLayerId(stream, frame);
+      rc_apis[i]->ComputeQP(frame_params);
+
+      streams[count] = i;
+      frame_types[count] = frame_params.frame_type;
+      layer_ids[count] = frame_params.temporal_layer_id;
+      ++count;
+    }
+
+    batch->ComputeQP(count, streams, frame_types, layer_ids, qps);
+
+    for (int j = 0; j < count; ++j) {
+      const int i = streams[j];
+      ASSERT_EQ(rc_apis[i]->GetQP(), qps[j])
+          << "stream " << i << " frame " << frame;
+      sizes[j] =
+          BatchStreamFrameSize(kVp8RcBatchStreams[i], frame_types[j], qps[j],
+                               &rnd);
+      rc_apis[i]->PostEncodeUpdate(sizes[j]);
+    }
+    batch->PostEncodeUpdate(count, streams, sizes);
+  }
+}
+
+TEST(Vp8RcBatchTest, DISABLED_Speed) {
+  const int kNumStreams = 1000;
+  const int kNumFrames = 300;
+  std::vector<std::unique_ptr<libvpx::VP8RateControlRTC> > rc_apis;
+  std::unique_ptr<libvpx::VP8RateControlRtcBatch> batch =
+      libvpx::VP8RateControlRtcBatch::Create();
+  std::vector<int> streams(kNumStreams);
+  std::vector<FRAME_TYPE> frame_types(kNumStreams);
+  std::vector<int> layer_ids(kNumStreams);
+  std::vector<int> qps(kNumStreams);
+  std::vector<uint64_t> sizes(kNumStreams);
+  vpx_usec_timer timer;
+
+  vpx_usec_timer_start(&timer);
+  for (int i = 0; i < kNumStreams; ++i) {
+    const Vp8RcBatchStream &stream =
+        kVp8RcBatchStreams[i % kVp8RcBatchNumStreams];
+    rc_apis.push_back(
+        libvpx::VP8RateControlRTC::Create(BatchStreamConfig(stream)));
+  }
+  vpx_usec_timer_mark(&timer);
+  const int64_t create_time = vpx_usec_timer_elapsed(&timer);
+
+  vpx_usec_timer_start(&timer);
+  for (int i = 0; i < kNumStreams; ++i) {
+    const Vp8RcBatchStream &stream =
+        kVp8RcBatchStreams[i % kVp8RcBatchNumStreams];
+    batch->AddStream(BatchStreamConfig(stream));
+    streams[i] = i;
+  }
+  vpx_usec_timer_mark(&timer);
+  const int64_t batch_create_time = vpx_usec_timer_elapsed(&timer);
+
+  int64_t elapsed_time = 0;
+  int64_t batch_elapsed_time = 0;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    for (int i = 0; i < kNumStreams; ++i) {
+      const Vp8RcBatchStream &stream =
+          kVp8RcBatchStreams[i % kVp8RcBatchNumStreams];
+      frame_types[i] =
+          frame % stream.key_interval == 0 ? KEY_FRAME : INTER_FRAME;
+      layer_ids[i] = BatchStreamLayerId(stream, frame);
+      sizes[i] = 2000 + (i + frame) % 500;
+    }
+
+    vpx_usec_timer_start(&timer);
+    for (int i = 0; i < kNumStreams; ++i) {
+      libvpx::VP8FrameParamsQpRTC frame_params;
+      frame_params.frame_type = frame_types[i];
+      frame_params.temporal_layer_id = layer_ids[i];
+      rc_apis[i]->ComputeQP(frame_params);
+      rc_apis[i]->PostEncodeUpdate(sizes[i]);
+    }
+    vpx_usec_timer_mark(&timer);
+    elapsed_time += vpx_usec_timer_elapsed(&timer);
+
+    vpx_usec_timer_start(&timer);
+    batch->ComputeQP(kNumStreams, &streams[0], &frame_types[0], &layer_ids[0],
+                     &qps[0]);
+    batch->PostEncodeUpdate(kNumStreams, &streams[0], &sizes[0]);
+    vpx_usec_timer_mark(&timer);
+    batch_elapsed_time += vpx_usec_timer_elapsed(&timer);
+  }
+
+  printf("%d streams: %d bytes of state per stream, %d with the batch\n",
+         kNumStreams, static_cast<int>(sizeof(VP8_COMP)),
+         static_cast<int>(sizeof(libvpx::VP8RateControlRtcStreamState)));
+  printf("create: %6d us, batch %6d us\n", static_cast<int>(create_time),
+         static_cast<int>(batch_create_time));
+  printf("frames: %6d ns per stream, batch %6d ns per stream\n",
+         static_cast<int>(elapsed_time * 1000 / kNumFrames / kNumStreams),
+         static_cast<int>(batch_elapsed_time * 1000 / kNumFrames /
+                          kNumStreams));
+}
+
 }  // namespace
@@ -391,6 +391,83 @@ TEST_P(VPxEncoderThreadTest, EncoderResultTest) {
   EXPECT_NEAR(single_thr_psnr, multi_thr_psnr, 0.2);
 }
 
+TEST_P(VPxEncoderThreadTest, DeterministicRowMtTest) {
+  ::libvpx_test::Y4mVideoSource video("niklas_1280_720_30.y4m", 15, 20);
+  cfg_.rc_target_bitrate = 1000;
+
+  // With row_mt_mode_ = 2 the encoder generates bit exact results for any
+  // number of threads, including a single thread.
+  row_mt_mode_ = 2;
+
+  // Encode using single thread.
+  cfg_.g_threads = 1;
+  init_flags_ = VPX_CODEC_USE_PSNR;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> single_thr_md5 = md5_;
+  md5_.clear();
+
+  // Encode using multiple threads.
+  cfg_.g_threads = threads_;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> multi_thr_md5 = md5_;
+  md5_.clear();
+
+  // Compare to check if two vectors are equal.
+  ASSERT_EQ(single_thr_md5, multi_thr_md5);
+}
+
+// Changes the number of threads between frames.
+class VPxEncoderDynamicThreadTest : public VPxEncoderThreadTest {
+ protected:
+  VPxEncoderDynamicThreadTest() : change_threads_(false) {}
+  virtual ~VPxEncoderDynamicThreadTest() {}
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    VPxEncoderThreadTest::PreEncodeFrameHook(video, encoder);
+    if (video->img() != NULL && video->frame() > 0 &&
+        video->frame() % 4 == 0) {
+      // Grow past the initial pool, drop to a single thread and come back.
+      // The configuration is set in both runs so that only the number of
+      // threads differs.
+      const int thread_schedule[] = { 1, threads_ + 2, 2, threads_ };
+      if (change_threads_) {
+        cfg_.g_threads = static_cast<unsigned int>(
+            thread_schedule[(video->frame() / 4 - 1) % 4]);
+      }
+      cfg_.g_w = video->img()->d_w;
+      cfg_.g_h = video->img()->d_h;
+      encoder->Config(&cfg_);
+    }
+  }
+
+  bool change_threads_;
+};
+
+TEST_P(VPxEncoderDynamicThreadTest, ChangeThreadsTest) {
+  ::libvpx_test::Y4mVideoSource video("niklas_1280_720_30.y4m", 15, 20);
+  cfg_.rc_target_bitrate = 1000;
+  row_mt_mode_ = 2;
+  init_flags_ = VPX_CODEC_USE_PSNR;
+
+  // Encode using a fixed number of threads.
+  cfg_.g_threads = threads_;
+  change_threads_ = false;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> fixed_thr_md5 = md5_;
+  md5_.clear();
+
+  // Encode changing the number of threads every 4 frames. The workers are
+  // parked and reused, and the output does not depend on the thread count.
+  cfg_.g_threads = threads_;
+  change_threads_ = true;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> changed_thr_md5 = md5_;
+  md5_.clear();
+
+  ASSERT_EQ(fixed_thr_md5, changed_thr_md5);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     VP9, VPxFirstPassEncoderThreadTest,
     ::testing::Combine(
@@ -426,4 +503,15 @@ INSTANTIATE_TEST_SUITE_P(
         ::testing::Range(0, 3),    // tile_columns
         ::testing::Range(2, 5)));  // threads
 
+INSTANTIATE_TEST_SUITE_P(
+    VP9, VPxEncoderDynamicThreadTest,
+    ::testing::Combine(
+        ::testing::Values(
+            static_cast<const libvpx_test::CodecFactory *>(&libvpx_test::kVP9)),
+        ::testing::Values(::libvpx_test::kOnePassGood,
+                          ::libvpx_test::kRealTime),
+        ::testing::Values(2, 7),   // cpu_used
+        ::testing::Values(0, 2),   // tile_columns
+        ::testing::Values(2, 4)));  // threads
+
 }  // namespace
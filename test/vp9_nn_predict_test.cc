@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2023 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "./vp9_rtcd.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "vp9/encoder/vp9_nn.h"
+#include "vpx_ports/vpx_timer.h"
+
+using libvpx_test::ACMRandom;
+
+namespace {
+
+typedef void (*NnPredictFunc)(const float *features,
+                              const NN_CONFIG *nn_config, float *output);
+
+// Owns the weights and bias of a randomly shaped model.
+class RandomModel {
+ public:
+  RandomModel(ACMRandom *rnd, int num_inputs, int num_outputs,
+              const std::vector<int> &hidden_nodes)
+      : weights_(hidden_nodes.size() + 1), bias_(hidden_nodes.size() + 1) {
+    memset(&config_, 0, sizeof(config_));
+    config_.num_inputs = num_inputs;
+    config_.num_outputs = num_outputs;
+    config_.num_hidden_layers = static_cast<int>(hidden_nodes.size());
+    int layer_inputs = num_inputs;
+    for (size_t layer = 0; layer <= hidden_nodes.size(); ++layer) {
+      const int layer_outputs =
+          layer < hidden_nodes.size() ? hidden_nodes[layer] : num_outputs;
+      if (layer < hidden_nodes.size()) {
+        config_.num_hidden_nodes[layer] = layer_outputs;
+      }
+      weights_[layer].resize(layer_inputs * layer_outputs);
+      bias_[layer].resize(layer_outputs);
+      for (size_t i = 0; i < weights_[layer].size(); ++i) {
+        weights_[layer][i] = RandomFloat(rnd);
+      }
+      for (size_t i = 0; i < bias_[layer].size(); ++i) {
+        bias_[layer][i] = RandomFloat(rnd);
+      }
+      config_.weights[layer] = &weights_[layer][0];
+      config_.bias[layer] = &bias_[layer][0];
+      layer_inputs = layer_outputs;
+    }
+  }
+
+  static float RandomFloat(ACMRandom *rnd) {
+    return (rnd->Rand16Signed() / 16384.0f);
+  }
+
+  const NN_CONFIG *config() const { return &config_; }
+
+ private:
+  NN_CONFIG config_;
+  std::vector<std::vector<float> > weights_;
+  std::vector<std::vector<float> > bias_;
+};
+
+class NnPredictTest : public ::testing::TestWithParam<NnPredictFunc> {
+ public:
+  virtual ~NnPredictTest() {}
+  virtual void SetUp() { predict_ = GetParam(); }
+  virtual void TearDown() { libvpx_test::ClearSystemState(); }
+
+ protected:
+  NnPredictFunc predict_;
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(NnPredictTest);
+
+TEST_P(NnPredictTest, MatchesC) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int iter = 0; iter < 500; ++iter) {
+    const int num_inputs = 1 + rnd.PseudoUniform(24);
+    const int num_outputs = 1 + rnd.PseudoUniform(12);
+    std::vector<int> hidden_nodes(rnd.PseudoUniform(4));
+    for (size_t i = 0; i < hidden_nodes.size(); ++i) {
+      hidden_nodes[i] = 1 + rnd.PseudoUniform(NN_MAX_NODES_PER_LAYER - 1);
+    }
+    const RandomModel model(&rnd, num_inputs, num_outputs, hidden_nodes);
+    std::vector<float> features(num_inputs);
+    for (int i = 0; i < num_inputs; ++i) {
+      features[i] = RandomModel::RandomFloat(&rnd) * 4.0f;
+    }
+
+    std::vector<float> ref_output(num_outputs), output(num_outputs);
+    vp9_nn_predict_c(&features[0], model.config(), &ref_output[0]);
+    ASM_REGISTER_STATE_CHECK(
+        predict_(&features[0], model.config(), &output[0]));
+    for (int i = 0; i < num_outputs; ++i) {
+      // The partition decisions are made by thresholding the outputs, so they
+      // must match exactly.
+      ASSERT_EQ(ref_output[i], output[i])
+          << "iteration " << iter << " output " << i;
+    }
+  }
+}
+
+TEST_P(NnPredictTest, DISABLED_Speed) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  // The shapes of the rectangular partition pruning models.
+  const int kNumHiddenNodes[] = { 16, 24 };
+  const int kNumRuns = 1000000;
+  for (int n = 0; n < 2; ++n) {
+    const std::vector<int> hidden_nodes(1, kNumHiddenNodes[n]);
+    const RandomModel model(&rnd, 8, 4, hidden_nodes);
+    float features[8], output[4];
+    for (int i = 0; i < 8; ++i) features[i] = RandomModel::RandomFloat(&rnd);
+
+    vpx_usec_timer timer;
+    vpx_usec_timer_start(&timer);
+    for (int run = 0; run < kNumRuns; ++run) {
+      predict_(features, model.config(), output);
+    }
+    vpx_usec_timer_mark(&timer);
+    printf("8x%dx4: %d us\n", kNumHiddenNodes[n],
+           static_cast<int>(vpx_usec_timer_elapsed(&timer)));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(C, NnPredictTest,
+                         ::testing::Values(&vp9_nn_predict_c));
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_SUITE_P(SSE2, NnPredictTest,
+                         ::testing::Values(&vp9_nn_predict_sse2));
+#endif  // HAVE_SSE2
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, NnPredictTest,
+                         ::testing::Values(&vp9_nn_predict_avx2));
+#endif  // HAVE_AVX2
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, NnPredictTest,
+                         ::testing::Values(&vp9_nn_predict_neon));
+#endif  // HAVE_NEON
+
+}  // namespace
@@ -187,6 +187,9 @@ typedef struct {
   unsigned int skip_encoding_prev_stream;
   unsigned int skip_encoding_base_stream;
   LOWER_RES_MB_INFO *mb_info;
+  // With VPX_CODEC_USE_MR_PIPELINE, the encoder that vpx_codec_encode() most
+  // recently queued: the next lower resolution of the one it calls next.
+  void *mr_pending;
 } LOWER_RES_FRAME_INFO;
 #endif
 
@@ -146,7 +146,7 @@ if (vpx_config("CONFIG_POSTPROC") eq "yes") {
 # Subpixel
 #
 add_proto qw/void vp8_sixtap_predict16x16/, "unsigned char *src_ptr, int src_pixels_per_line, int xoffset, int yoffset, unsigned char *dst_ptr, int dst_pitch";
-specialize qw/vp8_sixtap_predict16x16 sse2 ssse3 neon dspr2 msa mmi lsx/;
+specialize qw/vp8_sixtap_predict16x16 sse2 ssse3 avx2 neon dspr2 msa mmi lsx/;
 
 add_proto qw/void vp8_sixtap_predict8x8/, "unsigned char *src_ptr, int src_pixels_per_line, int xoffset, int yoffset, unsigned char *dst_ptr, int dst_pitch";
 specialize qw/vp8_sixtap_predict8x8 sse2 ssse3 neon dspr2 msa mmi lsx/;
@@ -158,7 +158,7 @@ add_proto qw/void vp8_sixtap_predict4x4/, "unsigned char *src_ptr, int src_pixel
 specialize qw/vp8_sixtap_predict4x4 mmx ssse3 neon dspr2 msa mmi lsx/;
 
 add_proto qw/void vp8_bilinear_predict16x16/, "unsigned char *src_ptr, int src_pixels_per_line, int xoffset, int yoffset, unsigned char *dst_ptr, int dst_pitch";
-specialize qw/vp8_bilinear_predict16x16 sse2 ssse3 neon msa/;
+specialize qw/vp8_bilinear_predict16x16 sse2 ssse3 avx2 neon msa/;
 
 add_proto qw/void vp8_bilinear_predict8x8/, "unsigned char *src_ptr, int src_pixels_per_line, int xoffset, int yoffset, unsigned char *dst_ptr, int dst_pitch";
 specialize qw/vp8_bilinear_predict8x8 sse2 ssse3 neon msa/;
@@ -199,7 +199,11 @@ add_proto qw/void vp8_regular_quantize_b/, "struct block *, struct blockd *";
 specialize qw/vp8_regular_quantize_b sse2 sse4_1 msa mmi lsx/;
 
 add_proto qw/void vp8_fast_quantize_b/, "struct block *, struct blockd *";
-specialize qw/vp8_fast_quantize_b sse2 ssse3 neon msa mmi/;
+specialize qw/vp8_fast_quantize_b sse2 ssse3 avx2 neon msa mmi/;
+
+# Quantizes count consecutive blocks that share the quantizer of the first.
+add_proto qw/void vp8_fast_quantize_blocks/, "struct block *, struct blockd *, int count";
+specialize qw/vp8_fast_quantize_blocks sse2 avx2/;
 
 #
 # Block subtraction
@@ -245,6 +249,14 @@ if (vpx_config("CONFIG_TEMPORAL_DENOISING") eq "yes") {
     specialize qw/vp8_denoiser_filter_uv sse2 neon msa/;
 }
 
+#
+# Multi-resolution source downscaling
+#
+if (vpx_config("CONFIG_MULTI_RES_ENCODING") eq "yes") {
+    add_proto qw/void vp8_mr_downscale_2to1/, "const unsigned char *src, int src_stride, unsigned char *dst, int dst_stride, int width, int height";
+    specialize qw/vp8_mr_downscale_2to1 sse2/;
+}
+
 # End of encoder only functions
 }
 1;
@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "./vp8_rtcd.h"
+#include "./vpx_config.h"
+#include "vp8/common/filter.h"
+#include "vpx_ports/mem.h"
+
+/* Each 256-bit register holds two rows of the 16 wide block, row r in the
+ * low lane and row r + 1 in the high lane. The taps are at most 112 for a
+ * non zero offset, so the pairs are summed with _mm256_maddubs_epi16 and
+ * the intermediate rows stay 8 bit without any loss.
+ */
+
+static INLINE __m256i load_rows(const uint8_t *src, const int stride) {
+  const __m128i a = _mm_loadu_si128((const __m128i *)src);
+  const __m128i b = _mm_loadu_si128((const __m128i *)(src + stride));
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+}
+
+static INLINE void store_rows(uint8_t *dst, const int stride,
+                              const __m256i v) {
+  _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(v));
+  _mm_storeu_si128((__m128i *)(dst + stride), _mm256_extracti128_si256(v, 1));
+}
+
+static INLINE __m256i filter_pairs(const __m256i a, const __m256i b,
+                                   const __m256i filter) {
+  const __m256i round_factor = _mm256_set1_epi16(1 << (VP8_FILTER_SHIFT - 1));
+  __m256i lo = _mm256_maddubs_epi16(_mm256_unpacklo_epi8(a, b), filter);
+  __m256i hi = _mm256_maddubs_epi16(_mm256_unpackhi_epi8(a, b), filter);
+  lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round_factor), VP8_FILTER_SHIFT);
+  hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round_factor), VP8_FILTER_SHIFT);
+  return _mm256_packus_epi16(lo, hi);
+}
+
+static INLINE __m256i get_filter(const int offset) {
+  const short *const f = vp8_bilinear_filters[offset];
+  return _mm256_set1_epi16((short)((f[1] << 8) | f[0]));
+}
+
+static INLINE void horizontal_16xN(const uint8_t *src, const int src_stride,
+                                   uint8_t *dst, const int dst_stride,
+                                   const int xoffset, const int height) {
+  const __m256i filter = get_filter(xoffset);
+  int h;
+
+  for (h = 0; h < (height & ~1); h += 2) {
+    const __m256i a = load_rows(src, src_stride);
+    const __m256i b = load_rows(src + 1, src_stride);
+    store_rows(dst, dst_stride, filter_pairs(a, b, filter));
+    src += 2 * src_stride;
+    dst += 2 * dst_stride;
+  }
+
+  if (height & 1) {
+    const __m256i a =
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src));
+    const __m256i b =
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(src + 1)));
+    _mm_storeu_si128((__m128i *)dst,
+                     _mm256_castsi256_si128(filter_pairs(a, b, filter)));
+  }
+}
+
+static INLINE void vertical_16x16(const uint8_t *src, const int src_stride,
+                                  uint8_t *dst, const int dst_stride,
+                                  const int yoffset) {
+  const __m256i filter = get_filter(yoffset);
+  __m256i a = load_rows(src, src_stride);
+  int h;
+
+  for (h = 0; h < 14; h += 2) {
+    const __m256i c = load_rows(src + 2 * src_stride, src_stride);
+    /* Rows r + 1 and r + 2. */
+    const __m256i b = _mm256_permute2x128_si256(a, c, 0x21);
+    store_rows(dst, dst_stride, filter_pairs(a, b, filter));
+    a = c;
+    src += 2 * src_stride;
+    dst += 2 * dst_stride;
+  }
+
+  {
+    /* Only row 16 is left to read. */
+    const __m256i c = _mm256_castsi128_si256(
+        _mm_loadu_si128((const __m128i *)(src + 2 * src_stride)));
+    const __m256i b = _mm256_permute2x128_si256(a, c, 0x21);
+    store_rows(dst, dst_stride, filter_pairs(a, b, filter));
+  }
+}
+
+void vp8_bilinear_predict16x16_avx2(uint8_t *src_ptr, int src_pixels_per_line,
+                                    int xoffset, int yoffset, uint8_t *dst_ptr,
+                                    int dst_pitch) {
+  DECLARE_ALIGNED(32, uint8_t, FData[17 * 16]);
+
+  if (xoffset == 0 && yoffset == 0) {
+    vp8_copy_mem16x16(src_ptr, src_pixels_per_line, dst_ptr, dst_pitch);
+  } else if (yoffset == 0) {
+    horizontal_16xN(src_ptr, src_pixels_per_line, dst_ptr, dst_pitch, xoffset,
+                    16);
+  } else if (xoffset == 0) {
+    vertical_16x16(src_ptr, src_pixels_per_line, dst_ptr, dst_pitch, yoffset);
+  } else {
+    horizontal_16xN(src_ptr, src_pixels_per_line, FData, 16, xoffset, 17);
+    vertical_16x16(FData, 16, dst_ptr, dst_pitch, yoffset);
+  }
+}
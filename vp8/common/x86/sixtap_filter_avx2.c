@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "./vp8_rtcd.h"
+#include "./vpx_config.h"
+#include "vp8/common/filter.h"
+#include "vpx_ports/mem.h"
+
+/* The taps are applied in pairs with _mm256_maddubs_epi16: (0, 5), (1, 3)
+ * and (2, 4). No pair can saturate, and the outer taps are never negative, so
+ * once the sum of the first two pairs saturates the result clamps to 255 just
+ * like the C code.
+ */
+
+typedef struct {
+  __m256i k05;
+  __m256i k13;
+  __m256i k24;
+} SixtapFilter;
+
+static INLINE __m256i pair_taps(const short a, const short b) {
+  return _mm256_set1_epi16((short)((b << 8) | (a & 0xff)));
+}
+
+static INLINE void get_filter(const int offset, SixtapFilter *filter) {
+  const short *const f = vp8_sub_pel_filters[offset];
+  filter->k05 = pair_taps(f[0], f[5]);
+  filter->k13 = pair_taps(f[1], f[3]);
+  filter->k24 = pair_taps(f[2], f[4]);
+}
+
+static INLINE __m256i apply_taps(const __m256i p05, const __m256i p13,
+                                 const __m256i p24,
+                                 const SixtapFilter *filter) {
+  const __m256i round_factor = _mm256_set1_epi16(1 << (VP8_FILTER_SHIFT - 1));
+  const __m256i s05 = _mm256_maddubs_epi16(p05, filter->k05);
+  const __m256i s13 = _mm256_maddubs_epi16(p13, filter->k13);
+  const __m256i s24 = _mm256_maddubs_epi16(p24, filter->k24);
+  __m256i sum = _mm256_adds_epi16(s13, s24);
+  sum = _mm256_adds_epi16(sum, s05);
+  sum = _mm256_adds_epi16(sum, round_factor);
+  return _mm256_srai_epi16(sum, VP8_FILTER_SHIFT);
+}
+
+/* Columns 0 to 7 are filtered in the low lane from src - 2, columns 8 to 15
+ * in the high lane from src + 3 so that no load reads past src + 18.
+ */
+static INLINE __m256i filter_row_h(const uint8_t *src,
+                                   const SixtapFilter *filter) {
+  DECLARE_ALIGNED(32, static const uint8_t, shuf05[32]) = {
+    0, 5, 1, 6, 2, 7, 3, 8, 4, 9,  5, 10, 6, 11, 7, 12,
+    3, 8, 4, 9, 5, 10, 6, 11, 7, 12, 8, 13, 9, 14, 10, 15
+  };
+  DECLARE_ALIGNED(32, static const uint8_t, shuf13[32]) = {
+    1, 3, 2, 4, 3, 5, 4, 6, 5, 7, 6, 8, 7, 9, 8, 10,
+    4, 6, 5, 7, 6, 8, 7, 9, 8, 10, 9, 11, 10, 12, 11, 13
+  };
+  DECLARE_ALIGNED(32, static const uint8_t, shuf24[32]) = {
+    2, 4, 3, 5, 4, 6, 5, 7, 6, 8, 7, 9, 8, 10, 9, 11,
+    5, 7, 6, 8, 7, 9, 8, 10, 9, 11, 10, 12, 11, 13, 12, 14
+  };
+  const __m128i a = _mm_loadu_si128((const __m128i *)(src - 2));
+  const __m128i b = _mm_loadu_si128((const __m128i *)(src + 3));
+  const __m256i ab = _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+  const __m256i p05 =
+      _mm256_shuffle_epi8(ab, _mm256_load_si256((const __m256i *)shuf05));
+  const __m256i p13 =
+      _mm256_shuffle_epi8(ab, _mm256_load_si256((const __m256i *)shuf13));
+  const __m256i p24 =
+      _mm256_shuffle_epi8(ab, _mm256_load_si256((const __m256i *)shuf24));
+  return apply_taps(p05, p13, p24, filter);
+}
+
+static INLINE void horizontal_16xN(const uint8_t *src, const int src_stride,
+                                   uint8_t *dst, const int dst_stride,
+                                   const int xoffset, const int height) {
+  SixtapFilter filter;
+  int h;
+
+  get_filter(xoffset, &filter);
+
+  for (h = 0; h < (height & ~1); h += 2) {
+    const __m256i r0 = filter_row_h(src, &filter);
+    const __m256i r1 = filter_row_h(src + src_stride, &filter);
+    /* Lanes hold [r0 0-7, r1 0-7 | r0 8-15, r1 8-15]. */
+    const __m256i rows =
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(r0, r1), 0xd8);
+    _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(rows));
+    _mm_storeu_si128((__m128i *)(dst + dst_stride),
+                     _mm256_extracti128_si256(rows, 1));
+    src += 2 * src_stride;
+    dst += 2 * dst_stride;
+  }
+
+  if (height & 1) {
+    const __m256i r0 = filter_row_h(src, &filter);
+    const __m256i row =
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(r0, r0), 0xd8);
+    _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(row));
+  }
+}
+
+static INLINE __m256i load_rows(const uint8_t *src, const int stride) {
+  const __m128i a = _mm_loadu_si128((const __m128i *)src);
+  const __m128i b = _mm_loadu_si128((const __m128i *)(src + stride));
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+}
+
+/* src points two rows above the block. Rows r and r + 1 of the output are
+ * computed together, in the low and the high lane.
+ */
+static INLINE void vertical_16x16(const uint8_t *src, const int src_stride,
+                                  uint8_t *dst, const int dst_stride,
+                                  const int yoffset) {
+  SixtapFilter filter;
+  __m256i r01, r12, r23, r34;
+  int h;
+
+  get_filter(yoffset, &filter);
+
+  r01 = load_rows(src, src_stride);
+  r23 = load_rows(src + 2 * src_stride, src_stride);
+  r12 = _mm256_permute2x128_si256(r01, r23, 0x21);
+
+  for (h = 0; h < 16; h += 2) {
+    const __m256i r45 = load_rows(src + 4 * src_stride, src_stride);
+    const __m256i r56 = load_rows(src + 5 * src_stride, src_stride);
+    __m256i lo, hi;
+    r34 = _mm256_permute2x128_si256(r23, r45, 0x21);
+
+    lo = apply_taps(_mm256_unpacklo_epi8(r01, r56),
+                    _mm256_unpacklo_epi8(r12, r34),
+                    _mm256_unpacklo_epi8(r23, r45), &filter);
+    hi = apply_taps(_mm256_unpackhi_epi8(r01, r56),
+                    _mm256_unpackhi_epi8(r12, r34),
+                    _mm256_unpackhi_epi8(r23, r45), &filter);
+    lo = _mm256_packus_epi16(lo, hi);
+    _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(lo));
+    _mm_storeu_si128((__m128i *)(dst + dst_stride),
+                     _mm256_extracti128_si256(lo, 1));
+
+    r01 = r23;
+    r12 = r34;
+    r23 = r45;
+    src += 2 * src_stride;
+    dst += 2 * dst_stride;
+  }
+}
+
+void vp8_sixtap_predict16x16_avx2(uint8_t *src_ptr, int src_pixels_per_line,
+                                  int xoffset, int yoffset, uint8_t *dst_ptr,
+                                  int dst_pitch) {
+  DECLARE_ALIGNED(32, uint8_t, FData[21 * 16]);
+
+  if (xoffset == 0 && yoffset == 0) {
+    vp8_copy_mem16x16(src_ptr, src_pixels_per_line, dst_ptr, dst_pitch);
+  } else if (yoffset == 0) {
+    horizontal_16xN(src_ptr, src_pixels_per_line, dst_ptr, dst_pitch, xoffset,
+                    16);
+  } else if (xoffset == 0) {
+    vertical_16x16(src_ptr - 2 * src_pixels_per_line, src_pixels_per_line,
+                   dst_ptr, dst_pitch, yoffset);
+  } else {
+    horizontal_16xN(src_ptr - 2 * src_pixels_per_line, src_pixels_per_line,
+                    FData, 16, xoffset, 21);
+    vertical_16x16(FData, 16, dst_ptr, dst_pitch, yoffset);
+  }
+}
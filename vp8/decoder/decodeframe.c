@@ -532,6 +532,11 @@ static void decode_mb_rows(VP8D_COMP *pbi) {
       xd->mb_to_right_edge = ((pc->mb_cols - 1 - mb_col) * 16) << 3;
 
 #if CONFIG_ERROR_CONCEALMENT
+      if (pbi->ec_active && pbi->row_ec &&
+          (unsigned int)mb_idx >= pbi->mvs_corrupt_from_mb) {
+        /* The modes and motion vectors of this MB are missing. */
+        vp8_estimate_missing_mb_mvs(pbi, xd, mb_row, mb_col);
+      }
       {
         int corrupt_residual =
             (!pbi->independent_partitions && pbi->frame_corrupt_residual) ||
@@ -548,7 +553,8 @@ static void decode_mb_rows(VP8D_COMP *pbi) {
            * happens after this check, and therefore no inter concealment
            * will be done.
            */
-          vp8_interpolate_motion(xd, mb_row, mb_col, pc->mb_rows, pc->mb_cols);
+          vp8_interpolate_motion(xd, mb_row, mb_col, pc->mb_rows, pc->mb_cols,
+                                 pbi->row_ec);
         }
       }
 #endif
@@ -754,9 +760,15 @@ static void setup_token_decoder(VP8D_COMP *pbi,
       ptrdiff_t ext_first_part_size = token_part_sizes -
                                       pbi->fragments.ptrs[0] +
                                       3 * (num_token_partitions - 1);
-      if (fragment_size < (unsigned int)ext_first_part_size)
-        vpx_internal_error(&pbi->common.error, VPX_CODEC_CORRUPT_FRAME,
-                           "Corrupted fragment size %d", fragment_size);
+      if (fragment_size < (unsigned int)ext_first_part_size) {
+        if (!pbi->ec_active) {
+          vpx_internal_error(&pbi->common.error, VPX_CODEC_CORRUPT_FRAME,
+                             "Corrupted fragment size %d", fragment_size);
+        }
+        /* The partition sizes are lost, the token partitions are treated
+         * as missing and concealed. */
+        fragment_size = (unsigned int)ext_first_part_size;
+      }
       fragment_size -= (unsigned int)ext_first_part_size;
       if (fragment_size > 0) {
         pbi->fragments.sizes[0] = (unsigned int)ext_first_part_size;
@@ -1203,10 +1215,11 @@ int vp8_decode_frame(VP8D_COMP *pbi) {
   vp8_decode_mode_mvs(pbi);
 
 #if CONFIG_ERROR_CONCEALMENT
-  if (pbi->ec_active &&
+  if (pbi->ec_active && !pbi->row_ec &&
       pbi->mvs_corrupt_from_mb < (unsigned int)pc->mb_cols * pc->mb_rows) {
     /* Motion vectors are missing in this frame. We will try to estimate
-     * them and then continue decoding the frame as usual */
+     * them and then continue decoding the frame as usual. In row mode they
+     * are estimated as each macroblock is decoded instead. */
     vp8_estimate_missing_mvs(pbi);
   }
 #endif
@@ -1224,6 +1237,7 @@ int vp8_decode_frame(VP8D_COMP *pbi) {
       vpx_internal_error(&pbi->common.error, VPX_CODEC_CORRUPT_FRAME, NULL);
     }
     vp8_yv12_extend_frame_borders(yv12_fb_new);
+    corrupt_tokens |= xd->corrupted;
     for (thread = 0; thread < pbi->decoding_thread_count; ++thread) {
       corrupt_tokens |= pbi->mb_row_di[thread].mbd.corrupted;
     }
@@ -541,7 +541,7 @@ void vp8_decode_mode_mvs(VP8D_COMP *pbi) {
       /* look for corruption. set mvs_corrupt_from_mb to the current
        * mb_num if the frame is corrupt from this macroblock. */
       if (vp8dx_bool_error(&pbi->mbc[8]) &&
-          mb_num < (int)pbi->mvs_corrupt_from_mb) {
+          (unsigned int)mb_num < pbi->mvs_corrupt_from_mb) {
         pbi->mvs_corrupt_from_mb = mb_num;
         /* no need to continue since the partition is corrupt from
          * here on.
@@ -22,6 +22,12 @@
 
 #define NUM_NEIGHBORS 20
 
+/* Distance, in macroblocks, of the last frame macroblocks whose motion is
+ * projected onto a macroblock by vp8_estimate_missing_mb_mvs(). Motion of up
+ * to 32 pixels is followed.
+ */
+#define EC_MV_SEARCH_RANGE 2
+
 typedef struct ec_position {
   int row;
   int col;
@@ -343,6 +349,97 @@ void vp8_estimate_missing_mvs(VP8D_COMP *pbi) {
                        pc->mb_cols, pbi->mvs_corrupt_from_mb);
 }
 
+void vp8_estimate_missing_mb_mvs(VP8D_COMP *pbi, MACROBLOCKD *mb, int mb_row,
+                                 int mb_col) {
+  const VP8_COMMON *const pc = &pbi->common;
+  MODE_INFO *const mi = mb->mode_info_context;
+  MV *const filtered_mv = &(mi->mbmi.mv.as_mv);
+  const int first_row = VPXMAX(mb_row - EC_MV_SEARCH_RANGE, 0);
+  const int last_row = VPXMIN(mb_row + EC_MV_SEARCH_RANGE, pc->mb_rows - 1);
+  const int first_col = VPXMAX(mb_col - EC_MV_SEARCH_RANGE, 0);
+  const int last_col = VPXMIN(mb_col + EC_MV_SEARCH_RANGE, pc->mb_cols - 1);
+  int row_acc[16] = { 0 };
+  int col_acc[16] = { 0 };
+  int overlap_sum[16] = { 0 };
+  int non_zero_count = 0;
+  int row, col, i;
+
+  /* Accumulate the overlap weighted vectors of the last frame blocks which
+   * are moved onto this macroblock. Positions are in Q3 relative to its
+   * upper-left corner.
+   */
+  for (row = first_row; row <= last_row; ++row) {
+    for (col = first_col; col <= last_col; ++col) {
+      const MODE_INFO *const prev_mi =
+          pc->prev_mi + row * pc->mode_info_stride + col;
+      /* We're only able to use blocks referring to the last frame
+       * when extrapolating new vectors.
+       */
+      if (prev_mi->mbmi.ref_frame != LAST_FRAME) continue;
+      for (i = 0; i < 16; ++i) {
+        const MV *const mv = &prev_mi->bmi[i].mv.as_mv;
+        /* reverse compensate for motion */
+        const int new_row =
+            (((row - mb_row) * 16 + (i >> 2) * 4) << 3) - mv->row;
+        const int new_col =
+            (((col - mb_col) * 16 + (i & 3) * 4) << 3) - mv->col;
+        int b_row, b_col;
+
+        if (new_row <= -32 || new_col <= -32 || new_row >= (16 << 3) ||
+            new_col >= (16 << 3)) {
+          /* outside the macroblock */
+          continue;
+        }
+        /* The block overlaps at most 2x2 blocks of the macroblock. */
+        for (b_row = VPXMAX(new_row >> 5, 0);
+             b_row <= VPXMIN((new_row + 31) >> 5, 3); ++b_row) {
+          for (b_col = VPXMAX(new_col >> 5, 0);
+               b_col <= VPXMIN((new_col + 31) >> 5, 3); ++b_col) {
+            /* input in Q3, result in Q6 */
+            const int overlap =
+                block_overlap(new_row, new_col, b_row << 5, b_col << 5);
+            row_acc[b_row * 4 + b_col] += overlap * mv->row;
+            col_acc[b_row * 4 + b_col] += overlap * mv->col;
+            overlap_sum[b_row * 4 + b_col] += overlap;
+          }
+        }
+      }
+    }
+  }
+
+  mi->mbmi.ref_frame = LAST_FRAME;
+  mi->mbmi.mode = SPLITMV;
+  mi->mbmi.uv_mode = DC_PRED;
+  mi->mbmi.partitioning = 3;
+  mi->mbmi.segment_id = 0;
+  mi->mbmi.need_to_clamp_mvs = 0;
+  filtered_mv->col = 0;
+  filtered_mv->row = 0;
+  for (i = 0; i < 16; ++i) {
+    int_mv *const mv = &(mi->bmi[i].mv);
+    mv->as_int = 0;
+    if (overlap_sum[i] > 0) {
+      /* Q9 / Q6 = Q3 */
+      mv->as_mv.row = row_acc[i] / overlap_sum[i];
+      mv->as_mv.col = col_acc[i] / overlap_sum[i];
+    }
+    mi->mbmi.need_to_clamp_mvs |= vp8_check_mv_bounds(
+        mv, mb->mb_to_left_edge + (((i & 3) * 4) << 3),
+        mb->mb_to_right_edge - (((i & 3) * 4) << 3),
+        mb->mb_to_top_edge + (((i >> 2) * 4) << 3),
+        mb->mb_to_bottom_edge - (((i >> 2) * 4) << 3));
+    if (mv->as_int != 0) {
+      ++non_zero_count;
+      filtered_mv->col += mv->as_mv.col;
+      filtered_mv->row += mv->as_mv.row;
+    }
+  }
+  if (non_zero_count > 0) {
+    filtered_mv->col /= non_zero_count;
+    filtered_mv->row /= non_zero_count;
+  }
+}
+
 static void assign_neighbor(EC_BLOCK *neighbor, MODE_INFO *mi, int block_idx) {
   assert(mi->mbmi.ref_frame < MAX_REF_FRAMES);
   neighbor->ref_frame = mi->mbmi.ref_frame;
@@ -355,11 +452,12 @@ static void assign_neighbor(EC_BLOCK *neighbor, MODE_INFO *mi, int block_idx) {
  * The neighbors are enumerated with the upper-left neighbor as the first
  * element, the second element refers to the neighbor to right of the previous
  * neighbor, and so on. The last element refers to the neighbor below the first
- * neighbor.
+ * neighbor. If causal is set only the neighbors which precede the macroblock
+ * in decoding order are used.
  */
 static void find_neighboring_blocks(MODE_INFO *mi, EC_BLOCK *neighbors,
                                     int mb_row, int mb_col, int mb_rows,
-                                    int mb_cols, int mi_stride) {
+                                    int mb_cols, int mi_stride, int causal) {
   int i = 0;
   int j;
   if (mb_row > 0) {
@@ -376,10 +474,12 @@ static void find_neighboring_blocks(MODE_INFO *mi, EC_BLOCK *neighbors,
     if (mb_row > 0) assign_neighbor(&neighbors[i], mi - mi_stride + 1, 12);
     ++i;
     /* right */
-    for (j = 0; j <= 12; j += 4, ++i) assign_neighbor(&neighbors[i], mi + 1, j);
+    for (j = 0; j <= 12; j += 4, ++i) {
+      if (!causal) assign_neighbor(&neighbors[i], mi + 1, j);
+    }
   } else
     i += 5;
-  if (mb_row < mb_rows - 1) {
+  if (mb_row < mb_rows - 1 && !causal) {
     /* lower right */
     if (mb_col < mb_cols - 1)
       assign_neighbor(&neighbors[i], mi + mi_stride + 1, 0);
@@ -391,7 +491,7 @@ static void find_neighboring_blocks(MODE_INFO *mi, EC_BLOCK *neighbors,
     i += 5;
   if (mb_col > 0) {
     /* lower left */
-    if (mb_row < mb_rows - 1)
+    if (mb_row < mb_rows - 1 && !causal)
       assign_neighbor(&neighbors[i], mi + mi_stride - 1, 4);
     ++i;
     /* left */
@@ -459,7 +559,7 @@ static void interpolate_mvs(MACROBLOCKD *mb, EC_BLOCK *neighbors,
 }
 
 void vp8_interpolate_motion(MACROBLOCKD *mb, int mb_row, int mb_col,
-                            int mb_rows, int mb_cols) {
+                            int mb_rows, int mb_cols, int causal) {
   /* Find relevant neighboring blocks */
   EC_BLOCK neighbors[NUM_NEIGHBORS];
   int i;
@@ -469,7 +569,7 @@ void vp8_interpolate_motion(MACROBLOCKD *mb, int mb_row, int mb_col,
     neighbors[i].mv.row = neighbors[i].mv.col = 0;
   }
   find_neighboring_blocks(mb->mode_info_context, neighbors, mb_row, mb_col,
-                          mb_rows, mb_cols, mb->mode_info_stride);
+                          mb_rows, mb_cols, mb->mode_info_stride, causal);
   /* Interpolate MVs for the missing blocks from the surrounding
    * blocks which refer to the last frame. */
   interpolate_mvs(mb, neighbors, LAST_FRAME);
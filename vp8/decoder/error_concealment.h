@@ -27,12 +27,19 @@ void vp8_de_alloc_overlap_lists(VP8D_COMP *pbi);
 /* Estimate all missing motion vectors. */
 void vp8_estimate_missing_mvs(VP8D_COMP *pbi);
 
+/* Estimate the missing motion vectors of the macroblock mb at position
+ * (mb_row, mb_col) from the last frame macroblocks around it. Doesn't need
+ * the overlap lists, and can be called while the rows are decoded. */
+void vp8_estimate_missing_mb_mvs(VP8D_COMP *pbi, MACROBLOCKD *mb, int mb_row,
+                                 int mb_col);
+
 /* Functions for spatial MV interpolation */
 
 /* Interpolates all motion vectors for a macroblock mb at position
- * (mb_row, mb_col). */
+ * (mb_row, mb_col). If causal is set, only the neighbors that are decoded
+ * before mb are used. */
 void vp8_interpolate_motion(MACROBLOCKD *mb, int mb_row, int mb_col,
-                            int mb_rows, int mb_cols);
+                            int mb_rows, int mb_cols, int causal);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -112,6 +112,8 @@ typedef struct VP8D_COMP {
 #endif
   int ec_enabled;
   int ec_active;
+  /* estimate the missing motion vectors row by row as the MBs are decoded */
+  int row_ec;
   int decoded_key_frame;
   int independent_partitions;
   int frame_corrupt_residual;
@@ -68,6 +68,7 @@ static void setup_decoding_thread_data(VP8D_COMP *pbi, MACROBLOCKD *xd,
     mbd->mode_ref_lf_delta_update = xd->mode_ref_lf_delta_update;
 
     mbd->current_bc = &pbi->mbc[0];
+    mbd->corrupted = 0;
 
     memcpy(mbd->dequant_y1_dc, xd->dequant_y1_dc, sizeof(xd->dequant_y1_dc));
     memcpy(mbd->dequant_y1, xd->dequant_y1, sizeof(xd->dequant_y1));
@@ -357,6 +358,8 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
     }
 
     for (mb_col = 0; mb_col < pc->mb_cols; ++mb_col) {
+      const unsigned int mb_idx = mb_row * pc->mb_cols + mb_col;
+
       if (((mb_col - 1) % nsync) == 0) {
         vpx_atomic_store_release(current_mb_col, mb_col - 1);
       }
@@ -373,6 +376,14 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
       xd->mb_to_right_edge = ((pc->mb_cols - 1 - mb_col) * 16) << 3;
 
 #if CONFIG_ERROR_CONCEALMENT
+      if (pbi->ec_active && pbi->row_ec &&
+          mb_idx >= pbi->mvs_corrupt_from_mb) {
+        /* The modes and motion vectors of this MB are missing. Only the
+         * last frame and the MBs already decoded are looked at, so the
+         * estimate doesn't depend on the progress of the other threads.
+         */
+        vp8_estimate_missing_mb_mvs(pbi, xd, mb_row, mb_col);
+      }
       {
         int corrupt_residual =
             (!pbi->independent_partitions && pbi->frame_corrupt_residual) ||
@@ -391,7 +402,8 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
            * happens after this check, and therefore no
            * inter concealment will be done.
            */
-          vp8_interpolate_motion(xd, mb_row, mb_col, pc->mb_rows, pc->mb_cols);
+          vp8_interpolate_motion(xd, mb_row, mb_col, pc->mb_rows, pc->mb_cols,
+                                 pbi->row_ec);
         }
       }
 #endif
@@ -403,7 +415,10 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
       /* propagate errors from reference frames */
       xd->corrupted |= ref_fb_corrupted[xd->mode_info_context->mbmi.ref_frame];
 
-      if (xd->corrupted) {
+      /* With error concealment the corrupt MBs are concealed and the frame
+       * is decoded to the end, like in the single threaded decoder.
+       */
+      if (xd->corrupted && !pbi->ec_active) {
         // Move current decoding marcoblock to the end of row for all rows
         // assigned to this thread, such that other threads won't be waiting.
         for (; mb_row < pc->mb_rows;
@@ -426,7 +441,7 @@ static void mt_decode_mb_rows(VP8D_COMP *pbi, MACROBLOCKD *xd,
         xd->pre.u_buffer = 0;
         xd->pre.v_buffer = 0;
       }
-      mt_decode_macroblock(pbi, xd, 0);
+      mt_decode_macroblock(pbi, xd, mb_idx);
 
       xd->left_available = 1;
 
@@ -286,6 +286,19 @@ static void write_partition_size(unsigned char *cx_data, int size) {
   *(cx_data + 2) = csize;
 }
 
+static void pack_partition_tokens(VP8_COMP *cpi, vp8_writer *w, int part,
+                                  int num_part) {
+  int mb_row;
+
+  for (mb_row = part; mb_row < cpi->common.mb_rows; mb_row += num_part) {
+    const TOKENEXTRA *p = cpi->tplist[mb_row].start;
+    const TOKENEXTRA *stop = cpi->tplist[mb_row].stop;
+    int tokens = (int)(stop - p);
+
+    vp8_pack_tokens(w, p, tokens);
+  }
+}
+
 static void pack_tokens_into_partitions(VP8_COMP *cpi, unsigned char *cx_data,
                                         unsigned char *cx_data_end,
                                         int num_part) {
@@ -295,35 +308,104 @@ static void pack_tokens_into_partitions(VP8_COMP *cpi, unsigned char *cx_data,
   vp8_writer *w;
 
   for (i = 0; i < num_part; ++i) {
-    int mb_row;
-
     w = cpi->bc + i + 1;
 
     vp8_start_encode(w, ptr, ptr_end);
-
-    for (mb_row = i; mb_row < cpi->common.mb_rows; mb_row += num_part) {
-      const TOKENEXTRA *p = cpi->tplist[mb_row].start;
-      const TOKENEXTRA *stop = cpi->tplist[mb_row].stop;
-      int tokens = (int)(stop - p);
-
-      vp8_pack_tokens(w, p, tokens);
-    }
-
+    pack_partition_tokens(cpi, w, i, num_part);
     vp8_stop_encode(w);
     ptr += w->pos;
   }
 }
 
 #if CONFIG_MULTITHREAD
-static void pack_mb_row_tokens(VP8_COMP *cpi, vp8_writer *w) {
-  int mb_row;
+/* Packs a token partition into its own part of the output buffer. Returns 0
+ * if it does not fit. */
+static int pack_token_partition(VP8_COMP *cpi, int part, int num_part) {
+  struct vpx_internal_error_info error;
+  vp8_writer *const w = cpi->bc + part + 1;
+
+  w->error = &error;
+  if (setjmp(error.jmp)) {
+    w->error = &cpi->common.error;
+    return 0;
+  }
+  error.setjmp = 1;
+
+  vp8_start_encode(w, cpi->partition_d[part + 1],
+                   cpi->partition_d_end[part + 1]);
+  pack_partition_tokens(cpi, w, part, num_part);
+  vp8_stop_encode(w);
+
+  w->error = &cpi->common.error;
+  return 1;
+}
+
+void vp8cx_pack_token_partitions(VP8_COMP *cpi, int ithread) {
+  int i;
+
+  for (i = ithread; i < cpi->mt_pack_num_part;
+       i += cpi->encoding_thread_count + 1) {
+    cpi->mt_pack_done[i] = pack_token_partition(cpi, i, cpi->mt_pack_num_part);
+  }
+}
+
+/* The token partitions are independent bool coders, pack them on the
+ * encoding threads into separate parts of the output buffer and concatenate
+ * them. */
+static void pack_tokens_into_partitions_mt(VP8_COMP *cpi,
+                                           unsigned char *cx_data,
+                                           unsigned char *cx_data_end,
+                                           int num_part) {
+  const size_t buf_size = cx_data_end - cx_data;
+  size_t part_tokens[MAX_PARTITIONS] = { 0 };
+  size_t total_tokens = 0;
+  unsigned char *ptr = cx_data;
+  int mb_row, i;
 
   for (mb_row = 0; mb_row < cpi->common.mb_rows; ++mb_row) {
-    const TOKENEXTRA *p = cpi->tplist[mb_row].start;
-    const TOKENEXTRA *stop = cpi->tplist[mb_row].stop;
-    int tokens = (int)(stop - p);
+    const size_t tokens =
+        cpi->tplist[mb_row].stop - cpi->tplist[mb_row].start;
+    part_tokens[mb_row % num_part] += tokens;
+    total_tokens += tokens;
+  }
 
-    vp8_pack_tokens(w, p, tokens);
+  /* Share the buffer in proportion to the tokens of each partition. */
+  for (i = 0; i < num_part; ++i) {
+    cpi->partition_d[i + 1] = ptr;
+    if (i == num_part - 1) {
+      ptr = cx_data_end;
+    } else {
+      ptr += (size_t)((double)buf_size * (part_tokens[i] + 1) /
+                      (total_tokens + num_part));
+    }
+    cpi->partition_d_end[i + 1] = ptr;
+  }
+
+  cpi->mt_pack_num_part = num_part;
+  cpi->b_mt_pack_tokens = 1;
+  for (i = 0; i < cpi->encoding_thread_count; ++i) {
+    sem_post(&cpi->h_event_start_encoding[i]);
+  }
+  vp8cx_pack_token_partitions(cpi, 0);
+  for (i = 0; i < cpi->encoding_thread_count; ++i) {
+    sem_wait(&cpi->h_event_end_encoding[i]);
+  }
+  cpi->b_mt_pack_tokens = 0;
+
+  /* Concatenate the partitions. From the first one that did not fit in its
+   * part of the buffer, pack the rest again after the previous ones. */
+  ptr = cx_data;
+  for (i = 0; i < num_part && cpi->mt_pack_done[i]; ++i) {
+    vp8_writer *const w = cpi->bc + i + 1;
+    memmove(ptr, cpi->partition_d[i + 1], w->pos);
+    ptr += w->pos;
+  }
+  for (; i < num_part; ++i) {
+    vp8_writer *const w = cpi->bc + i + 1;
+    vp8_start_encode(w, ptr, cx_data_end);
+    pack_partition_tokens(cpi, w, i, num_part);
+    vp8_stop_encode(w);
+    ptr += w->pos;
   }
 }
 #endif  // CONFIG_MULTITHREAD
@@ -1341,8 +1423,19 @@ void vp8_pack_bitstream(VP8_COMP *cpi, unsigned char *dest,
       cpi->bc[i].error = &pc->error;
     }
 
+#if CONFIG_MULTITHREAD
+    if (vpx_atomic_load_acquire(&cpi->b_multi_threaded) &&
+        cpi->encoding_thread_count > 0) {
+      pack_tokens_into_partitions_mt(cpi, cx_data + 3 * (num_part - 1),
+                                     cx_data_end, num_part);
+    } else {
+      pack_tokens_into_partitions(cpi, cx_data + 3 * (num_part - 1),
+                                  cx_data_end, num_part);
+    }
+#else
     pack_tokens_into_partitions(cpi, cx_data + 3 * (num_part - 1), cx_data_end,
                                 num_part);
+#endif  // CONFIG_MULTITHREAD
 
     for (i = 1; i < num_part; ++i) {
       cpi->partition_sz[i] = cpi->bc[i].pos;
@@ -1361,7 +1454,7 @@ void vp8_pack_bitstream(VP8_COMP *cpi, unsigned char *dest,
 
 #if CONFIG_MULTITHREAD
     if (vpx_atomic_load_acquire(&cpi->b_multi_threaded)) {
-      pack_mb_row_tokens(cpi, &cpi->bc[1]);
+      pack_partition_tokens(cpi, &cpi->bc[1], 0, 1);
     } else {
       vp8_pack_tokens(&cpi->bc[1], cpi->tok, cpi->tok_count);
     }
@@ -25,6 +25,12 @@ void vp8_calc_ref_frame_costs(int *ref_frame_cost, int prob_intra,
 int vp8_estimate_entropy_savings(struct VP8_COMP *cpi);
 void vp8_update_coef_probs(struct VP8_COMP *cpi);
 
+#if CONFIG_MULTITHREAD
+/* Packs the token partitions of an encoding thread, thread 0 being the main
+ * thread. */
+void vp8cx_pack_token_partitions(struct VP8_COMP *cpi, int ithread);
+#endif
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -156,6 +156,7 @@ typedef struct macroblock {
   void (*short_fdct8x4)(short *input, short *output, int pitch);
   void (*short_walsh4x4)(short *input, short *output, int pitch);
   void (*quantize_b)(BLOCK *b, BLOCKD *d);
+  void (*quantize_blocks)(BLOCK *b, BLOCKD *d, int count);
 
   unsigned int mbs_zero_last_dot_suppress;
   int zero_last_dot_suppress;
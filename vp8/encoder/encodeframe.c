@@ -37,6 +37,9 @@
 #include "bitstream.h"
 #endif
 #include "encodeframe.h"
+#if CONFIG_MULTI_RES_ENCODING
+#include "mr_dissim.h"
+#endif
 
 extern void vp8_stuff_mb(VP8_COMP *cpi, MACROBLOCK *x, TOKENEXTRA **t);
 static void adjust_act_zbin(VP8_COMP *cpi, MACROBLOCK *x);
@@ -364,6 +367,10 @@ static void encode_mb_row(VP8_COMP *cpi, VP8_COMMON *cm, int mb_row,
   cpi->tplist[mb_row].start = *tp;
   /* printf("Main mb_row = %d\n", mb_row); */
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  vp8_mr_wait_for_low_res_row(cpi, mb_row);
+#endif
+
   /* Distance of Mb to the top & bottom edges, specified in 1/8th pel
    * units as they are always compared to values that are in 1/8th pel
    */
@@ -562,6 +569,10 @@ static void encode_mb_row(VP8_COMP *cpi, VP8_COMMON *cm, int mb_row,
   }
 #endif
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  vp8_mr_store_row(cpi, mb_row);
+#endif
+
   /* this is to account for the border */
   xd->mode_info_context++;
   x->partition_info++;
@@ -674,6 +685,7 @@ void vp8_encode_frame(VP8_COMP *cpi) {
 
   memset(segment_counts, 0, sizeof(segment_counts));
   totalrate = 0;
+  cpi->frame_encode_aborted = 0;
 
   if (cpi->compressor_speed == 2) {
     if (cpi->oxcf.cpu_used < 0) {
@@ -863,6 +875,23 @@ void vp8_encode_frame(VP8_COMP *cpi) {
         x->src.y_buffer += 16 * x->src.y_stride - 16 * cm->mb_cols;
         x->src.u_buffer += 8 * x->src.uv_stride - 8 * cm->mb_cols;
         x->src.v_buffer += 8 * x->src.uv_stride - 8 * cm->mb_cols;
+
+#if !CONFIG_REALTIME_ONLY
+        /* Project the frame size from the rows coded so far and give up on
+         * this encode when the recode loop is bound to reject it.
+         */
+        if (mb_row + 1 == cpi->recode_abort_row) {
+          const int64_t projected =
+              (int64_t)(totalrate >> 8) * cm->mb_rows / (mb_row + 1);
+          if (projected > cpi->recode_abort_high ||
+              projected < cpi->recode_abort_low) {
+            cpi->projected_frame_size =
+                (int)VPXMIN(projected, (int64_t)INT_MAX);
+            cpi->frame_encode_aborted = 1;
+            break;
+          }
+        }
+#endif  // !CONFIG_REALTIME_ONLY
       }
 
       cpi->tok_count = (unsigned int)(tp - cpi->tok);
@@ -882,6 +911,14 @@ void vp8_encode_frame(VP8_COMP *cpi) {
     cpi->time_encode_mb_row += vpx_usec_timer_elapsed(&emr_timer);
   }
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  /* The last row has no row below it. */
+  vp8_mr_store_row(cpi, cm->mb_rows);
+#endif
+
+  /* The recode loop starts over with a new Q. */
+  if (cpi->frame_encode_aborted) return;
+
   // Work out the segment probabilities if segmentation is enabled
   // and needs to be updated
   if (xd->segmentation_enabled && xd->update_mb_segmentation_map) {
@@ -1144,6 +1181,7 @@ int vp8cx_encode_inter_macroblock(VP8_COMP *cpi, MACROBLOCK *x, TOKENEXTRA **t,
     /* Are we using the fast quantizer for the mode selection? */
     if (cpi->sf.use_fastquant_for_pick) {
       x->quantize_b = vp8_fast_quantize_b;
+      x->quantize_blocks = vp8_fast_quantize_blocks;
 
       /* the fast quantizer does not use zbin_extra, so
        * do not recalculate */
@@ -1155,6 +1193,7 @@ int vp8cx_encode_inter_macroblock(VP8_COMP *cpi, MACROBLOCK *x, TOKENEXTRA **t,
     /* switch back to the regular quantizer for the encode */
     if (cpi->sf.improved_quant) {
       x->quantize_b = vp8_regular_quantize_b;
+      x->quantize_blocks = vp8_regular_quantize_blocks;
     }
 
     /* restore cpi->zbin_mode_boost_enabled */
@@ -15,6 +15,11 @@
 #include "bitstream.h"
 #include "encodeframe.h"
 #include "ethreading.h"
+#include "firstpass.h"
+#include "temporal_filter.h"
+#if CONFIG_MULTI_RES_ENCODING
+#include "mr_dissim.h"
+#endif
 
 #if CONFIG_MULTITHREAD
 
@@ -68,6 +73,24 @@ static THREAD_FUNCTION thread_encoding_proc(void *p_data) {
       /* we're shutting down */
       if (vpx_atomic_load_acquire(&cpi->b_multi_threaded) == 0) break;
 
+      if (cpi->b_mt_pack_tokens) {
+        vp8cx_pack_token_partitions(cpi, ithread + 1);
+        sem_post(&cpi->h_event_end_encoding[ithread]);
+        continue;
+      }
+
+      if (cpi->b_mt_first_pass) {
+        vp8_first_pass_mb_rows(cpi, x, ithread + 1);
+        sem_post(&cpi->h_event_end_encoding[ithread]);
+        continue;
+      }
+
+      if (cpi->b_mt_temporal_filter) {
+        vp8_temporal_filter_mb_rows(cpi, x, ithread + 1);
+        sem_post(&cpi->h_event_end_encoding[ithread]);
+        continue;
+      }
+
       xd->mode_info_context = cm->mi + cm->mode_info_stride * (ithread + 1);
       xd->mode_info_stride = cm->mode_info_stride;
 
@@ -105,6 +128,10 @@ static THREAD_FUNCTION thread_encoding_proc(void *p_data) {
         /* Set the mb activity pointer to the start of the row. */
         x->mb_activity_ptr = &cpi->mb_activity_map[map_index];
 
+#if CONFIG_MULTI_RES_ENCODING
+        vp8_mr_wait_for_low_res_row(cpi, mb_row);
+#endif
+
         /* for each macroblock col in image */
         for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
           if (((mb_col - 1) % nsync) == 0) {
@@ -286,6 +313,10 @@ static THREAD_FUNCTION thread_encoding_proc(void *p_data) {
 
         vpx_atomic_store_release(current_mb_col, mb_col + nsync);
 
+#if CONFIG_MULTI_RES_ENCODING
+        vp8_mr_store_row(cpi, mb_row);
+#endif
+
         /* this is to account for the border */
         xd->mode_info_context++;
         x->partition_info++;
@@ -338,6 +369,7 @@ static void setup_mbby_copy(MACROBLOCK *mbdst, MACROBLOCK *mbsrc) {
   z->short_fdct8x4 = x->short_fdct8x4;
   z->short_walsh4x4 = x->short_walsh4x4;
   z->quantize_b = x->quantize_b;
+  z->quantize_blocks = x->quantize_blocks;
   z->optimize = x->optimize;
 
   /*
@@ -485,6 +517,25 @@ void vp8cx_init_mbrthread_data(VP8_COMP *cpi, MACROBLOCK *x,
   }
 }
 
+void vp8cx_copy_mbrthread_data(MACROBLOCK *x, MB_ROW_COMP *mbr_ei, int count) {
+  int i, j;
+
+  for (i = 0; i < count; ++i) {
+    MACROBLOCK *mb = &mbr_ei[i].mb;
+    MACROBLOCKD *mbd = &mb->e_mbd;
+
+    setup_mbby_copy(mb, x);
+
+    for (j = 0; j < 25; ++j) mb->block[j].zbin_extra = x->block[j].zbin_extra;
+
+    mb->rdmult = x->rdmult;
+    mb->rddiv = x->rddiv;
+    mbd->fullpixel_mask = x->e_mbd.fullpixel_mask;
+    mbd->above_context = x->e_mbd.above_context;
+    mbd->left_context = x->e_mbd.left_context;
+  }
+}
+
 int vp8cx_create_encoder_threads(VP8_COMP *cpi) {
   const VP8_COMMON *cm = &cpi->common;
 
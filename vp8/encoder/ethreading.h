@@ -22,6 +22,11 @@ struct macroblock;
 
 void vp8cx_init_mbrthread_data(struct VP8_COMP *cpi, struct macroblock *x,
                                MB_ROW_COMP *mbr_ei, int count);
+/* Copies the quantizer and search state of x to the row threads for the
+ * first pass and the temporal filter, which do not run the per frame setup
+ * of vp8cx_init_mbrthread_data(). */
+void vp8cx_copy_mbrthread_data(struct macroblock *x, MB_ROW_COMP *mbr_ei,
+                               int count);
 int vp8cx_create_encoder_threads(struct VP8_COMP *cpi);
 void vp8cx_remove_encoder_threads(struct VP8_COMP *cpi);
 
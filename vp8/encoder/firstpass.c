@@ -33,6 +33,7 @@
 #include "vp8/common/quant_common.h"
 #include "encodemv.h"
 #include "encodeframe.h"
+#include "ethreading.h"
 
 #define OUTPUT_FPF 0
 
@@ -465,46 +466,283 @@ static void first_pass_motion_search(VP8_COMP *cpi, MACROBLOCK *x,
   }
 }
 
-void vp8_first_pass(VP8_COMP *cpi) {
-  int mb_row, mb_col;
-  MACROBLOCK *const x = &cpi->mb;
+static void first_pass_mb_row(VP8_COMP *cpi, MACROBLOCK *x, int mb_row) {
   VP8_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
+  FIRSTPASS_MB_ROW_STATS *const stats = &cpi->twopass.mb_row_stats[mb_row];
+  int mb_col;
 
-  int recon_yoffset, recon_uvoffset;
   YV12_BUFFER_CONFIG *lst_yv12 = &cm->yv12_fb[cm->lst_fb_idx];
   YV12_BUFFER_CONFIG *new_yv12 = &cm->yv12_fb[cm->new_fb_idx];
   YV12_BUFFER_CONFIG *gld_yv12 = &cm->yv12_fb[cm->gld_fb_idx];
   int recon_y_stride = lst_yv12->y_stride;
   int recon_uv_stride = lst_yv12->uv_stride;
-  int64_t intra_error = 0;
-  int64_t coded_error = 0;
-
-  int sum_mvr = 0, sum_mvc = 0;
-  int sum_mvr_abs = 0, sum_mvc_abs = 0;
-  int sum_mvrs = 0, sum_mvcs = 0;
-  int mvcount = 0;
-  int intercount = 0;
-  int second_ref_count = 0;
+  int recon_yoffset = (mb_row * recon_y_stride * 16);
+  int recon_uvoffset = (mb_row * recon_uv_stride * 8);
   int intrapenalty = 256;
-  int neutral_count = 0;
-  int new_mv_count = 0;
-  int sum_in_vectors = 0;
-  uint32_t lastmv_as_int = 0;
 
+  int_mv best_ref_mv;
   int_mv zero_ref_mv;
 
+#if CONFIG_MULTITHREAD
+  const int nsync = cpi->mt_sync_range;
+  vpx_atomic_int *current_mb_col = NULL;
+  const vpx_atomic_int *last_row_current_mb_col = NULL;
+
+  if (cpi->b_mt_first_pass) {
+    current_mb_col = &cpi->mt_current_mb_col[mb_row];
+    if (mb_row != 0) {
+      last_row_current_mb_col = &cpi->mt_current_mb_col[mb_row - 1];
+    }
+  }
+#endif
+
+  memset(stats, 0, sizeof(*stats));
+
+  best_ref_mv.as_int = 0;
   zero_ref_mv.as_int = 0;
 
+  x->src.y_buffer = cpi->Source->y_buffer + 16 * mb_row * x->src.y_stride;
+  x->src.u_buffer = cpi->Source->u_buffer + 8 * mb_row * x->src.uv_stride;
+  x->src.v_buffer = cpi->Source->v_buffer + 8 * mb_row * x->src.uv_stride;
+
+  /* Each row has its own mode info, for the rows coded on other threads. */
+  xd->mode_info_context = cm->mi + mb_row * cm->mode_info_stride;
+
+  /* reset above block coeffs */
+  xd->up_available = (mb_row != 0);
+
+  /* Set up limit values for motion vectors to prevent them extending
+   * outside the UMV borders
+   */
+  x->mv_row_min = -((mb_row * 16) + (VP8BORDERINPIXELS - 16));
+  x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16) + (VP8BORDERINPIXELS - 16);
+
+  /* for each macroblock col in image */
+  for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
+    int this_error;
+    int gf_motion_error = INT_MAX;
+    int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
+
+#if CONFIG_MULTITHREAD
+    /* The intra prediction reads the reconstruction of the row above. */
+    if (current_mb_col && ((mb_col - 1) % nsync) == 0) {
+      vpx_atomic_store_release(current_mb_col, mb_col - 1);
+    }
+
+    if (last_row_current_mb_col && !(mb_col & (nsync - 1))) {
+      vp8_atomic_spin_wait(mb_col, last_row_current_mb_col, nsync);
+    }
+#endif
+
+    xd->dst.y_buffer = new_yv12->y_buffer + recon_yoffset;
+    xd->dst.u_buffer = new_yv12->u_buffer + recon_uvoffset;
+    xd->dst.v_buffer = new_yv12->v_buffer + recon_uvoffset;
+    xd->left_available = (mb_col != 0);
+
+    /* Copy current mb to a buffer */
+    vp8_copy_mem16x16(x->src.y_buffer, x->src.y_stride, x->thismb, 16);
+
+    /* do intra 16x16 prediction */
+    this_error = vp8_encode_intra(x, use_dc_pred);
+
+    /* "intrapenalty" below deals with situations where the intra
+     * and inter error scores are very low (eg a plain black frame)
+     * We do not have special cases in first pass for 0,0 and
+     * nearest etc so all inter modes carry an overhead cost
+     * estimate fot the mv. When the error score is very low this
+     * causes us to pick all or lots of INTRA modes and throw lots
+     * of key frames. This penalty adds a cost matching that of a
+     * 0,0 mv to the intra case.
+     */
+    this_error += intrapenalty;
+
+    /* Cumulative intra error total */
+    stats->intra_error += (int64_t)this_error;
+
+    /* Set up limit values for motion vectors to prevent them
+     * extending outside the UMV borders
+     */
+    x->mv_col_min = -((mb_col * 16) + (VP8BORDERINPIXELS - 16));
+    x->mv_col_max =
+        ((cm->mb_cols - 1 - mb_col) * 16) + (VP8BORDERINPIXELS - 16);
+
+    /* Other than for the first frame do a motion search */
+    if (cm->current_video_frame > 0) {
+      BLOCKD *d = &x->e_mbd.block[0];
+      MV tmp_mv = { 0, 0 };
+      int tmp_err;
+      int motion_error = INT_MAX;
+      int raw_motion_error = INT_MAX;
+
+      /* Simple 0,0 motion with no mv overhead */
+      zz_motion_search(x, cpi->last_frame_unscaled_source, &raw_motion_error,
+                       lst_yv12, &motion_error, recon_yoffset);
+      d->bmi.mv.as_mv.row = 0;
+      d->bmi.mv.as_mv.col = 0;
+
+      if (raw_motion_error < cpi->oxcf.encode_breakout) {
+        goto skip_motion_search;
+      }
+
+      /* Test last reference frame using the previous best mv as the
+       * starting point (best reference) for the search
+       */
+      first_pass_motion_search(cpi, x, &best_ref_mv, &d->bmi.mv.as_mv,
+                               lst_yv12, &motion_error, recon_yoffset);
+
+      /* If the current best reference mv is not centred on 0,0
+       * then do a 0,0 based search as well
+       */
+      if (best_ref_mv.as_int) {
+        tmp_err = INT_MAX;
+        first_pass_motion_search(cpi, x, &zero_ref_mv, &tmp_mv, lst_yv12,
+                                 &tmp_err, recon_yoffset);
+
+        if (tmp_err < motion_error) {
+          motion_error = tmp_err;
+          d->bmi.mv.as_mv.row = tmp_mv.row;
+          d->bmi.mv.as_mv.col = tmp_mv.col;
+        }
+      }
+
+      /* Experimental search in a second reference frame ((0,0)
+       * based only)
+       */
+      if (cm->current_video_frame > 1) {
+        first_pass_motion_search(cpi, x, &zero_ref_mv, &tmp_mv, gld_yv12,
+                                 &gf_motion_error, recon_yoffset);
+
+        if ((gf_motion_error < motion_error) &&
+            (gf_motion_error < this_error)) {
+          stats->second_ref_count++;
+        }
+
+        /* Reset to last frame as reference buffer */
+        xd->pre.y_buffer = lst_yv12->y_buffer + recon_yoffset;
+        xd->pre.u_buffer = lst_yv12->u_buffer + recon_uvoffset;
+        xd->pre.v_buffer = lst_yv12->v_buffer + recon_uvoffset;
+      }
+
+    skip_motion_search:
+      /* Intra assumed best */
+      best_ref_mv.as_int = 0;
+
+      if (motion_error <= this_error) {
+        /* Keep a count of cases where the inter and intra were
+         * very close and very low. This helps with scene cut
+         * detection for example in cropped clips with black bars
+         * at the sides or top and bottom.
+         */
+        if ((((this_error - intrapenalty) * 9) <= (motion_error * 10)) &&
+            (this_error < (2 * intrapenalty))) {
+          stats->neutral_count++;
+        }
+
+        d->bmi.mv.as_mv.row *= 8;
+        d->bmi.mv.as_mv.col *= 8;
+        this_error = motion_error;
+        vp8_set_mbmode_and_mvs(x, NEWMV, &d->bmi.mv);
+        vp8_encode_inter16x16y(x);
+        stats->sum_mvr += d->bmi.mv.as_mv.row;
+        stats->sum_mvr_abs += abs(d->bmi.mv.as_mv.row);
+        stats->sum_mvc += d->bmi.mv.as_mv.col;
+        stats->sum_mvc_abs += abs(d->bmi.mv.as_mv.col);
+        stats->sum_mvrs += d->bmi.mv.as_mv.row * d->bmi.mv.as_mv.row;
+        stats->sum_mvcs += d->bmi.mv.as_mv.col * d->bmi.mv.as_mv.col;
+        stats->intercount++;
+
+        best_ref_mv.as_int = d->bmi.mv.as_int;
+
+        /* Was the vector non-zero */
+        if (d->bmi.mv.as_int) {
+          stats->mvcount++;
+
+          /* Was it different from the last non zero vector. The first
+           * one of the row is compared when the rows are summed.
+           */
+          if (!stats->first_mv_as_int) {
+            stats->first_mv_as_int = d->bmi.mv.as_int;
+          } else if (d->bmi.mv.as_int != stats->last_mv_as_int) {
+            stats->new_mv_count++;
+          }
+          stats->last_mv_as_int = d->bmi.mv.as_int;
+
+          /* Does the Row vector point inwards or outwards */
+          if (mb_row < cm->mb_rows / 2) {
+            if (d->bmi.mv.as_mv.row > 0) {
+              stats->sum_in_vectors--;
+            } else if (d->bmi.mv.as_mv.row < 0) {
+              stats->sum_in_vectors++;
+            }
+          } else if (mb_row > cm->mb_rows / 2) {
+            if (d->bmi.mv.as_mv.row > 0) {
+              stats->sum_in_vectors++;
+            } else if (d->bmi.mv.as_mv.row < 0) {
+              stats->sum_in_vectors--;
+            }
+          }
+
+          /* Does the Row vector point inwards or outwards */
+          if (mb_col < cm->mb_cols / 2) {
+            if (d->bmi.mv.as_mv.col > 0) {
+              stats->sum_in_vectors--;
+            } else if (d->bmi.mv.as_mv.col < 0) {
+              stats->sum_in_vectors++;
+            }
+          } else if (mb_col > cm->mb_cols / 2) {
+            if (d->bmi.mv.as_mv.col > 0) {
+              stats->sum_in_vectors++;
+            } else if (d->bmi.mv.as_mv.col < 0) {
+              stats->sum_in_vectors--;
+            }
+          }
+        }
+      }
+    }
+
+    stats->coded_error += (int64_t)this_error;
+
+    /* adjust to the next column of macroblocks */
+    x->src.y_buffer += 16;
+    x->src.u_buffer += 8;
+    x->src.v_buffer += 8;
+
+    recon_yoffset += 16;
+    recon_uvoffset += 8;
+  }
+
+  /* extend the recon for intra prediction */
+  vp8_extend_mb_row(new_yv12, xd->dst.y_buffer + 16, xd->dst.u_buffer + 8,
+                    xd->dst.v_buffer + 8);
+
+#if CONFIG_MULTITHREAD
+  if (current_mb_col) vpx_atomic_store_release(current_mb_col, mb_col + nsync);
+#endif
+
   vpx_clear_system_state();
+}
 
-  x->src = *cpi->Source;
-  xd->pre = *lst_yv12;
-  xd->dst = *new_yv12;
+#if CONFIG_MULTITHREAD
+void vp8_first_pass_mb_rows(VP8_COMP *cpi, MACROBLOCK *x, int ithread) {
+  int mb_row;
 
-  x->partition_info = x->pi;
+  for (mb_row = ithread; mb_row < cpi->common.mb_rows;
+       mb_row += cpi->encoding_thread_count + 1) {
+    first_pass_mb_row(cpi, x, mb_row);
+  }
+}
+#endif
+
+/* Sets up a macroblock to code the first pass of the current frame. */
+static void init_first_pass_mb(VP8_COMP *cpi, MACROBLOCK *x) {
+  VP8_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &x->e_mbd;
 
-  xd->mode_info_context = cm->mi;
+  x->src = *cpi->Source;
+  xd->pre = cm->yv12_fb[cm->lst_fb_idx];
+  xd->dst = cm->yv12_fb[cm->new_fb_idx];
+  xd->mode_info_stride = cm->mode_info_stride;
 
   if (!cm->use_bilinear_mc_filter) {
     xd->subpixel_predict = vp8_sixtap_predict4x4;
@@ -519,6 +757,35 @@ void vp8_first_pass(VP8_COMP *cpi) {
   }
 
   vp8_build_block_offsets(x);
+}
+
+void vp8_first_pass(VP8_COMP *cpi) {
+  int mb_row;
+  MACROBLOCK *const x = &cpi->mb;
+  VP8_COMMON *const cm = &cpi->common;
+
+  YV12_BUFFER_CONFIG *lst_yv12 = &cm->yv12_fb[cm->lst_fb_idx];
+  YV12_BUFFER_CONFIG *new_yv12 = &cm->yv12_fb[cm->new_fb_idx];
+  YV12_BUFFER_CONFIG *gld_yv12 = &cm->yv12_fb[cm->gld_fb_idx];
+  int64_t intra_error = 0;
+  int64_t coded_error = 0;
+
+  int sum_mvr = 0, sum_mvc = 0;
+  int sum_mvr_abs = 0, sum_mvc_abs = 0;
+  int sum_mvrs = 0, sum_mvcs = 0;
+  int mvcount = 0;
+  int intercount = 0;
+  int second_ref_count = 0;
+  int neutral_count = 0;
+  int new_mv_count = 0;
+  int sum_in_vectors = 0;
+  uint32_t lastmv_as_int = 0;
+
+  vpx_clear_system_state();
+
+  x->partition_info = x->pi;
+
+  init_first_pass_mb(cpi, x);
 
   /* set up frame new frame for intra coded blocks */
   vp8_setup_intra_recon(new_yv12);
@@ -534,210 +801,61 @@ void vp8_first_pass(VP8_COMP *cpi) {
                                    (const MV_CONTEXT *)cm->fc.mvc, flag);
   }
 
-  /* for each macroblock row in image */
-  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
-    int_mv best_ref_mv;
-
-    best_ref_mv.as_int = 0;
-
-    /* reset above block coeffs */
-    xd->up_available = (mb_row != 0);
-    recon_yoffset = (mb_row * recon_y_stride * 16);
-    recon_uvoffset = (mb_row * recon_uv_stride * 8);
-
-    /* Set up limit values for motion vectors to prevent them extending
-     * outside the UMV borders
-     */
-    x->mv_row_min = -((mb_row * 16) + (VP8BORDERINPIXELS - 16));
-    x->mv_row_max =
-        ((cm->mb_rows - 1 - mb_row) * 16) + (VP8BORDERINPIXELS - 16);
-
-    /* for each macroblock col in image */
-    for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
-      int this_error;
-      int gf_motion_error = INT_MAX;
-      int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
-
-      xd->dst.y_buffer = new_yv12->y_buffer + recon_yoffset;
-      xd->dst.u_buffer = new_yv12->u_buffer + recon_uvoffset;
-      xd->dst.v_buffer = new_yv12->v_buffer + recon_uvoffset;
-      xd->left_available = (mb_col != 0);
-
-      /* Copy current mb to a buffer */
-      vp8_copy_mem16x16(x->src.y_buffer, x->src.y_stride, x->thismb, 16);
-
-      /* do intra 16x16 prediction */
-      this_error = vp8_encode_intra(x, use_dc_pred);
-
-      /* "intrapenalty" below deals with situations where the intra
-       * and inter error scores are very low (eg a plain black frame)
-       * We do not have special cases in first pass for 0,0 and
-       * nearest etc so all inter modes carry an overhead cost
-       * estimate fot the mv. When the error score is very low this
-       * causes us to pick all or lots of INTRA modes and throw lots
-       * of key frames. This penalty adds a cost matching that of a
-       * 0,0 mv to the intra case.
-       */
-      this_error += intrapenalty;
-
-      /* Cumulative intra error total */
-      intra_error += (int64_t)this_error;
-
-      /* Set up limit values for motion vectors to prevent them
-       * extending outside the UMV borders
-       */
-      x->mv_col_min = -((mb_col * 16) + (VP8BORDERINPIXELS - 16));
-      x->mv_col_max =
-          ((cm->mb_cols - 1 - mb_col) * 16) + (VP8BORDERINPIXELS - 16);
-
-      /* Other than for the first frame do a motion search */
-      if (cm->current_video_frame > 0) {
-        BLOCKD *d = &x->e_mbd.block[0];
-        MV tmp_mv = { 0, 0 };
-        int tmp_err;
-        int motion_error = INT_MAX;
-        int raw_motion_error = INT_MAX;
-
-        /* Simple 0,0 motion with no mv overhead */
-        zz_motion_search(x, cpi->last_frame_unscaled_source, &raw_motion_error,
-                         lst_yv12, &motion_error, recon_yoffset);
-        d->bmi.mv.as_mv.row = 0;
-        d->bmi.mv.as_mv.col = 0;
-
-        if (raw_motion_error < cpi->oxcf.encode_breakout) {
-          goto skip_motion_search;
-        }
-
-        /* Test last reference frame using the previous best mv as the
-         * starting point (best reference) for the search
-         */
-        first_pass_motion_search(cpi, x, &best_ref_mv, &d->bmi.mv.as_mv,
-                                 lst_yv12, &motion_error, recon_yoffset);
-
-        /* If the current best reference mv is not centred on 0,0
-         * then do a 0,0 based search as well
-         */
-        if (best_ref_mv.as_int) {
-          tmp_err = INT_MAX;
-          first_pass_motion_search(cpi, x, &zero_ref_mv, &tmp_mv, lst_yv12,
-                                   &tmp_err, recon_yoffset);
-
-          if (tmp_err < motion_error) {
-            motion_error = tmp_err;
-            d->bmi.mv.as_mv.row = tmp_mv.row;
-            d->bmi.mv.as_mv.col = tmp_mv.col;
-          }
-        }
-
-        /* Experimental search in a second reference frame ((0,0)
-         * based only)
-         */
-        if (cm->current_video_frame > 1) {
-          first_pass_motion_search(cpi, x, &zero_ref_mv, &tmp_mv, gld_yv12,
-                                   &gf_motion_error, recon_yoffset);
-
-          if ((gf_motion_error < motion_error) &&
-              (gf_motion_error < this_error)) {
-            second_ref_count++;
-          }
-
-          /* Reset to last frame as reference buffer */
-          xd->pre.y_buffer = lst_yv12->y_buffer + recon_yoffset;
-          xd->pre.u_buffer = lst_yv12->u_buffer + recon_uvoffset;
-          xd->pre.v_buffer = lst_yv12->v_buffer + recon_uvoffset;
-        }
-
-      skip_motion_search:
-        /* Intra assumed best */
-        best_ref_mv.as_int = 0;
-
-        if (motion_error <= this_error) {
-          /* Keep a count of cases where the inter and intra were
-           * very close and very low. This helps with scene cut
-           * detection for example in cropped clips with black bars
-           * at the sides or top and bottom.
-           */
-          if ((((this_error - intrapenalty) * 9) <= (motion_error * 10)) &&
-              (this_error < (2 * intrapenalty))) {
-            neutral_count++;
-          }
-
-          d->bmi.mv.as_mv.row *= 8;
-          d->bmi.mv.as_mv.col *= 8;
-          this_error = motion_error;
-          vp8_set_mbmode_and_mvs(x, NEWMV, &d->bmi.mv);
-          vp8_encode_inter16x16y(x);
-          sum_mvr += d->bmi.mv.as_mv.row;
-          sum_mvr_abs += abs(d->bmi.mv.as_mv.row);
-          sum_mvc += d->bmi.mv.as_mv.col;
-          sum_mvc_abs += abs(d->bmi.mv.as_mv.col);
-          sum_mvrs += d->bmi.mv.as_mv.row * d->bmi.mv.as_mv.row;
-          sum_mvcs += d->bmi.mv.as_mv.col * d->bmi.mv.as_mv.col;
-          intercount++;
-
-          best_ref_mv.as_int = d->bmi.mv.as_int;
-
-          /* Was the vector non-zero */
-          if (d->bmi.mv.as_int) {
-            mvcount++;
-
-            /* Was it different from the last non zero vector */
-            if (d->bmi.mv.as_int != lastmv_as_int) new_mv_count++;
-            lastmv_as_int = d->bmi.mv.as_int;
-
-            /* Does the Row vector point inwards or outwards */
-            if (mb_row < cm->mb_rows / 2) {
-              if (d->bmi.mv.as_mv.row > 0) {
-                sum_in_vectors--;
-              } else if (d->bmi.mv.as_mv.row < 0) {
-                sum_in_vectors++;
-              }
-            } else if (mb_row > cm->mb_rows / 2) {
-              if (d->bmi.mv.as_mv.row > 0) {
-                sum_in_vectors++;
-              } else if (d->bmi.mv.as_mv.row < 0) {
-                sum_in_vectors--;
-              }
-            }
-
-            /* Does the Row vector point inwards or outwards */
-            if (mb_col < cm->mb_cols / 2) {
-              if (d->bmi.mv.as_mv.col > 0) {
-                sum_in_vectors--;
-              } else if (d->bmi.mv.as_mv.col < 0) {
-                sum_in_vectors++;
-              }
-            } else if (mb_col > cm->mb_cols / 2) {
-              if (d->bmi.mv.as_mv.col > 0) {
-                sum_in_vectors++;
-              } else if (d->bmi.mv.as_mv.col < 0) {
-                sum_in_vectors--;
-              }
-            }
-          }
-        }
-      }
-
-      coded_error += (int64_t)this_error;
+#if CONFIG_MULTITHREAD
+  if (vpx_atomic_load_acquire(&cpi->b_multi_threaded)) {
+    int i;
 
-      /* adjust to the next column of macroblocks */
-      x->src.y_buffer += 16;
-      x->src.u_buffer += 8;
-      x->src.v_buffer += 8;
+    vp8cx_copy_mbrthread_data(x, cpi->mb_row_ei, cpi->encoding_thread_count);
+    for (i = 0; i < cpi->encoding_thread_count; ++i) {
+      init_first_pass_mb(cpi, &cpi->mb_row_ei[i].mb);
+    }
 
-      recon_yoffset += 16;
-      recon_uvoffset += 8;
+    for (i = 0; i < cm->mb_rows; ++i) {
+      vpx_atomic_store_release(&cpi->mt_current_mb_col[i], -1);
     }
 
-    /* adjust to the next row of mbs */
-    x->src.y_buffer += 16 * x->src.y_stride - 16 * cm->mb_cols;
-    x->src.u_buffer += 8 * x->src.uv_stride - 8 * cm->mb_cols;
-    x->src.v_buffer += 8 * x->src.uv_stride - 8 * cm->mb_cols;
+    cpi->b_mt_first_pass = 1;
+    for (i = 0; i < cpi->encoding_thread_count; ++i) {
+      sem_post(&cpi->h_event_start_encoding[i]);
+    }
+    vp8_first_pass_mb_rows(cpi, x, 0);
+    for (i = 0; i < cpi->encoding_thread_count; ++i) {
+      sem_wait(&cpi->h_event_end_encoding[i]);
+    }
+    cpi->b_mt_first_pass = 0;
+  } else
+#endif
+  {
+    /* for each macroblock row in image */
+    for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
+      first_pass_mb_row(cpi, x, mb_row);
+    }
+  }
 
-    /* extend the recon for intra prediction */
-    vp8_extend_mb_row(new_yv12, xd->dst.y_buffer + 16, xd->dst.u_buffer + 8,
-                      xd->dst.v_buffer + 8);
-    vpx_clear_system_state();
+  /* Sum the row statistics in row order. */
+  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
+    const FIRSTPASS_MB_ROW_STATS *const stats =
+        &cpi->twopass.mb_row_stats[mb_row];
+
+    intra_error += stats->intra_error;
+    coded_error += stats->coded_error;
+    sum_mvr += stats->sum_mvr;
+    sum_mvc += stats->sum_mvc;
+    sum_mvr_abs += stats->sum_mvr_abs;
+    sum_mvc_abs += stats->sum_mvc_abs;
+    sum_mvrs += stats->sum_mvrs;
+    sum_mvcs += stats->sum_mvcs;
+    mvcount += stats->mvcount;
+    intercount += stats->intercount;
+    second_ref_count += stats->second_ref_count;
+    neutral_count += stats->neutral_count;
+    sum_in_vectors += stats->sum_in_vectors;
+
+    if (stats->mvcount) {
+      new_mv_count += stats->new_mv_count;
+      if (stats->first_mv_as_int != lastmv_as_int) new_mv_count++;
+      lastmv_as_int = stats->last_mv_as_int;
+    }
   }
 
   vpx_clear_system_state();
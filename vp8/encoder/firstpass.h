@@ -24,6 +24,12 @@ extern void vp8_second_pass(VP8_COMP *cpi);
 extern void vp8_end_second_pass(VP8_COMP *cpi);
 
 extern size_t vp8_firstpass_stats_sz(unsigned int mb_count);
+
+#if CONFIG_MULTITHREAD
+/* Runs the first pass on the macroblock rows of an encoding thread, thread 0
+ * being the main thread. */
+void vp8_first_pass_mb_rows(VP8_COMP *cpi, MACROBLOCK *x, int ithread);
+#endif
 #ifdef __cplusplus
 }  // extern "C"
 #endif
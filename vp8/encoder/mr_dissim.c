@@ -47,15 +47,144 @@ void vp8_cal_low_res_mb_cols(VP8_COMP *cpi) {
     cnt++;                                              \
   }
 
+static void store_frame_info(const VP8_COMP *cpi,
+                             LOWER_RES_FRAME_INFO *store_info) {
+  const VP8_COMMON *cm = &cpi->common;
+  int i;
+
+  store_info->frame_type = cm->frame_type;
+
+  if (cm->frame_type != KEY_FRAME) {
+    store_info->is_frame_dropped = 0;
+    for (i = 1; i < MAX_REF_FRAMES; ++i)
+      store_info->low_res_ref_frames[i] = cpi->current_ref_frames[i];
+  }
+}
+
+/* Stores the mode info of a row, the rows above and below it must be coded.
+ * Note: The first row & first column in mip are outside the frame, which
+ * were initialized to all 0.(ref_frame, mode, mv...)
+ * Their ref_frame = 0 means they won't be counted in the following
+ * calculation.
+ */
+static void store_mb_row(const VP8_COMP *cpi, int mb_row,
+                         LOWER_RES_MB_INFO *store_mode_info) {
+  const VP8_COMMON *cm = &cpi->common;
+  const MODE_INFO *tmp = cm->mi + mb_row * cm->mode_info_stride;
+  int mb_col;
+
+  for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
+    int dissim = INT_MAX;
+
+    if (tmp->mbmi.ref_frame != INTRA_FRAME) {
+      int mvx[8];
+      int mvy[8];
+      int mmvx;
+      int mmvy;
+      int cnt = 0;
+      const MODE_INFO *here = tmp;
+      const MODE_INFO *above = here - cm->mode_info_stride;
+      const MODE_INFO *left = here - 1;
+      const MODE_INFO *aboveleft = above - 1;
+      const MODE_INFO *aboveright = NULL;
+      const MODE_INFO *right = NULL;
+      const MODE_INFO *belowleft = NULL;
+      const MODE_INFO *below = NULL;
+      const MODE_INFO *belowright = NULL;
+
+      /* If alternate reference frame is used, we have to
+       * check sign of MV. */
+      if (cpi->oxcf.play_alternate) {
+        /* Gather mv of neighboring MBs */
+        GET_MV_SIGN(above)
+        GET_MV_SIGN(left)
+        GET_MV_SIGN(aboveleft)
+
+        if (mb_col < (cm->mb_cols - 1)) {
+          right = here + 1;
+          aboveright = above + 1;
+          GET_MV_SIGN(right)
+          GET_MV_SIGN(aboveright)
+        }
+
+        if (mb_row < (cm->mb_rows - 1)) {
+          below = here + cm->mode_info_stride;
+          belowleft = below - 1;
+          GET_MV_SIGN(below)
+          GET_MV_SIGN(belowleft)
+        }
+
+        if (mb_col < (cm->mb_cols - 1) && mb_row < (cm->mb_rows - 1)) {
+          belowright = below + 1;
+          GET_MV_SIGN(belowright)
+        }
+      } else {
+        /* No alt_ref and gather mv of neighboring MBs */
+        GET_MV(above)
+        GET_MV(left)
+        GET_MV(aboveleft)
+
+        if (mb_col < (cm->mb_cols - 1)) {
+          right = here + 1;
+          aboveright = above + 1;
+          GET_MV(right)
+          GET_MV(aboveright)
+        }
+
+        if (mb_row < (cm->mb_rows - 1)) {
+          below = here + cm->mode_info_stride;
+          belowleft = below - 1;
+          GET_MV(below)
+          GET_MV(belowleft)
+        }
+
+        if (mb_col < (cm->mb_cols - 1) && mb_row < (cm->mb_rows - 1)) {
+          belowright = below + 1;
+          GET_MV(belowright)
+        }
+      }
+
+      if (cnt > 0) {
+        int max_mvx = mvx[0];
+        int min_mvx = mvx[0];
+        int max_mvy = mvy[0];
+        int min_mvy = mvy[0];
+        int i;
+
+        if (cnt > 1) {
+          for (i = 1; i < cnt; ++i) {
+            if (mvx[i] > max_mvx)
+              max_mvx = mvx[i];
+            else if (mvx[i] < min_mvx)
+              min_mvx = mvx[i];
+            if (mvy[i] > max_mvy)
+              max_mvy = mvy[i];
+            else if (mvy[i] < min_mvy)
+              min_mvy = mvy[i];
+          }
+        }
+
+        mmvx = VPXMAX(abs(min_mvx - here->mbmi.mv.as_mv.row),
+                      abs(max_mvx - here->mbmi.mv.as_mv.row));
+        mmvy = VPXMAX(abs(min_mvy - here->mbmi.mv.as_mv.col),
+                      abs(max_mvy - here->mbmi.mv.as_mv.col));
+        dissim = VPXMAX(mmvx, mmvy);
+      }
+    }
+
+    /* Store mode info for next resolution encoding */
+    store_mode_info->mode = tmp->mbmi.mode;
+    store_mode_info->ref_frame = tmp->mbmi.ref_frame;
+    store_mode_info->mv.as_int = tmp->mbmi.mv.as_int;
+    store_mode_info->dissim = dissim;
+    tmp++;
+    store_mode_info++;
+  }
+}
+
 void vp8_cal_dissimilarity(VP8_COMP *cpi) {
   VP8_COMMON *cm = &cpi->common;
-  int i;
 
-  /* Note: The first row & first column in mip are outside the frame, which
-   * were initialized to all 0.(ref_frame, mode, mv...)
-   * Their ref_frame = 0 means they won't be counted in the following
-   * calculation.
-   */
   if (cpi->oxcf.mr_total_resolutions > 1 &&
       cpi->oxcf.mr_encoder_id < (cpi->oxcf.mr_total_resolutions - 1)) {
     /* Store info for show/no-show frames for supporting alt_ref.
@@ -63,133 +192,30 @@ void vp8_cal_dissimilarity(VP8_COMP *cpi) {
      */
     LOWER_RES_FRAME_INFO *store_info =
         (LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info;
+    LOWER_RES_MB_INFO *mb_info = store_info->mb_info;
+#if CONFIG_MULTITHREAD
+    MR_SYNC *const sync = cpi->mr_sync;
 
-    store_info->frame_type = cm->frame_type;
+    /* Everything was stored while the frame was coded. */
+    if (sync && sync->rows_in_encode) return;
+    if (sync) mb_info = sync->mb_info;
+#endif
 
-    if (cm->frame_type != KEY_FRAME) {
-      store_info->is_frame_dropped = 0;
-      for (i = 1; i < MAX_REF_FRAMES; ++i)
-        store_info->low_res_ref_frames[i] = cpi->current_ref_frames[i];
-    }
+    store_frame_info(cpi, store_info);
 
     if (cm->frame_type != KEY_FRAME) {
       int mb_row;
-      int mb_col;
-      /* Point to beginning of allocated MODE_INFO arrays. */
-      MODE_INFO *tmp = cm->mip + cm->mode_info_stride;
-      LOWER_RES_MB_INFO *store_mode_info = store_info->mb_info;
-
-      for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
-        tmp++;
-        for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
-          int dissim = INT_MAX;
-
-          if (tmp->mbmi.ref_frame != INTRA_FRAME) {
-            int mvx[8];
-            int mvy[8];
-            int mmvx;
-            int mmvy;
-            int cnt = 0;
-            const MODE_INFO *here = tmp;
-            const MODE_INFO *above = here - cm->mode_info_stride;
-            const MODE_INFO *left = here - 1;
-            const MODE_INFO *aboveleft = above - 1;
-            const MODE_INFO *aboveright = NULL;
-            const MODE_INFO *right = NULL;
-            const MODE_INFO *belowleft = NULL;
-            const MODE_INFO *below = NULL;
-            const MODE_INFO *belowright = NULL;
-
-            /* If alternate reference frame is used, we have to
-             * check sign of MV. */
-            if (cpi->oxcf.play_alternate) {
-              /* Gather mv of neighboring MBs */
-              GET_MV_SIGN(above)
-              GET_MV_SIGN(left)
-              GET_MV_SIGN(aboveleft)
-
-              if (mb_col < (cm->mb_cols - 1)) {
-                right = here + 1;
-                aboveright = above + 1;
-                GET_MV_SIGN(right)
-                GET_MV_SIGN(aboveright)
-              }
-
-              if (mb_row < (cm->mb_rows - 1)) {
-                below = here + cm->mode_info_stride;
-                belowleft = below - 1;
-                GET_MV_SIGN(below)
-                GET_MV_SIGN(belowleft)
-              }
-
-              if (mb_col < (cm->mb_cols - 1) && mb_row < (cm->mb_rows - 1)) {
-                belowright = below + 1;
-                GET_MV_SIGN(belowright)
-              }
-            } else {
-              /* No alt_ref and gather mv of neighboring MBs */
-              GET_MV(above)
-              GET_MV(left)
-              GET_MV(aboveleft)
-
-              if (mb_col < (cm->mb_cols - 1)) {
-                right = here + 1;
-                aboveright = above + 1;
-                GET_MV(right)
-                GET_MV(aboveright)
-              }
-
-              if (mb_row < (cm->mb_rows - 1)) {
-                below = here + cm->mode_info_stride;
-                belowleft = below - 1;
-                GET_MV(below)
-                GET_MV(belowleft)
-              }
-
-              if (mb_col < (cm->mb_cols - 1) && mb_row < (cm->mb_rows - 1)) {
-                belowright = below + 1;
-                GET_MV(belowright)
-              }
-            }
-
-            if (cnt > 0) {
-              int max_mvx = mvx[0];
-              int min_mvx = mvx[0];
-              int max_mvy = mvy[0];
-              int min_mvy = mvy[0];
-              int i;
-
-              if (cnt > 1) {
-                for (i = 1; i < cnt; ++i) {
-                  if (mvx[i] > max_mvx)
-                    max_mvx = mvx[i];
-                  else if (mvx[i] < min_mvx)
-                    min_mvx = mvx[i];
-                  if (mvy[i] > max_mvy)
-                    max_mvy = mvy[i];
-                  else if (mvy[i] < min_mvy)
-                    min_mvy = mvy[i];
-                }
-              }
-
-              mmvx = VPXMAX(abs(min_mvx - here->mbmi.mv.as_mv.row),
-                            abs(max_mvx - here->mbmi.mv.as_mv.row));
-              mmvy = VPXMAX(abs(min_mvy - here->mbmi.mv.as_mv.col),
-                            abs(max_mvy - here->mbmi.mv.as_mv.col));
-              dissim = VPXMAX(mmvx, mmvy);
-            }
-          }
 
-          /* Store mode info for next resolution encoding */
-          store_mode_info->mode = tmp->mbmi.mode;
-          store_mode_info->ref_frame = tmp->mbmi.ref_frame;
-          store_mode_info->mv.as_int = tmp->mbmi.mv.as_int;
-          store_mode_info->dissim = dissim;
-          tmp++;
-          store_mode_info++;
-        }
-      }
+      for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row)
+        store_mb_row(cpi, mb_row, mb_info + mb_row * cm->mb_cols);
     }
+
+#if CONFIG_MULTITHREAD
+    if (sync) {
+      vpx_atomic_store_release(&sync->mb_rows_ready, cm->mb_rows);
+      vpx_atomic_store_release(&sync->frame_info_ready, 1);
+    }
+#endif
   }
 }
 
@@ -213,3 +239,130 @@ void vp8_store_drop_frame_info(VP8_COMP *cpi) {
     store_info->is_frame_dropped = 1;
   }
 }
+
+#if CONFIG_MULTITHREAD
+static void wait_for(const vpx_atomic_int *stage, int value) {
+  while (vpx_atomic_load_acquire(stage) < value) {
+    x86_pause_hint();
+    thread_sleep(0);
+  }
+}
+
+int vp8_mr_start_frame(VP8_COMP *cpi, const VP8_COMP *low_res_cpi) {
+  const VP8_COMMON *cm = &cpi->common;
+
+  cpi->mr_low_res_sync = NULL;
+  if (low_res_cpi) {
+    const VP8_COMMON *low_res_cm = &low_res_cpi->common;
+    const int last_parent_mb_row =
+        (cm->mb_rows - 1) * cpi->oxcf.mr_down_sampling_factor.den /
+        cpi->oxcf.mr_down_sampling_factor.num;
+
+    /* The hints are read with the geometry of vp8_cal_low_res_mb_cols(). */
+    if (!low_res_cpi->mr_sync ||
+        low_res_cm->mb_cols != cpi->mr_low_res_mb_cols ||
+        low_res_cm->mb_rows <= last_parent_mb_row)
+      return -1;
+    cpi->mr_low_res_sync = low_res_cpi->mr_sync;
+  }
+
+  if (cpi->oxcf.mr_encoder_id < cpi->oxcf.mr_total_resolutions - 1) {
+    MR_SYNC *sync = cpi->mr_sync;
+
+    if (!sync) {
+      sync = vpx_calloc(1, sizeof(*sync));
+      if (!sync) return -1;
+      cpi->mr_sync = sync;
+    }
+
+    if (sync->mb_rows != cm->mb_rows || sync->mb_cols != cm->mb_cols) {
+      vpx_free(sync->mb_info);
+      sync->mb_info = vpx_calloc(cm->mb_rows * cm->mb_cols,
+                                 sizeof(*sync->mb_info));
+      if (!sync->mb_info) {
+        sync->mb_rows = sync->mb_cols = 0;
+        return -1;
+      }
+      sync->mb_rows = cm->mb_rows;
+      sync->mb_cols = cm->mb_cols;
+    }
+
+    vpx_atomic_init(&sync->frame_info_ready, 0);
+    vpx_atomic_init(&sync->mb_rows_ready, 0);
+    vpx_atomic_init(&sync->frame_encoded, 0);
+    sync->rows_in_encode = 0;
+  }
+  return 0;
+}
+
+void vp8_mr_finish_frame(VP8_COMP *cpi) {
+  MR_SYNC *const sync = cpi->mr_sync;
+
+  /* Whatever was not stored stays as it was, like with the sequential
+   * encode of a dropped or skipped frame.
+   */
+  if (sync) {
+    vpx_atomic_store_release(&sync->frame_encoded, 1);
+    vpx_atomic_store_release(&sync->mb_rows_ready, INT_MAX);
+    vpx_atomic_store_release(&sync->frame_info_ready, 1);
+  }
+}
+
+void vp8_mr_free_sync(VP8_COMP *cpi) {
+  if (cpi->mr_sync) vpx_free(cpi->mr_sync->mb_info);
+  vpx_free(cpi->mr_sync);
+  cpi->mr_sync = NULL;
+  cpi->mr_low_res_sync = NULL;
+}
+
+void vp8_mr_store_frame_info(VP8_COMP *cpi) {
+  MR_SYNC *const sync = cpi->mr_sync;
+
+  if (sync) {
+    store_frame_info(cpi,
+                     (LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info);
+    sync->rows_in_encode = 1;
+    /* Nothing is stored for the rows of a key frame. */
+    if (cpi->common.frame_type == KEY_FRAME)
+      vpx_atomic_store_release(&sync->mb_rows_ready, cpi->common.mb_rows);
+    vpx_atomic_store_release(&sync->frame_info_ready, 1);
+  }
+}
+
+void vp8_mr_store_row(VP8_COMP *cpi, int mb_row) {
+  MR_SYNC *const sync = cpi->mr_sync;
+  const VP8_COMMON *cm = &cpi->common;
+
+  /* Once row mb_row is coded, all the neighbours of the row above are. */
+  if (sync && sync->rows_in_encode && cm->frame_type != KEY_FRAME &&
+      mb_row > 0) {
+    /* The encoding threads finish their rows out of order. */
+    wait_for(&sync->mb_rows_ready, mb_row - 1);
+    store_mb_row(cpi, mb_row - 1, sync->mb_info + (mb_row - 1) * cm->mb_cols);
+    vpx_atomic_store_release(&sync->mb_rows_ready, mb_row);
+  }
+}
+
+void vp8_mr_frame_encoded(VP8_COMP *cpi) {
+  if (cpi->mr_sync) vpx_atomic_store_release(&cpi->mr_sync->frame_encoded, 1);
+}
+
+void vp8_mr_wait_for_low_res_frame(const VP8_COMP *cpi) {
+  if (cpi->mr_low_res_sync)
+    wait_for(&cpi->mr_low_res_sync->frame_info_ready, 1);
+}
+
+void vp8_mr_wait_for_low_res_row(const VP8_COMP *cpi, int mb_row) {
+  if (cpi->mr_low_res_sync && cpi->mr_low_res_mv_avail &&
+      cpi->common.frame_type != KEY_FRAME) {
+    /* The parent macroblock of get_lower_res_motion_info(). */
+    const int parent_mb_row = mb_row * cpi->oxcf.mr_down_sampling_factor.den /
+                              cpi->oxcf.mr_down_sampling_factor.num;
+    wait_for(&cpi->mr_low_res_sync->mb_rows_ready, parent_mb_row + 1);
+  }
+}
+
+void vp8_mr_wait_for_low_res_encoded(const VP8_COMP *cpi) {
+  if (cpi->mr_low_res_sync) wait_for(&cpi->mr_low_res_sync->frame_encoded, 1);
+}
+#endif  // CONFIG_MULTITHREAD
@@ -20,6 +20,32 @@ extern void vp8_cal_low_res_mb_cols(VP8_COMP *cpi);
 extern void vp8_cal_dissimilarity(VP8_COMP *cpi);
 extern void vp8_store_drop_frame_info(VP8_COMP *cpi);
 
+#if CONFIG_MULTITHREAD
+/* With VPX_CODEC_USE_MR_PIPELINE each resolution is coded on its own thread.
+ * A lower resolution stores its hints as soon as they are final and the next
+ * higher one waits for the part it needs next.
+ */
+
+/* Resets the progress of cpi and links it to the next lower resolution, NULL
+ * for the lowest. Returns nonzero on failure.
+ */
+extern int vp8_mr_start_frame(VP8_COMP *cpi, const VP8_COMP *low_res_cpi);
+/* Marks everything stored, for any way out of the frame encode. */
+extern void vp8_mr_finish_frame(VP8_COMP *cpi);
+extern void vp8_mr_free_sync(VP8_COMP *cpi);
+
+/* Without a recode loop the frame level info is known before the frame is
+ * coded, and each row is final once the row below it is coded.
+ */
+extern void vp8_mr_store_frame_info(VP8_COMP *cpi);
+extern void vp8_mr_store_row(VP8_COMP *cpi, int mb_row);
+extern void vp8_mr_frame_encoded(VP8_COMP *cpi);
+
+extern void vp8_mr_wait_for_low_res_frame(const VP8_COMP *cpi);
+extern void vp8_mr_wait_for_low_res_row(const VP8_COMP *cpi, int mb_row);
+extern void vp8_mr_wait_for_low_res_encoded(const VP8_COMP *cpi);
+#endif
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "./vp8_rtcd.h"
+#include "vp8/encoder/mr_scale.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+
+void vp8_mr_downscale_2to1_c(const unsigned char *src, int src_stride,
+                             unsigned char *dst, int dst_stride, int width,
+                             int height) {
+  int r, c;
+
+  for (r = 0; r < height; ++r) {
+    const unsigned char *const s0 = src + 2 * r * src_stride;
+    const unsigned char *const s1 = s0 + src_stride;
+
+    for (c = 0; c < width; ++c) {
+      dst[c] = (s0[2 * c] + s0[2 * c + 1] + s1[2 * c] + s1[2 * c + 1] + 2) >> 2;
+    }
+    dst += dst_stride;
+  }
+}
+
+static void scale_plane(const unsigned char *src, int src_stride, int src_w,
+                        int src_h, unsigned char *dst, int dst_stride,
+                        int dst_w, int dst_h) {
+  int r, c;
+
+  if (src_w == 2 * dst_w && src_h == 2 * dst_h) {
+    vp8_mr_downscale_2to1(src, src_stride, dst, dst_stride, dst_w, dst_h);
+    return;
+  }
+
+  /* Any other ratio: each destination pixel is the average of the source
+   * pixels it covers, at least one in each direction.
+   */
+  for (r = 0; r < dst_h; ++r) {
+    const int r0 = r * src_h / dst_h;
+    const int r1 = VPXMAX((r + 1) * src_h / dst_h, r0 + 1);
+
+    for (c = 0; c < dst_w; ++c) {
+      const int c0 = c * src_w / dst_w;
+      const int c1 = VPXMAX((c + 1) * src_w / dst_w, c0 + 1);
+      const int count = (r1 - r0) * (c1 - c0);
+      int sum = 0;
+      int i, j;
+
+      for (i = r0; i < r1; ++i) {
+        for (j = c0; j < c1; ++j) sum += src[i * src_stride + j];
+      }
+      dst[c] = (sum + count / 2) / count;
+    }
+    dst += dst_stride;
+  }
+}
+
+void vp8_mr_scale_frame(const YV12_BUFFER_CONFIG *src,
+                        YV12_BUFFER_CONFIG *dst) {
+  scale_plane(src->y_buffer, src->y_stride, src->y_crop_width,
+              src->y_crop_height, dst->y_buffer, dst->y_stride,
+              dst->y_crop_width, dst->y_crop_height);
+  scale_plane(src->u_buffer, src->uv_stride, src->uv_crop_width,
+              src->uv_crop_height, dst->u_buffer, dst->uv_stride,
+              dst->uv_crop_width, dst->uv_crop_height);
+  scale_plane(src->v_buffer, src->uv_stride, src->uv_crop_width,
+              src->uv_crop_height, dst->v_buffer, dst->uv_stride,
+              dst->uv_crop_width, dst->uv_crop_height);
+}
@@ -0,0 +1,29 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VP8_ENCODER_MR_SCALE_H_
+#define VPX_VP8_ENCODER_MR_SCALE_H_
+#include "vpx_scale/yv12config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Downscales the 8 bit 4:2:0 src to the size of dst, averaging the source
+ * pixels that each destination pixel covers. This is the source of the lower
+ * resolutions with VPX_CODEC_USE_MR_PIPELINE.
+ */
+void vp8_mr_scale_frame(const YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VP8_ENCODER_MR_SCALE_H_
@@ -406,6 +406,9 @@ static void dealloc_compressor_data(VP8_COMP *cpi) {
   vpx_free(cpi->tplist);
   cpi->tplist = NULL;
 
+  vpx_free(cpi->twopass.mb_row_stats);
+  cpi->twopass.mb_row_stats = NULL;
+
   /* Delete last frame MV storage buffers */
   vpx_free(cpi->lfmv);
   cpi->lfmv = 0;
@@ -787,6 +790,7 @@ void vp8_set_speed_features(VP8_COMP *cpi) {
   sf->improved_dct = 1;
   sf->auto_filter = 1;
   sf->recode_loop = 1;
+  sf->recode_early_abort = 0;
   sf->quarter_pixel_search = 1;
   sf->half_pixel_search = 1;
   sf->iterative_sub_pixel = 1;
@@ -898,6 +902,9 @@ void vp8_set_speed_features(VP8_COMP *cpi) {
         sf->no_skip_block4x4_search = 0;
 
         sf->first_step = 1;
+
+        /* Cut short the encodes the recode loop would throw away */
+        sf->recode_early_abort = 1;
       }
 
       if (Speed > 2) {
@@ -1053,8 +1060,10 @@ void vp8_set_speed_features(VP8_COMP *cpi) {
 
   if (cpi->sf.improved_quant) {
     cpi->mb.quantize_b = vp8_regular_quantize_b;
+    cpi->mb.quantize_blocks = vp8_regular_quantize_blocks;
   } else {
     cpi->mb.quantize_b = vp8_fast_quantize_b;
+    cpi->mb.quantize_blocks = vp8_fast_quantize_blocks;
   }
   if (cpi->sf.improved_quant != last_improved_quant) vp8cx_init_quantizer(cpi);
 
@@ -1237,6 +1246,11 @@ void vp8_alloc_compressor_data(VP8_COMP *cpi) {
   vpx_free(cpi->tplist);
   CHECK_MEM_ERROR(cpi->tplist, vpx_malloc(sizeof(TOKENLIST) * cm->mb_rows));
 
+  vpx_free(cpi->twopass.mb_row_stats);
+  CHECK_MEM_ERROR(
+      cpi->twopass.mb_row_stats,
+      vpx_malloc(sizeof(*cpi->twopass.mb_row_stats) * cm->mb_rows));
+
 #if CONFIG_TEMPORAL_DENOISING
   if (cpi->oxcf.noise_sensitivity > 0) {
     vp8_denoiser_free(&cpi->denoiser);
@@ -2255,6 +2269,10 @@ void vp8_remove_compressor(VP8_COMP **comp) {
   vp8cx_remove_encoder_threads(cpi);
 #endif
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  vp8_mr_free_sync(cpi);
+#endif
+
 #if CONFIG_TEMPORAL_DENOISING
   vp8_denoiser_free(&cpi->denoiser);
 #endif
@@ -2802,22 +2820,27 @@ void write_cx_frame_to_file(YV12_BUFFER_CONFIG *frame, int this_frame)
 #endif
 
 #if !CONFIG_REALTIME_ONLY
+/* Is frame recode allowed at all
+ * Yes if either recode mode 1 is selected or mode two is selcted
+ * and the frame is a key frame. golden frame or alt_ref_frame
+ */
+static int recode_loop_allowed(const VP8_COMP *cpi) {
+  const VP8_COMMON *cm = &cpi->common;
+
+  return (cpi->sf.recode_loop == 1) ||
+         ((cpi->sf.recode_loop == 2) &&
+          ((cm->frame_type == KEY_FRAME) || cm->refresh_golden_frame ||
+           cm->refresh_alt_ref_frame));
+}
+
 /* Function to test for conditions that indeicate we should loop
  * back and recode a frame.
  */
 static int recode_loop_test(VP8_COMP *cpi, int high_limit, int low_limit, int q,
                             int maxq, int minq) {
   int force_recode = 0;
-  VP8_COMMON *cm = &cpi->common;
 
-  /* Is frame recode allowed at all
-   * Yes if either recode mode 1 is selected or mode two is selcted
-   * and the frame is a key frame. golden frame or alt_ref_frame
-   */
-  if ((cpi->sf.recode_loop == 1) ||
-      ((cpi->sf.recode_loop == 2) &&
-       ((cm->frame_type == KEY_FRAME) || cm->refresh_golden_frame ||
-        cm->refresh_alt_ref_frame))) {
+  if (recode_loop_allowed(cpi)) {
     /* General over and under shoot tests */
     if (((cpi->projected_frame_size > high_limit) && (q < maxq)) ||
         ((cpi->projected_frame_size < low_limit) && (q > minq))) {
@@ -2842,6 +2865,29 @@ static int recode_loop_test(VP8_COMP *cpi, int high_limit, int low_limit, int q,
 
   return force_recode;
 }
+
+/* Arm the early abort of the next encode in the recode loop. The size is
+ * projected from the first quarter of the rows, so the margins are wide:
+ * only encodes that recode_loop_test() would certainly reject are cut short.
+ */
+static void setup_recode_early_abort(VP8_COMP *cpi, int high_limit,
+                                     int low_limit, int q, int maxq,
+                                     int minq) {
+  const VP8_COMMON *cm = &cpi->common;
+
+  cpi->recode_abort_row = 0;
+
+  if (!cpi->sf.recode_early_abort || !recode_loop_allowed(cpi) ||
+      cpi->is_src_frame_alt_ref || cm->mb_rows < 4 ||
+      ((cm->frame_type == KEY_FRAME) && cpi->this_key_frame_forced)) {
+    return;
+  }
+
+  cpi->recode_abort_row = cm->mb_rows >> 2;
+  cpi->recode_abort_high =
+      (q < maxq && high_limit < INT_MAX / 2) ? 2 * high_limit : INT_MAX;
+  cpi->recode_abort_low = (q > minq) ? low_limit / 2 : 0;
+}
 #endif  // !CONFIG_REALTIME_ONLY
 
 static void update_reference_frames(VP8_COMP *cpi) {
@@ -3215,6 +3261,7 @@ static void encode_frame_to_data_rate(VP8_COMP *cpi, size_t *size,
   int bottom_index;
   int overshoot_seen = 0;
   int undershoot_seen = 0;
+  int allow_early_abort = 1;
 #endif
 
   int drop_mark = (int)(cpi->oxcf.drop_frames_water_mark *
@@ -3913,6 +3960,11 @@ static void encode_frame_to_data_rate(VP8_COMP *cpi, size_t *size,
       vp8_setup_key_frame(cpi);
     }
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+    /* Real time frames are coded once, let the next resolution start. */
+    if (cpi->compressor_speed == 2) vp8_mr_store_frame_info(cpi);
+#endif
+
 #if CONFIG_REALTIME_ONLY & CONFIG_ONTHEFLY_BITPACKING
     {
       if (cpi->oxcf.error_resilient_mode) cm->refresh_entropy_probs = 0;
@@ -3938,11 +3990,26 @@ static void encode_frame_to_data_rate(VP8_COMP *cpi, size_t *size,
       /* cpi->projected_frame_size is not needed for RT mode */
     }
 #else
+#if !CONFIG_REALTIME_ONLY
+    if (allow_early_abort) {
+      setup_recode_early_abort(cpi, frame_over_shoot_limit,
+                               frame_under_shoot_limit, Q, top_index,
+                               bottom_index);
+    } else {
+      cpi->recode_abort_row = 0;
+    }
+#endif  // !CONFIG_REALTIME_ONLY
+
     /* transform / motion compensation build reconstruction frame */
     vp8_encode_frame(cpi);
 
-    if (cpi->pass == 0 && cpi->oxcf.end_usage == USAGE_STREAM_FROM_SERVER) {
-      if (vp8_drop_encodedframe_overshoot(cpi, Q)) {
+    if (!cpi->frame_encode_aborted && cpi->pass == 0 &&
+        cpi->oxcf.end_usage == USAGE_STREAM_FROM_SERVER) {
+      const int drop = vp8_drop_encodedframe_overshoot(cpi, Q);
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+      vp8_mr_frame_encoded(cpi);
+#endif
+      if (drop) {
         vpx_clear_system_state();
         return;
       }
@@ -3951,9 +4018,14 @@ static void encode_frame_to_data_rate(VP8_COMP *cpi, size_t *size,
             (int)(cpi->mb.prediction_error / cpi->common.MBs);
     }
 
-    cpi->projected_frame_size -= vp8_estimate_entropy_savings(cpi);
-    cpi->projected_frame_size =
-        (cpi->projected_frame_size > 0) ? cpi->projected_frame_size : 0;
+    /* An aborted encode leaves the projection that stopped it in
+     * cpi->projected_frame_size, the counts only cover part of the frame.
+     */
+    if (!cpi->frame_encode_aborted) {
+      cpi->projected_frame_size -= vp8_estimate_entropy_savings(cpi);
+      cpi->projected_frame_size =
+          (cpi->projected_frame_size > 0) ? cpi->projected_frame_size : 0;
+    }
 #endif
     vpx_clear_system_state();
 
@@ -3962,7 +4034,7 @@ static void encode_frame_to_data_rate(VP8_COMP *cpi, size_t *size,
      */
 
     if (cpi->pass != 2 && cpi->oxcf.auto_key && cm->frame_type != KEY_FRAME &&
-        cpi->compressor_speed != 2) {
+        cpi->compressor_speed != 2 && !cpi->frame_encode_aborted) {
 #if !CONFIG_REALTIME_ONLY
       if (decide_key_frame(cpi)) {
         /* Reset all our sizing numbers and recode */
@@ -4216,6 +4288,14 @@ static void encode_frame_to_data_rate(VP8_COMP *cpi, size_t *size,
 
     if (cpi->is_src_frame_alt_ref) Loop = 0;
 
+#if !CONFIG_REALTIME_ONLY
+    /* An aborted encode must be finished even when Q did not move. */
+    if (cpi->frame_encode_aborted && !Loop) {
+      allow_early_abort = 0;
+      Loop = 1;
+    }
+#endif  // !CONFIG_REALTIME_ONLY
+
     if (Loop == 1) {
       vp8_restore_coding_context(cpi);
       loop_count++;
@@ -4820,6 +4900,11 @@ int vp8_get_compressed_data(VP8_COMP *cpi, unsigned int *frame_flags,
 
   cm = &cpi->common;
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  /* The lower resolution stores the info this frame starts from. */
+  vp8_mr_wait_for_low_res_frame(cpi);
+#endif
+
   vpx_usec_timer_start(&cmptimer);
 
   cpi->source = NULL;
@@ -166,6 +166,10 @@ typedef struct {
   int improved_dct;
   int auto_filter;
   int recode_loop;
+  /* Abandon a recode loop encode early when the size projected from the
+   * first rows of the frame is far outside the permitted range.
+   */
+  int recode_early_abort;
   int iterative_sub_pixel;
   int half_pixel_search;
   int quarter_pixel_search;
@@ -191,6 +195,24 @@ typedef struct {
   TOKENEXTRA *stop;
 } TOKENLIST;
 
+/* First pass statistics of one macroblock row, summed in row order. */
+typedef struct {
+  int64_t intra_error;
+  int64_t coded_error;
+  int sum_mvr, sum_mvc;
+  int sum_mvr_abs, sum_mvc_abs;
+  int sum_mvrs, sum_mvcs;
+  int mvcount;
+  int intercount;
+  int second_ref_count;
+  int neutral_count;
+  int new_mv_count;
+  int sum_in_vectors;
+  /* First and last non zero motion vectors of the row. */
+  uint32_t first_mv_as_int;
+  uint32_t last_mv_as_int;
+} FIRSTPASS_MB_ROW_STATS;
+
 typedef struct {
   int ithread;
   void *ptr1;
@@ -263,6 +285,26 @@ typedef struct {
   int last_q[2];
 } LAYER_CONTEXT;
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+/* Progress of a lower resolution encode when the resolutions are encoded in
+ * parallel (VPX_CODEC_USE_MR_PIPELINE). The next higher resolution waits on
+ * it instead of running after the whole frame.
+ */
+typedef struct {
+  /* The LOWER_RES_FRAME_INFO fields of the frame are stored. */
+  vpx_atomic_int frame_info_ready;
+  /* Number of macroblock rows stored in mb_info. */
+  vpx_atomic_int mb_rows_ready;
+  /* The overshoot drop of the frame is decided. */
+  vpx_atomic_int frame_encoded;
+  /* The rows are stored while the frame is coded, not after it. */
+  int rows_in_encode;
+  int mb_rows;
+  int mb_cols;
+  LOWER_RES_MB_INFO *mb_info;
+} MR_SYNC;
+#endif
+
 typedef struct VP8_COMP {
   DECLARE_ALIGNED(16, short, Y1quant[QINDEX_RANGE][16]);
   DECLARE_ALIGNED(16, short, Y1quant_shift[QINDEX_RANGE][16]);
@@ -345,6 +387,14 @@ typedef struct VP8_COMP {
 
   int this_frame_target;
   int projected_frame_size;
+  /* Early abort of the recode loop encode: the size is projected after
+   * recode_abort_row rows and the encode is abandoned when it falls
+   * outside (recode_abort_low, recode_abort_high). 0 rows disables it.
+   */
+  int recode_abort_row;
+  int recode_abort_high;
+  int recode_abort_low;
+  int frame_encode_aborted;
   int last_q[2]; /* Separate values for Intra/Inter */
 
   double rate_correction_factor;
@@ -541,6 +591,20 @@ typedef struct VP8_COMP {
   sem_t *h_event_end_encoding;
   sem_t h_event_start_lpf;
   sem_t h_event_end_lpf;
+
+  /* The encoding threads pack the token partitions instead of encoding
+   * macroblock rows. */
+  int b_mt_pack_tokens;
+  int mt_pack_num_part;
+  int mt_pack_done[MAX_PARTITIONS];
+
+  /* The encoding threads run the first pass or filter the alt ref frame on
+   * macroblock rows. */
+  int b_mt_first_pass;
+  int b_mt_temporal_filter;
+  int mt_arnr_frames;
+  int mt_arnr_alt_ref_index;
+  int mt_arnr_strength;
 #endif
 
   TOKENLIST *tplist;
@@ -571,6 +635,7 @@ typedef struct VP8_COMP {
     FIRSTPASS_STATS total_stats;
     FIRSTPASS_STATS this_frame_stats;
     FIRSTPASS_STATS *stats_in, *stats_in_end, *stats_in_start;
+    FIRSTPASS_MB_ROW_STATS *mb_row_stats;
     FIRSTPASS_STATS total_left_stats;
     int first_pass_done;
     int64_t bits_left;
@@ -680,6 +745,13 @@ typedef struct VP8_COMP {
   int mr_low_res_mb_cols;
   /* Indicate if lower-res mv info is available */
   unsigned char mr_low_res_mv_avail;
+#if CONFIG_MULTITHREAD
+  /* Set when the resolutions are encoded in parallel: the progress of this
+   * encoder for the next higher resolution, and that of the next lower one.
+   */
+  MR_SYNC *mr_sync;
+  const MR_SYNC *mr_low_res_sync;
+#endif
 #endif
   /* The frame number of each reference frames */
   unsigned int current_ref_frames[MAX_REF_FRAMES];
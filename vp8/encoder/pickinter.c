@@ -399,6 +399,11 @@ static void get_lower_res_motion_info(VP8_COMP *cpi, MACROBLOCKD *xd,
       ((LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info)->mb_info;
   unsigned int parent_mb_index;
 
+#if CONFIG_MULTITHREAD
+  /* Each resolution keeps its own hints when they are coded in parallel. */
+  if (cpi->mr_low_res_sync) store_mode_info = cpi->mr_low_res_sync->mb_info;
+#endif
+
   /* Consider different down_sampling_factor.  */
   {
     /* TODO: Removed the loop that supports special down_sampling_factor
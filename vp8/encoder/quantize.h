@@ -17,6 +17,10 @@ extern "C" {
 
 struct VP8_COMP;
 struct macroblock;
+struct block;
+struct blockd;
+extern void vp8_regular_quantize_blocks(struct block *b, struct blockd *d,
+                                        int count);
 extern void vp8_quantize_mb(struct macroblock *x);
 extern void vp8_quantize_mby(struct macroblock *x);
 extern void vp8_quantize_mbuv(struct macroblock *x);
@@ -23,6 +23,9 @@
 #include "encodemv.h"
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_ports/system_state.h"
+#if CONFIG_MULTI_RES_ENCODING
+#include "mr_dissim.h"
+#endif
 
 #define MIN_BPB_FACTOR 0.01
 #define MAX_BPB_FACTOR 50
@@ -1481,6 +1484,9 @@ int vp8_drop_encodedframe_overshoot(VP8_COMP *cpi, int Q) {
   LOWER_RES_FRAME_INFO *low_res_frame_info =
       (LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info;
   if (cpi->oxcf.mr_total_resolutions > 1 && cpi->oxcf.mr_encoder_id > 0) {
+#if CONFIG_MULTITHREAD
+    vp8_mr_wait_for_low_res_encoded(cpi);
+#endif
     force_drop_overshoot = low_res_frame_info->is_frame_dropped_overshoot_maxqp;
     if (!force_drop_overshoot) {
       cpi->force_maxqp = 0;
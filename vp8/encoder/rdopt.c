@@ -469,7 +469,6 @@ static int vp8_rdcost_mby(MACROBLOCK *mb) {
 }
 
 static void macro_block_yrd(MACROBLOCK *mb, int *Rate, int *Distortion) {
-  int b;
   MACROBLOCKD *const x = &mb->e_mbd;
   BLOCK *const mb_y2 = mb->block + 24;
   BLOCKD *const x_y2 = x->block + 24;
@@ -491,9 +490,7 @@ static void macro_block_yrd(MACROBLOCK *mb, int *Rate, int *Distortion) {
   mb->short_walsh4x4(mb_y2->src_diff, mb_y2->coeff, 8);
 
   /* Quantization */
-  for (b = 0; b < 16; ++b) {
-    mb->quantize_b(&mb->block[b], &mb->e_mbd.block[b]);
-  }
+  mb->quantize_blocks(&mb->block[0], &mb->e_mbd.block[0], 16);
 
   /* DC predication and Quantization of 2nd Order block */
   mb->quantize_b(mb_y2, x_y2);
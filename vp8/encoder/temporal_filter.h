@@ -16,9 +16,17 @@ extern "C" {
 #endif
 
 struct VP8_COMP;
+struct macroblock;
 
 void vp8_temporal_filter_prepare_c(struct VP8_COMP *cpi, int distance);
 
+#if CONFIG_MULTITHREAD
+/* Filters the macroblock rows of an encoding thread, thread 0 being the main
+ * thread. */
+void vp8_temporal_filter_mb_rows(struct VP8_COMP *cpi, struct macroblock *x,
+                                 int ithread);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
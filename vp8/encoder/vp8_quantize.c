@@ -9,6 +9,7 @@
  */
 
 #include <math.h>
+#include "./vp8_rtcd.h"
 #include "vpx_mem/vpx_mem.h"
 
 #include "onyx_int.h"
@@ -93,30 +94,45 @@ void vp8_regular_quantize_b_c(BLOCK *b, BLOCKD *d) {
   *d->eob = (char)(eob + 1);
 }
 
-void vp8_quantize_mby(MACROBLOCK *x) {
+void vp8_fast_quantize_blocks_c(BLOCK *b, BLOCKD *d, int count) {
+  int i;
+
+  for (i = 0; i < count; ++i) vp8_fast_quantize_b_c(&b[i], &d[i]);
+}
+
+void vp8_regular_quantize_blocks(BLOCK *b, BLOCKD *d, int count) {
   int i;
+
+  /* The zero run boost makes each coefficient depend on the previous ones,
+   * there is nothing to share between the blocks.
+   */
+  for (i = 0; i < count; ++i) vp8_regular_quantize_b(&b[i], &d[i]);
+}
+
+/* The luma and the chroma blocks are quantized in one call per plane, the
+ * blocks of a plane share their quantizer.
+ */
+void vp8_quantize_mby(MACROBLOCK *x) {
   int has_2nd_order = (x->e_mbd.mode_info_context->mbmi.mode != B_PRED &&
                        x->e_mbd.mode_info_context->mbmi.mode != SPLITMV);
 
-  for (i = 0; i < 16; ++i) x->quantize_b(&x->block[i], &x->e_mbd.block[i]);
+  x->quantize_blocks(&x->block[0], &x->e_mbd.block[0], 16);
 
   if (has_2nd_order) x->quantize_b(&x->block[24], &x->e_mbd.block[24]);
 }
 
 void vp8_quantize_mb(MACROBLOCK *x) {
-  int i;
   int has_2nd_order = (x->e_mbd.mode_info_context->mbmi.mode != B_PRED &&
                        x->e_mbd.mode_info_context->mbmi.mode != SPLITMV);
 
-  for (i = 0; i < 24 + has_2nd_order; ++i) {
-    x->quantize_b(&x->block[i], &x->e_mbd.block[i]);
-  }
+  x->quantize_blocks(&x->block[0], &x->e_mbd.block[0], 16);
+  x->quantize_blocks(&x->block[16], &x->e_mbd.block[16], 8);
+
+  if (has_2nd_order) x->quantize_b(&x->block[24], &x->e_mbd.block[24]);
 }
 
 void vp8_quantize_mbuv(MACROBLOCK *x) {
-  int i;
-
-  for (i = 16; i < 24; ++i) x->quantize_b(&x->block[i], &x->e_mbd.block[i]);
+  x->quantize_blocks(&x->block[16], &x->e_mbd.block[16], 8);
 }
 
 static const int qrounding_factors[129] = {
@@ -0,0 +1,53 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h> /* SSE2 */
+
+#include "./vp8_rtcd.h"
+#include "./vpx_config.h"
+
+/* Sums the horizontal pairs of the 16 bytes of a and b in 16 bit lanes. */
+static INLINE __m128i sum_pairs(const __m128i a, const __m128i b) {
+  const __m128i even = _mm_set1_epi16(0xff);
+  const __m128i sa =
+      _mm_add_epi16(_mm_and_si128(a, even), _mm_srli_epi16(a, 8));
+  const __m128i sb =
+      _mm_add_epi16(_mm_and_si128(b, even), _mm_srli_epi16(b, 8));
+  return _mm_add_epi16(sa, sb);
+}
+
+void vp8_mr_downscale_2to1_sse2(const unsigned char *src, int src_stride,
+                                unsigned char *dst, int dst_stride, int width,
+                                int height) {
+  const __m128i two = _mm_set1_epi16(2);
+  int r, c;
+
+  for (r = 0; r < height; ++r) {
+    const unsigned char *const s0 = src + 2 * r * src_stride;
+    const unsigned char *const s1 = s0 + src_stride;
+
+    for (c = 0; c + 16 <= width; c += 16) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *)(s0 + 2 * c));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *)(s0 + 2 * c + 16));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *)(s1 + 2 * c));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *)(s1 + 2 * c + 16));
+      const __m128i lo =
+          _mm_srli_epi16(_mm_add_epi16(sum_pairs(a0, b0), two), 2);
+      const __m128i hi =
+          _mm_srli_epi16(_mm_add_epi16(sum_pairs(a1, b1), two), 2);
+      _mm_storeu_si128((__m128i *)(dst + c), _mm_packus_epi16(lo, hi));
+    }
+
+    for (; c < width; ++c) {
+      dst[c] = (s0[2 * c] + s0[2 * c + 1] + s1[2 * c] + s1[2 * c + 1] + 2) >> 2;
+    }
+    dst += dst_stride;
+  }
+}
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2021 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h> /* AVX2 */
+
+#include "./vp8_rtcd.h"
+#include "vp8/encoder/block.h"
+#include "vpx_ports/bitops.h" /* get_msb */
+
+static INLINE void fast_quantize_b(const short *coeff, const __m256i round,
+                                   const __m256i quant_fast,
+                                   const __m256i dequant, short *qcoeff,
+                                   short *dqcoeff, char *eob) {
+  int mask;
+
+  /* The whole 4x4 block fits in one register. */
+  const __m256i z = _mm256_loadu_si256((const __m256i *)(coeff));
+
+  DECLARE_ALIGNED(16, static const uint8_t,
+                  zig_zag_mask[16]) = { 0, 1,  4,  8,  5, 2,  3,  6,
+                                        9, 12, 13, 10, 7, 11, 14, 15 };
+
+  /* sign of z: z >> 15 */
+  const __m256i sz = _mm256_srai_epi16(z, 15);
+  __m256i x, y, nz;
+  __m128i nz8;
+
+  /* y = ((abs(z) + round) * quant) >> 16 */
+  x = _mm256_add_epi16(_mm256_abs_epi16(z), round);
+  y = _mm256_mulhi_epi16(x, quant_fast);
+
+  /* qcoeff = y with the sign of z restored */
+  x = _mm256_sub_epi16(_mm256_xor_si256(y, sz), sz);
+  _mm256_storeu_si256((__m256i *)(qcoeff), x);
+
+  /* dqcoeff = qcoeff * dequant */
+  _mm256_storeu_si256((__m256i *)(dqcoeff), _mm256_mullo_epi16(x, dequant));
+
+  /* Pack the non zero flags of both lanes into 16 bytes in raster order. */
+  nz = _mm256_cmpgt_epi16(y, _mm256_setzero_si256());
+  nz = _mm256_permute4x64_epi64(_mm256_packs_epi16(nz, nz), 0x08);
+  nz8 = _mm_shuffle_epi8(_mm256_castsi256_si128(nz),
+                         _mm_load_si128((const __m128i *)zig_zag_mask));
+
+  mask = _mm_movemask_epi8(nz8);
+
+  /* x2 is needed to increase the result from non-zero masks by 1,
+   * +1 is needed to mask undefined behavior for a null argument,
+   * the result of get_msb(1) is 0 */
+  *eob = get_msb(mask * 2 + 1);
+}
+
+void vp8_fast_quantize_b_avx2(BLOCK *b, BLOCKD *d) {
+  vp8_fast_quantize_blocks_avx2(b, d, 1);
+}
+
+/* The blocks of a plane share the quantizer of the first one, it is loaded
+ * once for the whole plane.
+ */
+void vp8_fast_quantize_blocks_avx2(BLOCK *b, BLOCKD *d, int count) {
+  const __m256i round = _mm256_loadu_si256((const __m256i *)(b->round));
+  const __m256i quant_fast =
+      _mm256_loadu_si256((const __m256i *)(b->quant_fast));
+  const __m256i dequant = _mm256_loadu_si256((const __m256i *)(d->dequant));
+  int i;
+
+  for (i = 0; i < count; ++i) {
+    fast_quantize_b(b[i].coeff, round, quant_fast, dequant, d[i].qcoeff,
+                    d[i].dqcoeff, d[i].eob);
+  }
+}
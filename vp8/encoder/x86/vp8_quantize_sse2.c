@@ -139,15 +139,18 @@ void vp8_regular_quantize_b_sse2(BLOCK *b, BLOCKD *d) {
   *d->eob = eob;
 }
 
-void vp8_fast_quantize_b_sse2(BLOCK *b, BLOCKD *d) {
-  __m128i z0 = _mm_load_si128((__m128i *)(b->coeff));
-  __m128i z1 = _mm_load_si128((__m128i *)(b->coeff + 8));
-  __m128i round0 = _mm_load_si128((__m128i *)(b->round));
-  __m128i round1 = _mm_load_si128((__m128i *)(b->round + 8));
-  __m128i quant_fast0 = _mm_load_si128((__m128i *)(b->quant_fast));
-  __m128i quant_fast1 = _mm_load_si128((__m128i *)(b->quant_fast + 8));
-  __m128i dequant0 = _mm_load_si128((__m128i *)(d->dequant));
-  __m128i dequant1 = _mm_load_si128((__m128i *)(d->dequant + 8));
+/* The quantizer registers are loaded once by the callers, all the blocks of a
+ * plane share them.
+ */
+static INLINE void fast_quantize_b(const short *coeff, const __m128i round0,
+                                   const __m128i round1,
+                                   const __m128i quant_fast0,
+                                   const __m128i quant_fast1,
+                                   const __m128i dequant0,
+                                   const __m128i dequant1, short *qcoeff,
+                                   short *dqcoeff, char *eob) {
+  __m128i z0 = _mm_load_si128((const __m128i *)(coeff));
+  __m128i z1 = _mm_load_si128((const __m128i *)(coeff + 8));
   __m128i inv_zig_zag0 =
       _mm_load_si128((const __m128i *)(vp8_default_inv_zig_zag));
   __m128i inv_zig_zag1 =
@@ -180,16 +183,16 @@ void vp8_fast_quantize_b_sse2(BLOCK *b, BLOCKD *d) {
   x1 = _mm_sub_epi16(y1, sz1);
 
   /* qcoeff = x */
-  _mm_store_si128((__m128i *)(d->qcoeff), x0);
-  _mm_store_si128((__m128i *)(d->qcoeff + 8), x1);
+  _mm_store_si128((__m128i *)(qcoeff), x0);
+  _mm_store_si128((__m128i *)(qcoeff + 8), x1);
 
   /* x * dequant */
   xdq0 = _mm_mullo_epi16(x0, dequant0);
   xdq1 = _mm_mullo_epi16(x1, dequant1);
 
   /* dqcoeff = x * dequant */
-  _mm_store_si128((__m128i *)(d->dqcoeff), xdq0);
-  _mm_store_si128((__m128i *)(d->dqcoeff + 8), xdq1);
+  _mm_store_si128((__m128i *)(dqcoeff), xdq0);
+  _mm_store_si128((__m128i *)(dqcoeff + 8), xdq1);
 
   /* build a mask for the zig zag */
   zeros = _mm_setzero_si128();
@@ -222,5 +225,24 @@ void vp8_fast_quantize_b_sse2(BLOCK *b, BLOCKD *d) {
 
   x0 = _mm_max_epi16(x0, x1);
 
-  *d->eob = 0xFF & _mm_cvtsi128_si32(x0);
+  *eob = 0xFF & _mm_cvtsi128_si32(x0);
+}
+
+void vp8_fast_quantize_b_sse2(BLOCK *b, BLOCKD *d) {
+  vp8_fast_quantize_blocks_sse2(b, d, 1);
+}
+
+void vp8_fast_quantize_blocks_sse2(BLOCK *b, BLOCKD *d, int count) {
+  const __m128i round0 = _mm_load_si128((__m128i *)(b->round));
+  const __m128i round1 = _mm_load_si128((__m128i *)(b->round + 8));
+  const __m128i quant_fast0 = _mm_load_si128((__m128i *)(b->quant_fast));
+  const __m128i quant_fast1 = _mm_load_si128((__m128i *)(b->quant_fast + 8));
+  const __m128i dequant0 = _mm_load_si128((__m128i *)(d->dequant));
+  const __m128i dequant1 = _mm_load_si128((__m128i *)(d->dequant + 8));
+  int i;
+
+  for (i = 0; i < count; ++i) {
+    fast_quantize_b(b[i].coeff, round0, round1, quant_fast0, quant_fast1,
+                    dequant0, dequant1, d[i].qcoeff, d[i].dqcoeff, d[i].eob);
+  }
 }
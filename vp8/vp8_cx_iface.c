@@ -24,6 +24,10 @@
 #include "vp8/encoder/firstpass.h"
 #include "vp8/common/onyx.h"
 #include "vp8/common/common.h"
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+#include "vp8/encoder/mr_dissim.h"
+#include "vp8/encoder/mr_scale.h"
+#endif
 #include <stdlib.h>
 #include <string.h>
 
@@ -72,6 +76,33 @@ static struct vp8_extracfg default_extracfg = {
   0,  /* screen_content_mode */
 };
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+/* A resolution of a VPX_CODEC_USE_MR_PIPELINE encoder. vpx_codec_encode()
+ * queues the lower resolutions, the highest one scales their sources and runs
+ * them, on their own threads when there are cores for them.
+ */
+struct vp8e_mr_pipeline {
+  /* The next lower resolution, NULL for the lowest. */
+  struct vpx_codec_alg_priv *low_res;
+  /* The source, scaled from that of the next higher resolution. */
+  vpx_image_t *scaled;
+
+  /* The queued vp8e_encode() call and its result. */
+  const vpx_image_t *img;
+  vpx_codec_pts_t pts;
+  unsigned long duration;
+  vpx_enc_frame_flags_t flags;
+  unsigned long deadline;
+  vpx_codec_err_t res;
+
+  int has_thread;
+  int quit;
+  pthread_t thread;
+  sem_t start;
+  sem_t done;
+};
+#endif
+
 struct vpx_codec_alg_priv {
   vpx_codec_priv_t base;
   vpx_codec_enc_cfg_t cfg;
@@ -90,6 +121,9 @@ struct vpx_codec_alg_priv {
   vpx_codec_pkt_list_decl(64) pkt_list;
   unsigned int fixed_kf_cntr;
   vpx_enc_frame_flags_t control_frame_flags;
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  struct vp8e_mr_pipeline mr;
+#endif
 };
 
 static vpx_codec_err_t update_error_state(
@@ -656,6 +690,78 @@ static vpx_codec_err_t vp8e_mr_alloc_mem(const vpx_codec_enc_cfg_t *cfg,
   return res;
 }
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+static vpx_codec_err_t encode_frame(vpx_codec_alg_priv_t *ctx,
+                                    const vpx_image_t *img, vpx_codec_pts_t pts,
+                                    unsigned long duration,
+                                    vpx_enc_frame_flags_t enc_flags,
+                                    unsigned long deadline);
+
+static vpx_codec_err_t mr_encode(vpx_codec_alg_priv_t *ctx) {
+  struct vp8e_mr_pipeline *const mr = &ctx->mr;
+
+  mr->res = encode_frame(ctx, mr->img, mr->pts, mr->duration, mr->flags,
+                         mr->deadline);
+  vp8_mr_finish_frame(ctx->cpi);
+  return mr->res;
+}
+
+static THREAD_FUNCTION mr_thread_proc(void *p_data) {
+  vpx_codec_alg_priv_t *const ctx = (vpx_codec_alg_priv_t *)p_data;
+
+  while (1) {
+    if (sem_wait(&ctx->mr.start) == 0) {
+      /* we're shutting down */
+      if (ctx->mr.quit) break;
+
+      mr_encode(ctx);
+
+      sem_post(&ctx->mr.done);
+    }
+  }
+
+  return 0;
+}
+
+static vpx_codec_err_t mr_pipeline_init(vpx_codec_alg_priv_t *ctx) {
+  struct vp8e_mr_pipeline *const mr = &ctx->mr;
+
+  if (ctx->oxcf.mr_total_resolutions == 0)
+    ERROR("VPX_CODEC_USE_MR_PIPELINE needs vpx_codec_enc_init_multi()");
+
+  /* The highest resolution is coded in the caller's thread. Without a thread
+   * a resolution is coded in order before the next higher one.
+   */
+  if (ctx->oxcf.mr_encoder_id < ctx->oxcf.mr_total_resolutions - 1 &&
+      ctx->cpi->common.processor_core_count > 1) {
+    sem_init(&mr->start, 0, 0);
+    sem_init(&mr->done, 0, 0);
+
+    if (pthread_create(&mr->thread, 0, mr_thread_proc, ctx) == 0) {
+      mr->has_thread = 1;
+    } else {
+      sem_destroy(&mr->start);
+      sem_destroy(&mr->done);
+    }
+  }
+
+  return VPX_CODEC_OK;
+}
+
+static void mr_pipeline_destroy(vpx_codec_alg_priv_t *ctx) {
+  struct vp8e_mr_pipeline *const mr = &ctx->mr;
+
+  if (mr->has_thread) {
+    mr->quit = 1;
+    sem_post(&mr->start);
+    pthread_join(mr->thread, 0);
+    sem_destroy(&mr->start);
+    sem_destroy(&mr->done);
+  }
+  vpx_img_free(mr->scaled);
+}
+#endif  // CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+
 static vpx_codec_err_t vp8e_init(vpx_codec_ctx_t *ctx,
                                  vpx_codec_priv_enc_mr_cfg_t *mr_cfg) {
   vpx_codec_err_t res = VPX_CODEC_OK;
@@ -717,12 +823,21 @@ static vpx_codec_err_t vp8e_init(vpx_codec_ctx_t *ctx,
       priv->cpi = vp8_create_compressor(&priv->oxcf);
       if (!priv->cpi) res = VPX_CODEC_MEM_ERROR;
     }
+
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+    if (!res && (ctx->init_flags & VPX_CODEC_USE_MR_PIPELINE))
+      res = mr_pipeline_init(priv);
+#endif
   }
 
   return res;
 }
 
 static vpx_codec_err_t vp8e_destroy(vpx_codec_alg_priv_t *ctx) {
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  mr_pipeline_destroy(ctx);
+#endif
+
 #if CONFIG_MULTI_RES_ENCODING
   /* Free multi-encoder shared memory */
   if (ctx->oxcf.mr_total_resolutions > 0 &&
@@ -855,11 +970,11 @@ static vpx_codec_err_t set_reference_and_update(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
-static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t *ctx,
-                                   const vpx_image_t *img, vpx_codec_pts_t pts,
-                                   unsigned long duration,
-                                   vpx_enc_frame_flags_t enc_flags,
-                                   unsigned long deadline) {
+static vpx_codec_err_t encode_frame(vpx_codec_alg_priv_t *ctx,
+                                    const vpx_image_t *img, vpx_codec_pts_t pts,
+                                    unsigned long duration,
+                                    vpx_enc_frame_flags_t enc_flags,
+                                    unsigned long deadline) {
   volatile vpx_codec_err_t res = VPX_CODEC_OK;
   // Make a copy as volatile to avoid -Wclobbered with longjmp.
   volatile vpx_enc_frame_flags_t flags = enc_flags;
@@ -872,6 +987,10 @@ static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t *ctx,
       LOWER_RES_FRAME_INFO *low_res_frame_info =
           (LOWER_RES_FRAME_INFO *)ctx->cpi->oxcf.mr_low_res_mode_info;
       if (!low_res_frame_info) return VPX_CODEC_ERROR;
+#if CONFIG_MULTITHREAD
+      /* The lower resolution clears the flag when it is coded. */
+      vp8_mr_wait_for_low_res_frame(ctx->cpi);
+#endif
       low_res_frame_info->skip_encoding_prev_stream = 1;
       if (ctx->cpi->oxcf.mr_encoder_id == 0)
         low_res_frame_info->skip_encoding_base_stream = 1;
@@ -1064,6 +1183,123 @@ static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t *ctx,
   return res;
 }
 
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+static vpx_codec_err_t mr_pipeline_encode(vpx_codec_alg_priv_t *ctx,
+                                          const vpx_image_t *img,
+                                          vpx_codec_pts_t pts,
+                                          unsigned long duration,
+                                          vpx_enc_frame_flags_t flags,
+                                          unsigned long deadline) {
+  LOWER_RES_FRAME_INFO *const shared =
+      (LOWER_RES_FRAME_INFO *)ctx->oxcf.mr_low_res_mode_info;
+  struct vp8e_mr_pipeline *const mr = &ctx->mr;
+  /* All the resolutions, from the highest to the lowest. */
+  vpx_codec_alg_priv_t *layer[16];
+  vpx_codec_alg_priv_t *low_res;
+  vpx_codec_err_t res;
+  int num_layers = 0;
+  int i;
+
+  mr->img = img;
+  mr->pts = pts;
+  mr->duration = duration;
+  mr->flags = flags;
+  mr->deadline = deadline;
+  mr->res = VPX_CODEC_OK;
+
+  /* vpx_codec_encode() calls the lowest resolution first, the highest one
+   * codes them all.
+   */
+  mr->low_res = (vpx_codec_alg_priv_t *)shared->mr_pending;
+  if (ctx->oxcf.mr_encoder_id < ctx->oxcf.mr_total_resolutions - 1) {
+    shared->mr_pending = ctx;
+    return VPX_CODEC_OK;
+  }
+  shared->mr_pending = NULL;
+
+  layer[num_layers++] = ctx;
+  for (low_res = mr->low_res; low_res && num_layers < 16;
+       low_res = low_res->mr.low_res)
+    layer[num_layers++] = low_res;
+  if (num_layers != (int)ctx->oxcf.mr_total_resolutions)
+    ERROR("Resolutions missing from the multi-resolution encode");
+
+  if (img) {
+    const vpx_image_t *src = img;
+
+    if ((res = validate_img(ctx, img))) return res;
+    if (img->fmt != VPX_IMG_FMT_I420 && img->fmt != VPX_IMG_FMT_YV12)
+      ERROR("VPX_CODEC_USE_MR_PIPELINE needs I420 or YV12 images");
+
+    /* Each resolution is scaled from the next higher one. */
+    for (i = 1; i < num_layers; ++i) {
+      struct vp8e_mr_pipeline *const low_res_mr = &layer[i]->mr;
+      YV12_BUFFER_CONFIG src_yv12;
+      YV12_BUFFER_CONFIG dst_yv12;
+
+      if (low_res_mr->scaled &&
+          (low_res_mr->scaled->d_w != layer[i]->cfg.g_w ||
+           low_res_mr->scaled->d_h != layer[i]->cfg.g_h)) {
+        vpx_img_free(low_res_mr->scaled);
+        low_res_mr->scaled = NULL;
+      }
+      if (!low_res_mr->scaled) {
+        low_res_mr->scaled = vpx_img_alloc(NULL, VPX_IMG_FMT_I420,
+                                           layer[i]->cfg.g_w,
+                                           layer[i]->cfg.g_h, 16);
+        if (!low_res_mr->scaled) return VPX_CODEC_MEM_ERROR;
+      }
+
+      image2yuvconfig(src, &src_yv12);
+      image2yuvconfig(low_res_mr->scaled, &dst_yv12);
+      vp8_mr_scale_frame(&src_yv12, &dst_yv12);
+      low_res_mr->img = low_res_mr->scaled;
+      src = low_res_mr->scaled;
+    }
+  }
+
+  for (i = num_layers - 1; i >= 0; --i) {
+    if (vp8_mr_start_frame(layer[i]->cpi,
+                           i + 1 < num_layers ? layer[i + 1]->cpi : NULL))
+      ERROR("Resolutions do not match the down-sampling factors");
+  }
+
+  /* A resolution coded without a thread only waits on the lower ones, which
+   * are either running or done.
+   */
+  for (i = num_layers - 1; i > 0; --i) {
+    if (layer[i]->mr.has_thread) sem_post(&layer[i]->mr.start);
+  }
+  for (i = num_layers - 1; i > 0; --i) {
+    if (!layer[i]->mr.has_thread) mr_encode(layer[i]);
+  }
+
+  res = mr_encode(ctx);
+
+  for (i = 1; i < num_layers; ++i) {
+    if (layer[i]->mr.has_thread) sem_wait(&layer[i]->mr.done);
+    if (!res && layer[i]->mr.res) {
+      res = layer[i]->mr.res;
+      ctx->base.err_detail = layer[i]->base.err_detail;
+    }
+  }
+
+  return res;
+}
+#endif  // CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+
+static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t *ctx,
+                                   const vpx_image_t *img, vpx_codec_pts_t pts,
+                                   unsigned long duration,
+                                   vpx_enc_frame_flags_t enc_flags,
+                                   unsigned long deadline) {
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  if (ctx->base.init_flags & VPX_CODEC_USE_MR_PIPELINE)
+    return mr_pipeline_encode(ctx, img, pts, duration, enc_flags, deadline);
+#endif
+  return encode_frame(ctx, img, pts, duration, enc_flags, deadline);
+}
+
 static const vpx_codec_cx_pkt_t *vp8e_get_cxdata(vpx_codec_alg_priv_t *ctx,
                                                  vpx_codec_iter_t *iter) {
   return vpx_codec_pkt_list_get(&ctx->pkt_list.head, iter);
@@ -1353,7 +1589,11 @@ static vpx_codec_enc_cfg_map_t vp8e_usage_cfg_map[] = {
 CODEC_INTERFACE(vpx_codec_vp8_cx) = {
   "WebM Project VP8 Encoder" VERSION_STRING,
   VPX_CODEC_INTERNAL_ABI_VERSION,
-  VPX_CODEC_CAP_ENCODER | VPX_CODEC_CAP_PSNR | VPX_CODEC_CAP_OUTPUT_PARTITION,
+#if CONFIG_MULTI_RES_ENCODING && CONFIG_MULTITHREAD
+  VPX_CODEC_CAP_MR_PIPELINE |
+#endif
+      VPX_CODEC_CAP_ENCODER | VPX_CODEC_CAP_PSNR |
+      VPX_CODEC_CAP_OUTPUT_PARTITION,
   /* vpx_codec_caps_t          caps; */
   vp8e_init,     /* vpx_codec_init_fn_t       init; */
   vp8e_destroy,  /* vpx_codec_destroy_fn_t    destroy; */
@@ -55,6 +55,7 @@ struct vpx_codec_alg_priv {
   vp8_postproc_cfg_t postproc_cfg;
   vpx_decrypt_cb decrypt_cb;
   void *decrypt_state;
+  int row_ec;
   vpx_image_t img;
   int img_setup;
   struct frame_buffers yv12_frame_buffers;
@@ -353,11 +354,12 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t *ctx,
   }
 
   /* Set these even if already initialized.  The caller may have changed the
-   * decrypt config between frames.
+   * decrypt config or the concealment mode between frames.
    */
   if (ctx->decoder_init) {
     ctx->yv12_frame_buffers.pbi[0]->decrypt_cb = ctx->decrypt_cb;
     ctx->yv12_frame_buffers.pbi[0]->decrypt_state = ctx->decrypt_state;
+    ctx->yv12_frame_buffers.pbi[0]->row_ec = ctx->row_ec;
   }
 
   if (!res) {
@@ -689,6 +691,12 @@ static vpx_codec_err_t vp8_set_decryptor(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t vp8_set_row_ec(vpx_codec_alg_priv_t *ctx,
+                                      va_list args) {
+  ctx->row_ec = va_arg(args, int) ? 1 : 0;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_ctrl_fn_map_t vp8_ctf_maps[] = {
   { VP8_SET_REFERENCE, vp8_set_reference },
   { VP8_COPY_REFERENCE, vp8_get_reference },
@@ -698,6 +706,7 @@ static vpx_codec_ctrl_fn_map_t vp8_ctf_maps[] = {
   { VP8D_GET_LAST_REF_USED, vp8_get_last_ref_frame },
   { VPXD_GET_LAST_QUANTIZER, vp8_get_quantizer },
   { VPXD_SET_DECRYPTOR, vp8_set_decryptor },
+  { VP8D_SET_ROW_EC, vp8_set_row_ec },
   { -1, NULL },
 };
 
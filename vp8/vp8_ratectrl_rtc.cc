@@ -51,47 +51,37 @@ static int rescale(int val, int num, int denom) {
   return (int)(llval * llnum / llden);
 }
 
-std::unique_ptr<VP8RateControlRTC> VP8RateControlRTC::Create(
-    const VP8RateControlRtcConfig &cfg) {
-  std::unique_ptr<VP8RateControlRTC> rc_api(new (std::nothrow)
-                                                VP8RateControlRTC());
-  if (!rc_api) return nullptr;
-  rc_api->cpi_ = static_cast<VP8_COMP *>(vpx_memalign(32, sizeof(*cpi_)));
-  if (!rc_api->cpi_) return nullptr;
-  vp8_zero(*rc_api->cpi_);
-
-  rc_api->InitRateControl(cfg);
+static void UpdateRateControlConfig(VP8_COMP *cpi,
+                                    const VP8RateControlRtcConfig &rc_cfg);
 
-  return rc_api;
-}
-
-void VP8RateControlRTC::InitRateControl(const VP8RateControlRtcConfig &rc_cfg) {
-  VP8_COMMON *cm = &cpi_->common;
-  VP8_CONFIG *oxcf = &cpi_->oxcf;
+static void InitRateControlState(VP8_COMP *cpi,
+                                 const VP8RateControlRtcConfig &rc_cfg) {
+  VP8_COMMON *cm = &cpi->common;
+  VP8_CONFIG *oxcf = &cpi->oxcf;
   oxcf->end_usage = USAGE_STREAM_FROM_SERVER;
-  cpi_->pass = 0;
+  cpi->pass = 0;
   cm->show_frame = 1;
   oxcf->drop_frames_water_mark = 0;
   cm->current_video_frame = 0;
-  cpi_->auto_gold = 1;
-  cpi_->key_frame_count = 1;
-  cpi_->rate_correction_factor = 1.0;
-  cpi_->key_frame_rate_correction_factor = 1.0;
-  cpi_->cyclic_refresh_mode_enabled = 0;
-  cpi_->auto_worst_q = 1;
-  cpi_->kf_overspend_bits = 0;
-  cpi_->kf_bitrate_adjustment = 0;
-  cpi_->gf_overspend_bits = 0;
-  cpi_->non_gf_bitrate_adjustment = 0;
-  UpdateRateControl(rc_cfg);
-  cpi_->buffer_level = oxcf->starting_buffer_level;
-  cpi_->bits_off_target = oxcf->starting_buffer_level;
+  cpi->auto_gold = 1;
+  cpi->key_frame_count = 1;
+  cpi->rate_correction_factor = 1.0;
+  cpi->key_frame_rate_correction_factor = 1.0;
+  cpi->cyclic_refresh_mode_enabled = 0;
+  cpi->auto_worst_q = 1;
+  cpi->kf_overspend_bits = 0;
+  cpi->kf_bitrate_adjustment = 0;
+  cpi->gf_overspend_bits = 0;
+  cpi->non_gf_bitrate_adjustment = 0;
+  UpdateRateControlConfig(cpi, rc_cfg);
+  cpi->buffer_level = oxcf->starting_buffer_level;
+  cpi->bits_off_target = oxcf->starting_buffer_level;
 }
 
-void VP8RateControlRTC::UpdateRateControl(
-    const VP8RateControlRtcConfig &rc_cfg) {
-  VP8_COMMON *cm = &cpi_->common;
-  VP8_CONFIG *oxcf = &cpi_->oxcf;
+static void UpdateRateControlConfig(VP8_COMP *cpi,
+                                    const VP8RateControlRtcConfig &rc_cfg) {
+  VP8_COMMON *cm = &cpi->common;
+  VP8_CONFIG *oxcf = &cpi->oxcf;
   vpx_clear_system_state();
   cm->Width = rc_cfg.width;
   cm->Height = rc_cfg.height;
@@ -99,12 +89,12 @@ void VP8RateControlRTC::UpdateRateControl(
   oxcf->Height = rc_cfg.height;
   oxcf->worst_allowed_q = kQTrans[rc_cfg.max_quantizer];
   oxcf->best_allowed_q = kQTrans[rc_cfg.min_quantizer];
-  cpi_->worst_quality = oxcf->worst_allowed_q;
-  cpi_->best_quality = oxcf->best_allowed_q;
-  cpi_->output_framerate = rc_cfg.framerate;
+  cpi->worst_quality = oxcf->worst_allowed_q;
+  cpi->best_quality = oxcf->best_allowed_q;
+  cpi->output_framerate = rc_cfg.framerate;
   oxcf->target_bandwidth =
       static_cast<unsigned int>(1000 * rc_cfg.target_bandwidth);
-  cpi_->ref_framerate = cpi_->output_framerate;
+  cpi->ref_framerate = cpi->output_framerate;
   oxcf->fixed_q = -1;
   oxcf->error_resilient_mode = 1;
   oxcf->starting_buffer_level_in_ms = rc_cfg.buf_initial_sz;
@@ -114,14 +104,13 @@ void VP8RateControlRTC::UpdateRateControl(
   oxcf->optimal_buffer_level = rc_cfg.buf_optimal_sz;
   oxcf->maximum_buffer_size = rc_cfg.buf_sz;
   oxcf->number_of_layers = rc_cfg.ts_number_layers;
-  cpi_->buffered_mode = oxcf->optimal_buffer_level > 0;
+  cpi->buffered_mode = oxcf->optimal_buffer_level > 0;
   oxcf->under_shoot_pct = rc_cfg.undershoot_pct;
   oxcf->over_shoot_pct = rc_cfg.overshoot_pct;
-  cpi_->oxcf.rc_max_intra_bitrate_pct = rc_cfg.max_intra_bitrate_pct;
-  cpi_->framerate = rc_cfg.framerate;
+  cpi->oxcf.rc_max_intra_bitrate_pct = rc_cfg.max_intra_bitrate_pct;
+  cpi->framerate = rc_cfg.framerate;
   for (int i = 0; i < KEY_FRAME_CONTEXT; ++i) {
-    cpi_->prior_key_frame_distance[i] =
-        static_cast<int>(cpi_->output_framerate);
+    cpi->prior_key_frame_distance[i] = static_cast<int>(cpi->output_framerate);
   }
 
   if (oxcf->number_of_layers > 1) {
@@ -133,13 +122,13 @@ void VP8RateControlRTC::UpdateRateControl(
 
     double prev_layer_framerate = 0;
     for (unsigned int i = 0; i < oxcf->number_of_layers; ++i) {
-      vp8_init_temporal_layer_context(cpi_, oxcf, i, prev_layer_framerate);
-      prev_layer_framerate = cpi_->output_framerate / oxcf->rate_decimator[i];
+      vp8_init_temporal_layer_context(cpi, oxcf, i, prev_layer_framerate);
+      prev_layer_framerate = cpi->output_framerate / oxcf->rate_decimator[i];
     }
   }
 
-  cpi_->total_actual_bits = 0;
-  cpi_->total_target_vs_actual = 0;
+  cpi->total_actual_bits = 0;
+  cpi->total_target_vs_actual = 0;
 
   cm->mb_rows = cm->Height >> 4;
   cm->mb_cols = cm->Width >> 4;
@@ -162,139 +151,140 @@ void VP8RateControlRTC::UpdateRateControl(
         rescale((int)oxcf->maximum_buffer_size, oxcf->target_bandwidth, 1000);
   }
 
-  if (cpi_->bits_off_target > oxcf->maximum_buffer_size) {
-    cpi_->bits_off_target = oxcf->maximum_buffer_size;
-    cpi_->buffer_level = cpi_->bits_off_target;
+  if (cpi->bits_off_target > oxcf->maximum_buffer_size) {
+    cpi->bits_off_target = oxcf->maximum_buffer_size;
+    cpi->buffer_level = cpi->bits_off_target;
   }
 
-  vp8_new_framerate(cpi_, cpi_->framerate);
+  vp8_new_framerate(cpi, cpi->framerate);
   vpx_clear_system_state();
 }
 
-void VP8RateControlRTC::ComputeQP(const VP8FrameParamsQpRTC &frame_params) {
-  VP8_COMMON *const cm = &cpi_->common;
+// Returns the QP of the frame, the caller sets up the quantizer.
+static int ComputeFrameQP(VP8_COMP *cpi,
+                          const VP8FrameParamsQpRTC &frame_params) {
+  VP8_COMMON *const cm = &cpi->common;
   vpx_clear_system_state();
-  if (cpi_->oxcf.number_of_layers > 1) {
-    cpi_->temporal_layer_id = frame_params.temporal_layer_id;
+  if (cpi->oxcf.number_of_layers > 1) {
+    cpi->temporal_layer_id = frame_params.temporal_layer_id;
     const int layer = frame_params.temporal_layer_id;
-    vp8_update_layer_contexts(cpi_);
+    vp8_update_layer_contexts(cpi);
     /* Restore layer specific context & set frame rate */
-    vp8_restore_layer_context(cpi_, layer);
-    vp8_new_framerate(cpi_, cpi_->layer_context[layer].framerate);
+    vp8_restore_layer_context(cpi, layer);
+    vp8_new_framerate(cpi, cpi->layer_context[layer].framerate);
   }
   cm->frame_type = frame_params.frame_type;
   cm->refresh_golden_frame = (cm->frame_type == KEY_FRAME) ? 1 : 0;
   cm->refresh_alt_ref_frame = (cm->frame_type == KEY_FRAME) ? 1 : 0;
-  if (cm->frame_type == KEY_FRAME && cpi_->common.current_video_frame > 0) {
-    cpi_->common.frame_flags |= FRAMEFLAGS_KEY;
+  if (cm->frame_type == KEY_FRAME && cpi->common.current_video_frame > 0) {
+    cpi->common.frame_flags |= FRAMEFLAGS_KEY;
   }
 
-  vp8_pick_frame_size(cpi_);
+  vp8_pick_frame_size(cpi);
 
-  if (cpi_->buffer_level >= cpi_->oxcf.optimal_buffer_level &&
-      cpi_->buffered_mode) {
+  if (cpi->buffer_level >= cpi->oxcf.optimal_buffer_level &&
+      cpi->buffered_mode) {
     /* Max adjustment is 1/4 */
-    int Adjustment = cpi_->active_worst_quality / 4;
+    int Adjustment = cpi->active_worst_quality / 4;
     if (Adjustment) {
       int buff_lvl_step;
-      if (cpi_->buffer_level < cpi_->oxcf.maximum_buffer_size) {
-        buff_lvl_step = (int)((cpi_->oxcf.maximum_buffer_size -
-                               cpi_->oxcf.optimal_buffer_level) /
+      if (cpi->buffer_level < cpi->oxcf.maximum_buffer_size) {
+        buff_lvl_step = (int)((cpi->oxcf.maximum_buffer_size -
+                               cpi->oxcf.optimal_buffer_level) /
                               Adjustment);
         if (buff_lvl_step) {
           Adjustment =
-              (int)((cpi_->buffer_level - cpi_->oxcf.optimal_buffer_level) /
+              (int)((cpi->buffer_level - cpi->oxcf.optimal_buffer_level) /
                     buff_lvl_step);
         } else {
           Adjustment = 0;
         }
       }
-      cpi_->active_worst_quality -= Adjustment;
-      if (cpi_->active_worst_quality < cpi_->active_best_quality) {
-        cpi_->active_worst_quality = cpi_->active_best_quality;
+      cpi->active_worst_quality -= Adjustment;
+      if (cpi->active_worst_quality < cpi->active_best_quality) {
+        cpi->active_worst_quality = cpi->active_best_quality;
       }
     }
   }
 
-  if (cpi_->ni_frames > 150) {
-    int q = cpi_->active_worst_quality;
+  if (cpi->ni_frames > 150) {
+    int q = cpi->active_worst_quality;
     if (cm->frame_type == KEY_FRAME) {
-      cpi_->active_best_quality = kf_high_motion_minq[q];
+      cpi->active_best_quality = kf_high_motion_minq[q];
     } else {
-      cpi_->active_best_quality = inter_minq[q];
+      cpi->active_best_quality = inter_minq[q];
     }
 
-    if (cpi_->buffer_level >= cpi_->oxcf.maximum_buffer_size) {
-      cpi_->active_best_quality = cpi_->best_quality;
+    if (cpi->buffer_level >= cpi->oxcf.maximum_buffer_size) {
+      cpi->active_best_quality = cpi->best_quality;
 
-    } else if (cpi_->buffer_level > cpi_->oxcf.optimal_buffer_level) {
+    } else if (cpi->buffer_level > cpi->oxcf.optimal_buffer_level) {
       int Fraction =
-          (int)(((cpi_->buffer_level - cpi_->oxcf.optimal_buffer_level) * 128) /
-                (cpi_->oxcf.maximum_buffer_size -
-                 cpi_->oxcf.optimal_buffer_level));
+          (int)(((cpi->buffer_level - cpi->oxcf.optimal_buffer_level) * 128) /
+                (cpi->oxcf.maximum_buffer_size -
+                 cpi->oxcf.optimal_buffer_level));
       int min_qadjustment =
-          ((cpi_->active_best_quality - cpi_->best_quality) * Fraction) / 128;
+          ((cpi->active_best_quality - cpi->best_quality) * Fraction) / 128;
 
-      cpi_->active_best_quality -= min_qadjustment;
+      cpi->active_best_quality -= min_qadjustment;
     }
   }
 
   /* Clip the active best and worst quality values to limits */
-  if (cpi_->active_worst_quality > cpi_->worst_quality) {
-    cpi_->active_worst_quality = cpi_->worst_quality;
+  if (cpi->active_worst_quality > cpi->worst_quality) {
+    cpi->active_worst_quality = cpi->worst_quality;
   }
-  if (cpi_->active_best_quality < cpi_->best_quality) {
-    cpi_->active_best_quality = cpi_->best_quality;
+  if (cpi->active_best_quality < cpi->best_quality) {
+    cpi->active_best_quality = cpi->best_quality;
   }
-  if (cpi_->active_worst_quality < cpi_->active_best_quality) {
-    cpi_->active_worst_quality = cpi_->active_best_quality;
+  if (cpi->active_worst_quality < cpi->active_best_quality) {
+    cpi->active_worst_quality = cpi->active_best_quality;
   }
 
-  q_ = vp8_regulate_q(cpi_, cpi_->this_frame_target);
-  vp8_set_quantizer(cpi_, q_);
+  const int q = vp8_regulate_q(cpi, cpi->this_frame_target);
   vpx_clear_system_state();
+  return q;
 }
 
-int VP8RateControlRTC::GetQP() const { return q_; }
-
-void VP8RateControlRTC::PostEncodeUpdate(uint64_t encoded_frame_size) {
-  VP8_COMMON *const cm = &cpi_->common;
+static void UpdateAfterEncode(VP8_COMP *cpi, int q,
+                              uint64_t encoded_frame_size) {
+  VP8_COMMON *const cm = &cpi->common;
   vpx_clear_system_state();
-  cpi_->total_byte_count += encoded_frame_size;
-  cpi_->projected_frame_size = static_cast<int>(encoded_frame_size << 3);
-  if (cpi_->oxcf.number_of_layers > 1) {
-    for (unsigned int i = cpi_->current_layer + 1;
-         i < cpi_->oxcf.number_of_layers; ++i) {
-      cpi_->layer_context[i].total_byte_count += encoded_frame_size;
+  cpi->total_byte_count += encoded_frame_size;
+  cpi->projected_frame_size = static_cast<int>(encoded_frame_size << 3);
+  if (cpi->oxcf.number_of_layers > 1) {
+    for (unsigned int i = cpi->current_layer + 1;
+         i < cpi->oxcf.number_of_layers; ++i) {
+      cpi->layer_context[i].total_byte_count += encoded_frame_size;
     }
   }
 
-  vp8_update_rate_correction_factors(cpi_, 2);
+  vp8_update_rate_correction_factors(cpi, 2);
 
-  cpi_->last_q[cm->frame_type] = cm->base_qindex;
+  cpi->last_q[cm->frame_type] = cm->base_qindex;
 
   if (cm->frame_type == KEY_FRAME) {
-    vp8_adjust_key_frame_context(cpi_);
+    vp8_adjust_key_frame_context(cpi);
   }
 
   /* Keep a record of ambient average Q. */
   if (cm->frame_type != KEY_FRAME) {
-    cpi_->avg_frame_qindex =
-        (2 + 3 * cpi_->avg_frame_qindex + cm->base_qindex) >> 2;
+    cpi->avg_frame_qindex =
+        (2 + 3 * cpi->avg_frame_qindex + cm->base_qindex) >> 2;
   }
   /* Keep a record from which we can calculate the average Q excluding
    * key frames.
    */
   if (cm->frame_type != KEY_FRAME) {
-    cpi_->ni_frames++;
+    cpi->ni_frames++;
     /* Damp value for first few frames */
-    if (cpi_->ni_frames > 150) {
-      cpi_->ni_tot_qi += q_;
-      cpi_->ni_av_qi = (cpi_->ni_tot_qi / cpi_->ni_frames);
+    if (cpi->ni_frames > 150) {
+      cpi->ni_tot_qi += q;
+      cpi->ni_av_qi = (cpi->ni_tot_qi / cpi->ni_frames);
     } else {
-      cpi_->ni_tot_qi += q_;
-      cpi_->ni_av_qi =
-          ((cpi_->ni_tot_qi / cpi_->ni_frames) + cpi_->worst_quality + 1) / 2;
+      cpi->ni_tot_qi += q;
+      cpi->ni_av_qi =
+          ((cpi->ni_tot_qi / cpi->ni_frames) + cpi->worst_quality + 1) / 2;
     }
 
     /* If the average Q is higher than what was used in the last
@@ -305,25 +295,25 @@ void VP8RateControlRTC::PostEncodeUpdate(uint64_t encoded_frame_size) {
      * the same time reduce the number of itterations around the
      * recode loop.
      */
-    if (q_ > cpi_->ni_av_qi) cpi_->ni_av_qi = q_ - 1;
+    if (q > cpi->ni_av_qi) cpi->ni_av_qi = q - 1;
   }
 
-  cpi_->bits_off_target +=
-      cpi_->av_per_frame_bandwidth - cpi_->projected_frame_size;
-  if (cpi_->bits_off_target > cpi_->oxcf.maximum_buffer_size) {
-    cpi_->bits_off_target = cpi_->oxcf.maximum_buffer_size;
+  cpi->bits_off_target +=
+      cpi->av_per_frame_bandwidth - cpi->projected_frame_size;
+  if (cpi->bits_off_target > cpi->oxcf.maximum_buffer_size) {
+    cpi->bits_off_target = cpi->oxcf.maximum_buffer_size;
   }
 
-  cpi_->total_actual_bits += cpi_->projected_frame_size;
-  cpi_->buffer_level = cpi_->bits_off_target;
+  cpi->total_actual_bits += cpi->projected_frame_size;
+  cpi->buffer_level = cpi->bits_off_target;
 
   /* Propagate values to higher temporal layers */
-  if (cpi_->oxcf.number_of_layers > 1) {
-    for (unsigned int i = cpi_->current_layer + 1;
-         i < cpi_->oxcf.number_of_layers; ++i) {
-      LAYER_CONTEXT *lc = &cpi_->layer_context[i];
+  if (cpi->oxcf.number_of_layers > 1) {
+    for (unsigned int i = cpi->current_layer + 1;
+         i < cpi->oxcf.number_of_layers; ++i) {
+      LAYER_CONTEXT *lc = &cpi->layer_context[i];
       int bits_off_for_this_layer = (int)round(
-          lc->target_bandwidth / lc->framerate - cpi_->projected_frame_size);
+          lc->target_bandwidth / lc->framerate - cpi->projected_frame_size);
 
       lc->bits_off_target += bits_off_for_this_layer;
 
@@ -332,16 +322,276 @@ void VP8RateControlRTC::PostEncodeUpdate(uint64_t encoded_frame_size) {
         lc->bits_off_target = lc->maximum_buffer_size;
       }
 
-      lc->total_actual_bits += cpi_->projected_frame_size;
+      lc->total_actual_bits += cpi->projected_frame_size;
       lc->total_target_vs_actual += bits_off_for_this_layer;
       lc->buffer_level = lc->bits_off_target;
     }
   }
 
-  cpi_->common.current_video_frame++;
-  cpi_->frames_since_key++;
+  cpi->common.current_video_frame++;
+  cpi->frames_since_key++;
 
-  if (cpi_->oxcf.number_of_layers > 1) vp8_save_layer_context(cpi_);
+  if (cpi->oxcf.number_of_layers > 1) vp8_save_layer_context(cpi);
   vpx_clear_system_state();
 }
+
+std::unique_ptr<VP8RateControlRTC> VP8RateControlRTC::Create(
+    const VP8RateControlRtcConfig &cfg) {
+  std::unique_ptr<VP8RateControlRTC> rc_api(new (std::nothrow)
+                                                VP8RateControlRTC());
+  if (!rc_api) return nullptr;
+  rc_api->cpi_ = static_cast<VP8_COMP *>(vpx_memalign(32, sizeof(*cpi_)));
+  if (!rc_api->cpi_) return nullptr;
+  vp8_zero(*rc_api->cpi_);
+
+  rc_api->InitRateControl(cfg);
+
+  return rc_api;
+}
+
+void VP8RateControlRTC::InitRateControl(const VP8RateControlRtcConfig &rc_cfg) {
+  InitRateControlState(cpi_, rc_cfg);
+}
+
+void VP8RateControlRTC::UpdateRateControl(
+    const VP8RateControlRtcConfig &rc_cfg) {
+  UpdateRateControlConfig(cpi_, rc_cfg);
+}
+
+void VP8RateControlRTC::ComputeQP(const VP8FrameParamsQpRTC &frame_params) {
+  q_ = ComputeFrameQP(cpi_, frame_params);
+  vp8_set_quantizer(cpi_, q_);
+}
+
+int VP8RateControlRTC::GetQP() const { return q_; }
+
+void VP8RateControlRTC::PostEncodeUpdate(uint64_t encoded_frame_size) {
+  UpdateAfterEncode(cpi_, q_, encoded_frame_size);
+}
+
+std::unique_ptr<VP8RateControlRtcBatch> VP8RateControlRtcBatch::Create() {
+  std::unique_ptr<VP8RateControlRtcBatch> rc_api(new (std::nothrow)
+                                                     VP8RateControlRtcBatch());
+  if (!rc_api) return nullptr;
+  rc_api->cpi_ = static_cast<VP8_COMP *>(vpx_memalign(32, sizeof(*cpi_)));
+  if (!rc_api->cpi_) return nullptr;
+  vp8_zero(*rc_api->cpi_);
+  return rc_api;
+}
+
+// Everything else the rate control reads from the workspace is set to the
+// same value for all the streams by InitRateControlState() and
+// UpdateRateControlConfig().
+void VP8RateControlRtcBatch::LoadState(
+    const VP8RateControlRtcStreamState &state) {
+  VP8_COMMON *const cm = &cpi_->common;
+  VP8_CONFIG *const oxcf = &cpi_->oxcf;
+
+  oxcf->target_bandwidth = state.target_bandwidth;
+  oxcf->rc_max_intra_bitrate_pct = state.rc_max_intra_bitrate_pct;
+  oxcf->under_shoot_pct = state.under_shoot_pct;
+  oxcf->over_shoot_pct = state.over_shoot_pct;
+  oxcf->starting_buffer_level = state.starting_buffer_level;
+  oxcf->optimal_buffer_level = state.optimal_buffer_level;
+  oxcf->maximum_buffer_size = state.maximum_buffer_size;
+  oxcf->starting_buffer_level_in_ms = state.starting_buffer_level_in_ms;
+  oxcf->optimal_buffer_level_in_ms = state.optimal_buffer_level_in_ms;
+  oxcf->maximum_buffer_size_in_ms = state.maximum_buffer_size_in_ms;
+  oxcf->worst_allowed_q = state.worst_allowed_q;
+  oxcf->best_allowed_q = state.best_allowed_q;
+  oxcf->number_of_layers = state.number_of_layers;
+  memcpy(oxcf->target_bitrate, state.target_bitrate,
+         sizeof(state.target_bitrate));
+  memcpy(oxcf->rate_decimator, state.rate_decimator,
+         sizeof(state.rate_decimator));
+  cm->MBs = state.mbs;
+
+  cpi_->buffer_level = state.buffer_level;
+  cpi_->bits_off_target = state.bits_off_target;
+  cpi_->total_byte_count = state.total_byte_count;
+  cpi_->total_actual_bits = state.total_actual_bits;
+  cpi_->total_target_vs_actual = state.total_target_vs_actual;
+  cpi_->target_bandwidth = state.layer_target_bandwidth;
+  cpi_->worst_quality = state.worst_quality;
+  cpi_->best_quality = state.best_quality;
+  cpi_->active_worst_quality = state.active_worst_quality;
+  cpi_->active_best_quality = state.active_best_quality;
+  cpi_->ni_av_qi = state.ni_av_qi;
+  cpi_->ni_tot_qi = state.ni_tot_qi;
+  cpi_->ni_frames = state.ni_frames;
+  cpi_->avg_frame_qindex = state.avg_frame_qindex;
+  cpi_->last_q[0] = state.last_q[0];
+  cpi_->last_q[1] = state.last_q[1];
+  cpi_->mb.zbin_over_quant = state.zbin_over_quant;
+  cpi_->rate_correction_factor = state.rate_correction_factor;
+  cpi_->key_frame_rate_correction_factor =
+      state.key_frame_rate_correction_factor;
+  cpi_->gf_rate_correction_factor = state.gf_rate_correction_factor;
+
+  cpi_->this_frame_target = state.this_frame_target;
+  cpi_->inter_frame_target = state.inter_frame_target;
+  cpi_->projected_frame_size = state.projected_frame_size;
+  cpi_->per_frame_bandwidth = state.per_frame_bandwidth;
+  cpi_->av_per_frame_bandwidth = state.av_per_frame_bandwidth;
+  cpi_->min_frame_bandwidth = state.min_frame_bandwidth;
+  cpi_->kf_overspend_bits = state.kf_overspend_bits;
+  cpi_->kf_bitrate_adjustment = state.kf_bitrate_adjustment;
+  cpi_->gf_overspend_bits = state.gf_overspend_bits;
+  cpi_->non_gf_bitrate_adjustment = state.non_gf_bitrate_adjustment;
+  cpi_->framerate = state.framerate;
+  cpi_->output_framerate = state.output_framerate;
+  cpi_->ref_framerate = state.ref_framerate;
+  cpi_->buffered_mode = state.buffered_mode;
+
+  cpi_->key_frame_count = state.key_frame_count;
+  cpi_->frames_since_key = state.frames_since_key;
+  memcpy(cpi_->prior_key_frame_distance, state.prior_key_frame_distance,
+         sizeof(state.prior_key_frame_distance));
+  cm->current_video_frame = state.current_video_frame;
+  cm->frame_type = state.frame_type;
+  cm->frame_flags = state.frame_flags;
+  cm->refresh_golden_frame = state.refresh_golden_frame;
+  cm->refresh_alt_ref_frame = state.refresh_alt_ref_frame;
+  cm->base_qindex = state.base_qindex;
+
+  cpi_->current_layer = state.current_layer;
+  cpi_->temporal_layer_id = state.temporal_layer_id;
+  if (!state.layer_context.empty()) {
+    memcpy(cpi_->layer_context, &state.layer_context[0],
+           state.layer_context.size() * sizeof(state.layer_context[0]));
+  }
+}
+
+void VP8RateControlRtcBatch::StoreState(
+    VP8RateControlRtcStreamState *state) const {
+  const VP8_COMMON *const cm = &cpi_->common;
+  const VP8_CONFIG *const oxcf = &cpi_->oxcf;
+
+  state->target_bandwidth = oxcf->target_bandwidth;
+  state->rc_max_intra_bitrate_pct = oxcf->rc_max_intra_bitrate_pct;
+  state->under_shoot_pct = oxcf->under_shoot_pct;
+  state->over_shoot_pct = oxcf->over_shoot_pct;
+  state->starting_buffer_level = oxcf->starting_buffer_level;
+  state->optimal_buffer_level = oxcf->optimal_buffer_level;
+  state->maximum_buffer_size = oxcf->maximum_buffer_size;
+  state->starting_buffer_level_in_ms = oxcf->starting_buffer_level_in_ms;
+  state->optimal_buffer_level_in_ms = oxcf->optimal_buffer_level_in_ms;
+  state->maximum_buffer_size_in_ms = oxcf->maximum_buffer_size_in_ms;
+  state->worst_allowed_q = oxcf->worst_allowed_q;
+  state->best_allowed_q = oxcf->best_allowed_q;
+  state->number_of_layers = oxcf->number_of_layers;
+  memcpy(state->target_bitrate, oxcf->target_bitrate,
+         sizeof(state->target_bitrate));
+  memcpy(state->rate_decimator, oxcf->rate_decimator,
+         sizeof(state->rate_decimator));
+  state->mbs = cm->MBs;
+
+  state->buffer_level = cpi_->buffer_level;
+  state->bits_off_target = cpi_->bits_off_target;
+  state->total_byte_count = cpi_->total_byte_count;
+  state->total_actual_bits = cpi_->total_actual_bits;
+  state->total_target_vs_actual = cpi_->total_target_vs_actual;
+  state->layer_target_bandwidth = cpi_->target_bandwidth;
+  state->worst_quality = cpi_->worst_quality;
+  state->best_quality = cpi_->best_quality;
+  state->active_worst_quality = cpi_->active_worst_quality;
+  state->active_best_quality = cpi_->active_best_quality;
+  state->ni_av_qi = cpi_->ni_av_qi;
+  state->ni_tot_qi = cpi_->ni_tot_qi;
+  state->ni_frames = cpi_->ni_frames;
+  state->avg_frame_qindex = cpi_->avg_frame_qindex;
+  state->last_q[0] = cpi_->last_q[0];
+  state->last_q[1] = cpi_->last_q[1];
+  state->zbin_over_quant = cpi_->mb.zbin_over_quant;
+  state->rate_correction_factor = cpi_->rate_correction_factor;
+  state->key_frame_rate_correction_factor =
+      cpi_->key_frame_rate_correction_factor;
+  state->gf_rate_correction_factor = cpi_->gf_rate_correction_factor;
+
+  state->this_frame_target = cpi_->this_frame_target;
+  state->inter_frame_target = cpi_->inter_frame_target;
+  state->projected_frame_size = cpi_->projected_frame_size;
+  state->per_frame_bandwidth = cpi_->per_frame_bandwidth;
+  state->av_per_frame_bandwidth = cpi_->av_per_frame_bandwidth;
+  state->min_frame_bandwidth = cpi_->min_frame_bandwidth;
+  state->kf_overspend_bits = cpi_->kf_overspend_bits;
+  state->kf_bitrate_adjustment = cpi_->kf_bitrate_adjustment;
+  state->gf_overspend_bits = cpi_->gf_overspend_bits;
+  state->non_gf_bitrate_adjustment = cpi_->non_gf_bitrate_adjustment;
+  state->framerate = cpi_->framerate;
+  state->output_framerate = cpi_->output_framerate;
+  state->ref_framerate = cpi_->ref_framerate;
+  state->buffered_mode = cpi_->buffered_mode;
+
+  state->key_frame_count = cpi_->key_frame_count;
+  state->frames_since_key = cpi_->frames_since_key;
+  memcpy(state->prior_key_frame_distance, cpi_->prior_key_frame_distance,
+         sizeof(state->prior_key_frame_distance));
+  state->current_video_frame = cm->current_video_frame;
+  state->frame_type = cm->frame_type;
+  state->frame_flags = cm->frame_flags;
+  state->refresh_golden_frame = cm->refresh_golden_frame;
+  state->refresh_alt_ref_frame = cm->refresh_alt_ref_frame;
+  state->base_qindex = cm->base_qindex;
+
+  state->current_layer = cpi_->current_layer;
+  state->temporal_layer_id = cpi_->temporal_layer_id;
+  // Only the streams with temporal layers keep their layer contexts.
+  if (oxcf->number_of_layers > 1) {
+    state->layer_context.assign(
+        cpi_->layer_context, cpi_->layer_context + oxcf->number_of_layers);
+  } else {
+    state->layer_context.clear();
+  }
+}
+
+int VP8RateControlRtcBatch::AddStream(const VP8RateControlRtcConfig &rc_cfg) {
+  VP8RateControlRtcStreamState state = VP8RateControlRtcStreamState();
+  LoadState(state);
+  vp8_zero(cpi_->layer_context);
+  InitRateControlState(cpi_, rc_cfg);
+  StoreState(&state);
+  streams_.push_back(state);
+  return num_streams() - 1;
+}
+
+void VP8RateControlRtcBatch::UpdateRateControl(
+    int stream, const VP8RateControlRtcConfig &rc_cfg) {
+  const size_t num_layers = streams_[stream].layer_context.size();
+  LoadState(streams_[stream]);
+  // Layers the stream does not have yet start from a clean context.
+  memset(cpi_->layer_context + num_layers, 0,
+         (VPX_TS_MAX_LAYERS - num_layers) * sizeof(cpi_->layer_context[0]));
+  UpdateRateControlConfig(cpi_, rc_cfg);
+  StoreState(&streams_[stream]);
+}
+
+void VP8RateControlRtcBatch::ComputeQP(int count, const int *streams,
+                                       const FRAME_TYPE *frame_types,
+                                       const int *temporal_layer_ids,
+                                       int *qps) {
+  for (int i = 0; i < count; ++i) {
+    VP8RateControlRtcStreamState *const state = &streams_[streams[i]];
+    VP8FrameParamsQpRTC frame_params;
+    frame_params.frame_type = frame_types[i];
+    frame_params.temporal_layer_id =
+        temporal_layer_ids ? temporal_layer_ids[i] : 0;
+    LoadState(*state);
+    // The quantizer tables of the workspace are not used, only the QP is.
+    state->q = ComputeFrameQP(cpi_, frame_params);
+    cpi_->common.base_qindex = state->q;
+    StoreState(state);
+    qps[i] = state->q;
+  }
+}
+
+void VP8RateControlRtcBatch::PostEncodeUpdate(
+    int count, const int *streams, const uint64_t *encoded_frame_sizes) {
+  for (int i = 0; i < count; ++i) {
+    VP8RateControlRtcStreamState *const state = &streams_[streams[i]];
+    LoadState(*state);
+    UpdateAfterEncode(cpi_, state->q, encoded_frame_sizes[i]);
+    StoreState(state);
+  }
+}
 }  // namespace libvpx
@@ -13,6 +13,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "vp8/encoder/onyx_int.h"
 #include "vp8/common/common.h"
@@ -58,6 +59,121 @@ class VP8RateControlRTC {
   int q_;
 };
 
+// Rate control state of one stream of a VP8RateControlRtcBatch. It holds only
+// what the one pass CBR rate control in vp8/encoder/ratectrl.c carries from
+// one frame to the next, and the layer contexts of streams with temporal
+// layers.
+struct VP8RateControlRtcStreamState {
+  // Configuration
+  unsigned int target_bandwidth;
+  unsigned int rc_max_intra_bitrate_pct;
+  int under_shoot_pct;
+  int over_shoot_pct;
+  int64_t starting_buffer_level;
+  int64_t optimal_buffer_level;
+  int64_t maximum_buffer_size;
+  int64_t starting_buffer_level_in_ms;
+  int64_t optimal_buffer_level_in_ms;
+  int64_t maximum_buffer_size_in_ms;
+  int worst_allowed_q;
+  int best_allowed_q;
+  unsigned int number_of_layers;
+  unsigned int target_bitrate[VPX_TS_MAX_LAYERS];
+  unsigned int rate_decimator[VPX_TS_MAX_LAYERS];
+  int mbs;
+
+  // Buffer and quality state
+  int64_t buffer_level;
+  int64_t bits_off_target;
+  int64_t total_byte_count;
+  int64_t total_actual_bits;
+  int total_target_vs_actual;
+  int layer_target_bandwidth;
+  int worst_quality;
+  int best_quality;
+  int active_worst_quality;
+  int active_best_quality;
+  int ni_av_qi;
+  int ni_tot_qi;
+  int ni_frames;
+  int avg_frame_qindex;
+  int last_q[2];
+  int zbin_over_quant;
+  double rate_correction_factor;
+  double key_frame_rate_correction_factor;
+  double gf_rate_correction_factor;
+
+  // Frame size targets
+  int this_frame_target;
+  int inter_frame_target;
+  int projected_frame_size;
+  int per_frame_bandwidth;
+  int av_per_frame_bandwidth;
+  int min_frame_bandwidth;
+  int kf_overspend_bits;
+  int kf_bitrate_adjustment;
+  int gf_overspend_bits;
+  int non_gf_bitrate_adjustment;
+  double framerate;
+  double output_framerate;
+  double ref_framerate;
+  int buffered_mode;
+
+  // Key frame and current frame
+  int64_t key_frame_count;
+  unsigned int frames_since_key;
+  int prior_key_frame_distance[KEY_FRAME_CONTEXT];
+  unsigned int current_video_frame;
+  FRAME_TYPE frame_type;
+  int frame_flags;
+  int refresh_golden_frame;
+  int refresh_alt_ref_frame;
+  int base_qindex;
+  int q;
+
+  // Temporal layers
+  unsigned int current_layer;
+  int temporal_layer_id;
+  std::vector<LAYER_CONTEXT> layer_context;
+};
+
+// Runs the rate control of many streams, such as the simulcast streams
+// forwarded by a server, on one shared encoder workspace. The state of each
+// stream is loaded into the workspace, updated by the same code as in
+// VP8RateControlRTC and stored back, so every stream gets the QPs a
+// VP8RateControlRTC of its own would give.
+class VP8RateControlRtcBatch {
+ public:
+  static std::unique_ptr<VP8RateControlRtcBatch> Create();
+  ~VP8RateControlRtcBatch() {
+    if (cpi_) {
+      vpx_free(cpi_);
+    }
+  }
+
+  // Adds a stream and returns its index.
+  int AddStream(const VP8RateControlRtcConfig &rc_cfg);
+  void UpdateRateControl(int stream, const VP8RateControlRtcConfig &rc_cfg);
+  int num_streams() const { return static_cast<int>(streams_.size()); }
+
+  // Computes the QP of the next frame of |count| streams. All the arrays have
+  // |count| entries: the index of the stream, the type and temporal layer of
+  // its frame, and the QP returned. |temporal_layer_ids| may be NULL for
+  // streams without temporal layers.
+  void ComputeQP(int count, const int *streams, const FRAME_TYPE *frame_types,
+                 const int *temporal_layer_ids, int *qps);
+  // Feeds back the encoded sizes of the frames of the streams, in bytes.
+  void PostEncodeUpdate(int count, const int *streams,
+                        const uint64_t *encoded_frame_sizes);
+
+ private:
+  VP8RateControlRtcBatch() : cpi_(NULL) {}
+  void LoadState(const VP8RateControlRtcStreamState &state);
+  void StoreState(VP8RateControlRtcStreamState *state) const;
+  VP8_COMP *cpi_;
+  std::vector<VP8RateControlRtcStreamState> streams_;
+};
+
 }  // namespace libvpx
 
 #endif  // VPX_VP8_RATECTRL_RTC_H_
@@ -25,6 +25,7 @@ struct macroblockd;
 struct macroblock;
 struct vp9_variance_vtable;
 struct search_site_config;
+struct nn_config;
 struct mv;
 union int_mv;
 struct yv12_buffer_config;
@@ -177,6 +178,12 @@ if (vpx_config("CONFIG_VP9_HIGHBITDEPTH") ne "yes") {
 add_proto qw/int vp9_diamond_search_sad/, "const struct macroblock *x, const struct search_site_config *cfg,  struct mv *ref_mv, struct mv *best_mv, int search_param, int sad_per_bit, int *num00, const struct vp9_variance_vtable *fn_ptr, const struct mv *center_mv";
 specialize qw/vp9_diamond_search_sad avx neon/;
 
+#
+# Neural net inference
+#
+add_proto qw/void vp9_nn_predict/, "const float *features, const struct nn_config *nn_config, float *output";
+specialize qw/vp9_nn_predict sse2 avx2 neon/;
+
 #
 # Apply temporal filter
 #
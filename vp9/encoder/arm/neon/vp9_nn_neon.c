@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2023 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <arm_neon.h>
+#include <assert.h>
+
+#include "./vp9_rtcd.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vp9/encoder/vp9_nn.h"
+
+// Compilers contract the multiply-add of vp9_nn_predict_c() on AArch64, so use
+// the fused form there to keep the outputs identical.
+static INLINE float32x4_t mul_add(float32x4_t acc, float32x4_t w, float in) {
+#ifdef __aarch64__
+  return vfmaq_n_f32(acc, w, in);
+#else
+  return vaddq_f32(acc, vmulq_n_f32(w, in));
+#endif
+}
+
+// Computes 4 nodes at a time, one per lane. Each lane accumulates its products
+// in the same order as vp9_nn_predict_c().
+static void nn_layer_neon(const float *input, int num_inputs,
+                          const float *weights, const float *bias,
+                          int num_outputs, int relu, float *output) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  int node = 0;
+
+  for (; node + 4 <= num_outputs; node += 4) {
+    const float *const w0 = weights + node * num_inputs;
+    const float *const w1 = w0 + num_inputs;
+    const float *const w2 = w1 + num_inputs;
+    const float *const w3 = w2 + num_inputs;
+    float32x4_t acc = zero;
+    int i = 0;
+
+    for (; i + 4 <= num_inputs; i += 4) {
+      // Transpose so that each register holds the weights of one input.
+      const float32x4x2_t t01 = vtrnq_f32(vld1q_f32(w0 + i), vld1q_f32(w1 + i));
+      const float32x4x2_t t23 = vtrnq_f32(vld1q_f32(w2 + i), vld1q_f32(w3 + i));
+      const float32x4_t c0 =
+          vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+      const float32x4_t c1 =
+          vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+      const float32x4_t c2 =
+          vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+      const float32x4_t c3 =
+          vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+      acc = mul_add(acc, c0, input[i + 0]);
+      acc = mul_add(acc, c1, input[i + 1]);
+      acc = mul_add(acc, c2, input[i + 2]);
+      acc = mul_add(acc, c3, input[i + 3]);
+    }
+    for (; i < num_inputs; ++i) {
+      float32x4_t w = vdupq_n_f32(w0[i]);
+      w = vsetq_lane_f32(w1[i], w, 1);
+      w = vsetq_lane_f32(w2[i], w, 2);
+      w = vsetq_lane_f32(w3[i], w, 3);
+      acc = mul_add(acc, w, input[i]);
+    }
+
+    acc = vaddq_f32(acc, vld1q_f32(bias + node));
+    if (relu) acc = vmaxq_f32(acc, zero);
+    vst1q_f32(output + node, acc);
+  }
+
+  for (; node < num_outputs; ++node) {
+    const float *const w = weights + node * num_inputs;
+    float val = 0.0f;
+    int i;
+    for (i = 0; i < num_inputs; ++i) val += w[i] * input[i];
+    val += bias[node];
+    if (relu) val = VPXMAX(val, 0.0f);
+    output[node] = val;
+  }
+}
+
+void vp9_nn_predict_neon(const float *features, const NN_CONFIG *nn_config,
+                         float *output) {
+  float buf[2][NN_MAX_NODES_PER_LAYER];
+  const float *input_nodes = features;
+  int num_input_nodes = nn_config->num_inputs;
+  const int num_layers = nn_config->num_hidden_layers;
+  int layer;
+  assert(num_layers <= NN_MAX_HIDDEN_LAYERS);
+
+  for (layer = 0; layer < num_layers; ++layer) {
+    const int num_output_nodes = nn_config->num_hidden_nodes[layer];
+    float *const output_nodes = buf[layer & 1];
+    assert(num_output_nodes < NN_MAX_NODES_PER_LAYER);
+    nn_layer_neon(input_nodes, num_input_nodes, nn_config->weights[layer],
+                  nn_config->bias[layer], num_output_nodes, 1, output_nodes);
+    num_input_nodes = num_output_nodes;
+    input_nodes = output_nodes;
+  }
+
+  nn_layer_neon(input_nodes, num_input_nodes, nn_config->weights[num_layers],
+                nn_config->bias[num_layers], nn_config->num_outputs, 0, output);
+}
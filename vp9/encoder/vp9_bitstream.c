@@ -955,7 +955,7 @@ static int encode_tile_worker(void *arg1, void *arg2) {
 void vp9_bitstream_encode_tiles_buffer_dealloc(VP9_COMP *const cpi) {
   if (cpi->vp9_bitstream_worker_data) {
     int i;
-    for (i = 1; i < cpi->num_workers; ++i) {
+    for (i = 1; i < cpi->allocated_workers; ++i) {
       vpx_free(cpi->vp9_bitstream_worker_data[i].dest);
     }
     vpx_free(cpi->vp9_bitstream_worker_data);
@@ -967,11 +967,11 @@ static void encode_tiles_buffer_alloc(VP9_COMP *const cpi) {
   VP9_COMMON *const cm = &cpi->common;
   int i;
   const size_t worker_data_size =
-      cpi->num_workers * sizeof(*cpi->vp9_bitstream_worker_data);
+      cpi->allocated_workers * sizeof(*cpi->vp9_bitstream_worker_data);
   CHECK_MEM_ERROR(cm, cpi->vp9_bitstream_worker_data,
                   vpx_memalign(16, worker_data_size));
   memset(cpi->vp9_bitstream_worker_data, 0, worker_data_size);
-  for (i = 1; i < cpi->num_workers; ++i) {
+  for (i = 1; i < cpi->allocated_workers; ++i) {
     cpi->vp9_bitstream_worker_data[i].dest_size =
         cpi->oxcf.width * cpi->oxcf.height;
     CHECK_MEM_ERROR(cm, cpi->vp9_bitstream_worker_data[i].dest,
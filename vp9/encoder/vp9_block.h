@@ -49,6 +49,14 @@ struct macroblock_plane {
 typedef unsigned int vp9_coeff_cost[PLANE_TYPES][REF_TYPES][COEF_BANDS][2]
                                    [COEFF_CONTEXTS][ENTROPY_TOKENS];
 
+// Full pixel motion search results of the blocks of the current superblock,
+// indexed by reference frame, block size and the position of the top left 8x8
+// block in the superblock.
+typedef struct {
+  uint64_t valid[MAX_REF_FRAMES][BLOCK_SIZES];
+  MV mv[MAX_REF_FRAMES][BLOCK_SIZES][MI_BLOCK_SIZE * MI_BLOCK_SIZE];
+} MV_SEARCH_CACHE;
+
 typedef struct {
   int_mv ref_mvs[MAX_REF_FRAMES][MAX_MV_REF_CANDIDATES];
   uint8_t mode_context[MAX_REF_FRAMES];
@@ -100,6 +108,8 @@ struct macroblock {
   // further in the encoding process.
   BLOCK_SIZE min_partition_size;
   BLOCK_SIZE max_partition_size;
+  // The partition size range of the superblock is set from the ladder info.
+  int use_partition_hint;
 
   int mv_best_ref_index[MAX_REF_FRAMES];
   unsigned int max_mv_context[MAX_REF_FRAMES];
@@ -171,6 +181,8 @@ struct macroblock {
   // Used to store sub partition's choices.
   MV pred_mv[MAX_REF_FRAMES];
 
+  MV_SEARCH_CACHE mv_search_cache;
+
   // Strong color activity detection. Used in RTC coding mode to enhance
   // the visual quality at the boundary of moving color objects.
   uint8_t color_sensitivity[2];
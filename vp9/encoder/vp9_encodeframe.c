@@ -1205,8 +1205,8 @@ static void chroma_check(VP9_COMP *cpi, MACROBLOCK *x, int bsize,
   }
 }
 
-static uint64_t avg_source_sad(VP9_COMP *cpi, MACROBLOCK *x, int shift,
-                               int sb_offset) {
+static uint64_t avg_source_sad(VP9_COMP *cpi, MACROBLOCK *x, int mi_row,
+                               int mi_col, int sb_offset) {
   unsigned int tmp_sse;
   uint64_t tmp_sad;
   unsigned int tmp_variance;
@@ -1220,12 +1220,18 @@ static uint64_t avg_source_sad(VP9_COMP *cpi, MACROBLOCK *x, int shift,
 #if CONFIG_VP9_HIGHBITDEPTH
   if (cpi->common.use_highbitdepth) return 0;
 #endif
-  src_y += shift;
-  last_src_y += shift;
-  tmp_sad =
-      cpi->fn_ptr[bsize].sdf(src_y, src_ystride, last_src_y, last_src_ystride);
-  tmp_variance = vpx_variance64x64(src_y, src_ystride, last_src_y,
-                                   last_src_ystride, &tmp_sse);
+  if (vp9_source_analysis_valid(&cpi->source_analysis, cpi->Source,
+                                cpi->Last_Source)) {
+    tmp_sad = vp9_source_analysis_sb(&cpi->source_analysis, mi_row >> 3,
+                                     mi_col >> 3, &tmp_sse, &tmp_variance);
+  } else {
+    src_y += src_ystride * (mi_row << 3) + (mi_col << 3);
+    last_src_y += last_src_ystride * (mi_row << 3) + (mi_col << 3);
+    tmp_sad = cpi->fn_ptr[bsize].sdf(src_y, src_ystride, last_src_y,
+                                     last_src_ystride);
+    tmp_variance = vpx_variance64x64(src_y, src_ystride, last_src_y,
+                                     last_src_ystride, &tmp_sse);
+  }
   // Note: tmp_sse - tmp_variance = ((sum * sum) >> 12)
   if (tmp_sad < avg_source_sad_threshold)
     x->content_state_sb = ((tmp_sse - tmp_variance) < 25) ? kLowSadLowSumdiff
@@ -3083,53 +3089,6 @@ static INLINE void load_pred_mv(MACROBLOCK *x, PICK_MODE_CONTEXT *ctx) {
   memcpy(x->pred_mv, ctx->pred_mv, sizeof(x->pred_mv));
 }
 
-// Calculate prediction based on the given input features and neural net config.
-// Assume there are no more than NN_MAX_NODES_PER_LAYER nodes in each hidden
-// layer.
-static void nn_predict(const float *features, const NN_CONFIG *nn_config,
-                       float *output) {
-  int num_input_nodes = nn_config->num_inputs;
-  int buf_index = 0;
-  float buf[2][NN_MAX_NODES_PER_LAYER];
-  const float *input_nodes = features;
-
-  // Propagate hidden layers.
-  const int num_layers = nn_config->num_hidden_layers;
-  int layer, node, i;
-  assert(num_layers <= NN_MAX_HIDDEN_LAYERS);
-  for (layer = 0; layer < num_layers; ++layer) {
-    const float *weights = nn_config->weights[layer];
-    const float *bias = nn_config->bias[layer];
-    float *output_nodes = buf[buf_index];
-    const int num_output_nodes = nn_config->num_hidden_nodes[layer];
-    assert(num_output_nodes < NN_MAX_NODES_PER_LAYER);
-    for (node = 0; node < num_output_nodes; ++node) {
-      float val = 0.0f;
-      for (i = 0; i < num_input_nodes; ++i) val += weights[i] * input_nodes[i];
-      val += bias[node];
-      // ReLU as activation function.
-      val = VPXMAX(val, 0.0f);
-      output_nodes[node] = val;
-      weights += num_input_nodes;
-    }
-    num_input_nodes = num_output_nodes;
-    input_nodes = output_nodes;
-    buf_index = 1 - buf_index;
-  }
-
-  // Final output layer.
-  {
-    const float *weights = nn_config->weights[num_layers];
-    for (node = 0; node < nn_config->num_outputs; ++node) {
-      const float *bias = nn_config->bias[num_layers];
-      float val = 0.0f;
-      for (i = 0; i < num_input_nodes; ++i) val += weights[i] * input_nodes[i];
-      output[node] = val + bias[node];
-      weights += num_input_nodes;
-    }
-  }
-}
-
 #if !CONFIG_REALTIME_ONLY
 #define FEATURES 7
 // Machine-learning based partition search early termination.
@@ -3215,7 +3174,7 @@ static int ml_pruning_partition(VP9_COMMON *const cm, MACROBLOCKD *const xd,
   if (linear_score > 0.1f) return 0;
 
   // Predict using neural net model.
-  nn_predict(features, nn_config, &nn_score);
+  vp9_nn_predict(features, nn_config, &nn_score);
 
   if (linear_score < -0.0f && nn_score < 0.1f) return 1;
   if (nn_score < -0.0f && linear_score < 0.1f) return 1;
@@ -3378,7 +3337,7 @@ static void ml_prune_rect_partition(VP9_COMP *const cpi, MACROBLOCK *const x,
     }
 
     assert(feature_index == FEATURES);
-    nn_predict(features, nn_config, score);
+    vp9_nn_predict(features, nn_config, score);
   }
 
   // Make decisions based on the model score.
@@ -3569,7 +3528,7 @@ static void ml_predict_var_rd_paritioning(const VP9_COMP *const cpi,
     assert(feature_idx == FEATURES);
 
     // Feed the features into the model to get the confidence score.
-    nn_predict(features, nn_config, &score);
+    vp9_nn_predict(features, nn_config, &score);
 
     // Higher score means that the model has higher confidence that the split
     // partition is better than the non-split partition. So if the score is
@@ -4041,7 +4000,7 @@ static int rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
 
   // Determine partition types in search according to the speed features.
   // The threshold set here has to be of square block size.
-  if (cpi->sf.auto_min_max_partition_size) {
+  if (cpi->sf.auto_min_max_partition_size || x->use_partition_hint) {
     partition_none_allowed &= (bsize <= max_size);
     partition_horz_allowed &=
         ((bsize <= max_size && bsize > min_size) || force_horz_split);
@@ -4488,6 +4447,7 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
       x->pred_mv[i].row = INT16_MAX;
       x->pred_mv[i].col = INT16_MAX;
     }
+    vp9_zero(x->mv_search_cache.valid);
     td->pc_root->index = 0;
 
     if (seg->enabled) {
@@ -4532,6 +4492,15 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
         rd_auto_partition_range(cpi, tile_info, xd, mi_row, mi_col,
                                 &x->min_partition_size, &x->max_partition_size);
       }
+      // The partitions of the analysis encoder of a ladder override the
+      // range, relaxed as the other encoder may run at another resolution.
+      x->use_partition_hint =
+          vp9_get_partition_hint(cpi, mi_row, mi_col, &x->min_partition_size,
+                                 &x->max_partition_size);
+      if (x->use_partition_hint) {
+        x->min_partition_size = min_partition_size[x->min_partition_size];
+        x->max_partition_size = max_partition_size[x->max_partition_size];
+      }
       td->pc_root->none.rdcost = 0;
       rd_pick_partition(cpi, td, tile_data, tp, mi_row, mi_col, BLOCK_64X64,
                         &dummy_rdc, dummy_rdc, td->pc_root);
@@ -4848,7 +4817,7 @@ static int ml_predict_var_paritioning(VP9_COMP *cpi, MACROBLOCK *x,
     }
 
     assert(feature_idx == FEATURES);
-    nn_predict(features, nn_config, score);
+    vp9_nn_predict(features, nn_config, score);
     if (score[0] > thresh) return PARTITION_SPLIT;
     if (score[0] < -thresh) return PARTITION_NONE;
     return -1;
@@ -5519,9 +5488,8 @@ static void encode_nonrd_sb_row(VP9_COMP *cpi, ThreadData *td,
     x->lastgolden_frame_usage = 0;
 
     if (cpi->compute_source_sad_onepass && cpi->sf.use_source_sad) {
-      int shift = cpi->Source->y_stride * (mi_row << 3) + (mi_col << 3);
       int sb_offset2 = ((cm->mi_cols + 7) >> 3) * (mi_row >> 3) + (mi_col >> 3);
-      int64_t source_sad = avg_source_sad(cpi, x, shift, sb_offset2);
+      int64_t source_sad = avg_source_sad(cpi, x, mi_row, mi_col, sb_offset2);
       if (sf->adapt_partition_source_sad &&
           (cpi->oxcf.rc_mode == VPX_VBR && !cpi->rc.is_src_frame_alt_ref &&
            source_sad > sf->adapt_partition_thresh &&
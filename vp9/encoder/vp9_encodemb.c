@@ -200,20 +200,20 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
         int dqc0, dqc1;
         int64_t best_eob_cost_cur;
         int use_x1;
+        int x1_ruled_out;
 
         // Calculate RD Cost effect on the next coeff for the two candidates.
         int64_t next_bits0 = 0;
         int64_t next_bits1 = 0;
         int64_t next_eob_bits0 = 0;
         int64_t next_eob_bits1 = 0;
+        int ctx_next, token_tree_sel_next;
+        int token_next = EOB_TOKEN;
+        unsigned int(*token_costs_next)[2][COEFF_CONTEXTS][ENTROPY_TOKENS] =
+            NULL;
         if (i < default_eob - 1) {
-          int ctx_next, token_tree_sel_next;
-          const int band_next = band_translate[i + 1];
-          const int token_next =
-              (i + 1 != eob) ? vp9_get_token(qcoeff[scan[i + 1]]) : EOB_TOKEN;
-          unsigned int(*const token_costs_next)[2][COEFF_CONTEXTS]
-                                               [ENTROPY_TOKENS] =
-                                                   token_costs + band_next;
+          token_costs_next = token_costs + band_translate[i + 1];
+          if (i + 1 != eob) token_next = vp9_get_token(qcoeff[scan[i + 1]]);
           token_cache[rc] = vp9_pt_energy_class[t0];
           ctx_next = get_coef_context(nb, token_cache, i + 1);
           token_tree_sel_next = (x == 0);
@@ -221,25 +221,40 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
               (*token_costs_next)[token_tree_sel_next][ctx_next][token_next];
           next_eob_bits0 =
               (*token_costs_next)[token_tree_sel_next][ctx_next][EOB_TOKEN];
-          token_cache[rc] = vp9_pt_energy_class[t1];
-          ctx_next = get_coef_context(nb, token_cache, i + 1);
-          token_tree_sel_next = (x1 == 0);
-          next_bits1 =
-              (*token_costs_next)[token_tree_sel_next][ctx_next][token_next];
-          if (x1 != 0) {
-            next_eob_bits1 =
-                (*token_costs_next)[token_tree_sel_next][ctx_next][EOB_TOKEN];
-          }
         }
 
+        // The second candidate can't be picked, neither for its own cost nor
+        // as the last coefficient, when the distortion it adds exceeds the
+        // rate it can save. The rate it spends on the next coeff is at least
+        // 0, and the slack covers the rounding of the rates in RDCOST().
+        x1_ruled_out =
+            (distortion1 - distortion0) *
+                ((int64_t)1 << (rddiv + VP9_PROB_COST_SHIFT)) >
+            (rate0 + VPXMAX(next_bits0, next_eob_bits0) - rate1) * rdmult +
+                (2 << VP9_PROB_COST_SHIFT);
+
         // Compare the total RD costs for two candidates.
-        rd_cost0 = RDCOST(rdmult, rddiv, (rate0 + next_bits0), distortion0);
-        rd_cost1 = RDCOST(rdmult, rddiv, (rate1 + next_bits1), distortion1);
-        rdcost_better_for_x1 = (rd_cost1 < rd_cost0);
+        rdcost_better_for_x1 = 0;
+        if (!x1_ruled_out) {
+          if (i < default_eob - 1) {
+            token_cache[rc] = vp9_pt_energy_class[t1];
+            ctx_next = get_coef_context(nb, token_cache, i + 1);
+            token_tree_sel_next = (x1 == 0);
+            next_bits1 =
+                (*token_costs_next)[token_tree_sel_next][ctx_next][token_next];
+            if (x1 != 0) {
+              next_eob_bits1 =
+                  (*token_costs_next)[token_tree_sel_next][ctx_next][EOB_TOKEN];
+            }
+          }
+          rd_cost0 = RDCOST(rdmult, rddiv, (rate0 + next_bits0), distortion0);
+          rd_cost1 = RDCOST(rdmult, rddiv, (rate1 + next_bits1), distortion1);
+          rdcost_better_for_x1 = (rd_cost1 < rd_cost0);
+        }
         eob_cost0 = RDCOST(rdmult, rddiv, (accu_rate + rate0 + next_eob_bits0),
                            (accu_error + distortion0 - distortion_for_zero));
         eob_cost1 = eob_cost0;
-        if (x1 != 0) {
+        if (x1 != 0 && !x1_ruled_out) {
           eob_cost1 =
               RDCOST(rdmult, rddiv, (accu_rate + rate1 + next_eob_bits1),
                      (accu_error + distortion1 - distortion_for_zero));
@@ -745,6 +745,214 @@ int vp9_set_roi_map(VP9_COMP *cpi, unsigned char *map, unsigned int rows,
   return 0;
 }
 
+// The hints belong to the next frame pushed into the lookahead.
+static int get_next_show_idx(const VP9_COMP *cpi) {
+  return cpi->lookahead ? vp9_lookahead_next_show_idx(cpi->lookahead) : 0;
+}
+
+static MOTION_HINTS *get_next_motion_hints(VP9_COMP *cpi, int num_hints) {
+  VP9_COMMON *const cm = &cpi->common;
+  MOTION_HINTS *const motion_hints =
+      &cpi->motion_hints[get_next_show_idx(cpi) % MOTION_HINTS_SLOTS];
+
+  motion_hints->show_idx = -1;
+  if (motion_hints->alloc_size < num_hints) {
+    vpx_free(motion_hints->hints);
+    vpx_free(motion_hints->partition);
+    motion_hints->hints = NULL;
+    motion_hints->partition = NULL;
+    motion_hints->alloc_size = 0;
+    CHECK_MEM_ERROR(cm, motion_hints->hints,
+                    vpx_malloc(num_hints * sizeof(*motion_hints->hints)));
+    CHECK_MEM_ERROR(cm, motion_hints->partition,
+                    vpx_malloc(num_hints * sizeof(*motion_hints->partition)));
+    motion_hints->alloc_size = num_hints;
+  }
+  return motion_hints;
+}
+
+int vp9_set_motion_hints(VP9_COMP *cpi, const vpx_motion_hint_t *hints,
+                         unsigned int rows, unsigned int cols, int trusted) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int num_hints = (int)(rows * cols);
+  MOTION_HINTS *motion_hints;
+  int i;
+
+  if (!hints) {
+    // Drop the hints of the next frame.
+    get_next_motion_hints(cpi, 0);
+    return 0;
+  }
+
+  if (cm->mi_rows != (int)rows || cm->mi_cols != (int)cols) return -1;
+  for (i = 0; i < num_hints; ++i) {
+    if (hints[i].ref_frame < INTRA_FRAME || hints[i].ref_frame > ALTREF_FRAME)
+      return -1;
+  }
+
+  motion_hints = get_next_motion_hints(cpi, num_hints);
+  memcpy(motion_hints->hints, hints, num_hints * sizeof(*hints));
+  motion_hints->rows = rows;
+  motion_hints->cols = cols;
+  motion_hints->trusted = trusted != 0;
+  motion_hints->use_partition = 0;
+  motion_hints->show_idx = get_next_show_idx(cpi);
+  return 0;
+}
+
+int vp9_get_motion_hint(const VP9_COMP *cpi, MV_REFERENCE_FRAME ref_frame,
+                        BLOCK_SIZE bsize, int mi_row, int mi_col, MV *mv) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const MOTION_HINTS *const motion_hints = cpi->frame_motion_hints;
+  const vpx_motion_hint_t *hint;
+  int row, col;
+
+  // The hints do not apply to a resized frame.
+  if (motion_hints == NULL || motion_hints->rows != cm->mi_rows ||
+      motion_hints->cols != cm->mi_cols)
+    return MOTION_HINT_NONE;
+
+  // Use the hint of the 8x8 block at the center of the block.
+  row = VPXMIN(mi_row + (num_8x8_blocks_high_lookup[bsize] >> 1),
+               cm->mi_rows - 1);
+  col = VPXMIN(mi_col + (num_8x8_blocks_wide_lookup[bsize] >> 1),
+               cm->mi_cols - 1);
+  hint = &motion_hints->hints[row * motion_hints->cols + col];
+  if (hint->ref_frame != ref_frame) return MOTION_HINT_NONE;
+
+  mv->row = hint->mv_row;
+  mv->col = hint->mv_col;
+  return motion_hints->trusted ? MOTION_HINT_TRUSTED : MOTION_HINT_CANDIDATE;
+}
+
+int vp9_get_ladder_info(const VP9_COMP *cpi, vpx_ladder_info_t *info) {
+  const VP9_COMMON *const cm = &cpi->common;
+  int mi_row, mi_col;
+
+  if (!cpi->ladder_info_ready || !info->blocks ||
+      info->rows != (unsigned int)cm->mi_rows ||
+      info->cols != (unsigned int)cm->mi_cols)
+    return -1;
+
+  for (mi_row = 0; mi_row < cm->mi_rows; ++mi_row) {
+    for (mi_col = 0; mi_col < cm->mi_cols; ++mi_col) {
+      // The mode info of the last encoded frame was moved to prev_mi.
+      const MODE_INFO *const mi =
+          cm->prev_mi_grid_visible[mi_row * cm->mi_stride + mi_col];
+      vpx_ladder_block_t *const block = &info->blocks[mi_row * cm->mi_cols +
+                                                      mi_col];
+      if (is_inter_block(mi)) {
+        block->motion.mv_row = mi->mv[0].as_mv.row;
+        block->motion.mv_col = mi->mv[0].as_mv.col;
+        block->motion.ref_frame = mi->ref_frame[0];
+      } else {
+        block->motion.mv_row = 0;
+        block->motion.mv_col = 0;
+        block->motion.ref_frame = INTRA_FRAME;
+      }
+      block->width = 4 << b_width_log2_lookup[mi->sb_type];
+      block->height = 4 << b_height_log2_lookup[mi->sb_type];
+    }
+  }
+  info->width = cm->width;
+  info->height = cm->height;
+  return 0;
+}
+
+// Returns the square block size closest to size pixels.
+static BLOCK_SIZE get_square_size(int size) {
+  if (size < 6) return BLOCK_4X4;
+  if (size < 12) return BLOCK_8X8;
+  if (size < 24) return BLOCK_16X16;
+  if (size < 48) return BLOCK_32X32;
+  return BLOCK_64X64;
+}
+
+int vp9_set_ladder_info(VP9_COMP *cpi, const vpx_ladder_info_t *info) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int num_blocks = (int)(info->rows * info->cols);
+  MOTION_HINTS *motion_hints;
+  int mi_row, mi_col, i;
+
+  if (!info->blocks) {
+    // Drop the hints of the next frame.
+    get_next_motion_hints(cpi, 0);
+    return 0;
+  }
+
+  if (info->width == 0 || info->height == 0 ||
+      info->rows != (info->height + 7) / 8 ||
+      info->cols != (info->width + 7) / 8)
+    return -1;
+  for (i = 0; i < num_blocks; ++i) {
+    const vpx_motion_hint_t *const motion = &info->blocks[i].motion;
+    if (motion->ref_frame < INTRA_FRAME || motion->ref_frame > ALTREF_FRAME)
+      return -1;
+  }
+
+  motion_hints = get_next_motion_hints(cpi, cm->mi_rows * cm->mi_cols);
+  for (mi_row = 0; mi_row < cm->mi_rows; ++mi_row) {
+    // Use the analysis block at the center of the 8x8 block.
+    const int row = VPXMIN(
+        (mi_row * MI_SIZE + MI_SIZE / 2) * (int)info->height / cm->height / 8,
+        (int)info->rows - 1);
+    for (mi_col = 0; mi_col < cm->mi_cols; ++mi_col) {
+      const int col = VPXMIN(
+          (mi_col * MI_SIZE + MI_SIZE / 2) * (int)info->width / cm->width / 8,
+          (int)info->cols - 1);
+      const vpx_ladder_block_t *const block = &info->blocks[row * info->cols +
+                                                            col];
+      vpx_motion_hint_t *const hint =
+          &motion_hints->hints[mi_row * cm->mi_cols + mi_col];
+      PARTITION_HINT *const partition =
+          &motion_hints->partition[mi_row * cm->mi_cols + mi_col];
+      const int width = block->width * cm->width / (int)info->width;
+      const int height = block->height * cm->height / (int)info->height;
+
+      hint->mv_row = (int16_t)clamp(
+          block->motion.mv_row * cm->height / (int)info->height, MV_LOW + 1,
+          MV_UPP - 1);
+      hint->mv_col = (int16_t)clamp(
+          block->motion.mv_col * cm->width / (int)info->width, MV_LOW + 1,
+          MV_UPP - 1);
+      hint->ref_frame = block->motion.ref_frame;
+      partition->min_size = get_square_size(VPXMIN(width, height));
+      partition->max_size = get_square_size(VPXMAX(width, height));
+    }
+  }
+  motion_hints->rows = cm->mi_rows;
+  motion_hints->cols = cm->mi_cols;
+  motion_hints->trusted = 1;
+  motion_hints->use_partition = 1;
+  motion_hints->show_idx = get_next_show_idx(cpi);
+  return 0;
+}
+
+int vp9_get_partition_hint(const VP9_COMP *cpi, int mi_row, int mi_col,
+                           BLOCK_SIZE *min_size, BLOCK_SIZE *max_size) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const MOTION_HINTS *const motion_hints = cpi->frame_motion_hints;
+  const int row_end = VPXMIN(mi_row + MI_BLOCK_SIZE, cm->mi_rows);
+  const int col_end = VPXMIN(mi_col + MI_BLOCK_SIZE, cm->mi_cols);
+  int row, col;
+
+  if (motion_hints == NULL || !motion_hints->use_partition ||
+      motion_hints->rows != cm->mi_rows || motion_hints->cols != cm->mi_cols)
+    return 0;
+
+  *min_size = BLOCK_64X64;
+  *max_size = BLOCK_4X4;
+  for (row = mi_row; row < row_end; ++row) {
+    for (col = mi_col; col < col_end; ++col) {
+      const PARTITION_HINT *const partition =
+          &motion_hints->partition[row * motion_hints->cols + col];
+      *min_size = VPXMIN(*min_size, (BLOCK_SIZE)partition->min_size);
+      *max_size = VPXMAX(*max_size, (BLOCK_SIZE)partition->max_size);
+    }
+  }
+  return 1;
+}
+
 int vp9_set_active_map(VP9_COMP *cpi, unsigned char *new_map_16x16, int rows,
                        int cols) {
   if (rows == cpi->common.mb_rows && cols == cpi->common.mb_cols) {
@@ -999,6 +1207,8 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vpx_free(cpi->content_state_sb_fd);
   cpi->content_state_sb_fd = NULL;
 
+  vp9_source_analysis_free(&cpi->source_analysis);
+
   vpx_free(cpi->count_arf_frame_usage);
   cpi->count_arf_frame_usage = NULL;
   vpx_free(cpi->count_lastgolden_frame_usage);
@@ -1013,6 +1223,14 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vpx_free(cpi->roi.roi_map);
   cpi->roi.roi_map = NULL;
 
+  for (i = 0; i < MOTION_HINTS_SLOTS; ++i) {
+    vpx_free(cpi->motion_hints[i].hints);
+    vpx_free(cpi->motion_hints[i].partition);
+    cpi->motion_hints[i].hints = NULL;
+    cpi->motion_hints[i].partition = NULL;
+    cpi->motion_hints[i].alloc_size = 0;
+  }
+
   vpx_free(cpi->consec_zero_mv);
   cpi->consec_zero_mv = NULL;
 
@@ -2321,6 +2539,8 @@ VP9_COMP *vp9_create_compressor(const VP9EncoderConfig *oxcf,
 
   cpi->force_update_segmentation = 0;
 
+  for (i = 0; i < MOTION_HINTS_SLOTS; ++i) cpi->motion_hints[i].show_idx = -1;
+
   init_config(cpi, oxcf);
   cpi->frame_info = vp9_get_frame_info(oxcf);
 
@@ -3700,7 +3920,8 @@ static void set_size_dependent_vars(VP9_COMP *cpi, int *q, int *bottom_index,
 static void init_motion_estimation(VP9_COMP *cpi) {
   int y_stride = cpi->scaled_source.y_stride;
 
-  if (cpi->sf.mv.search_method == NSTEP) {
+  if (cpi->sf.mv.search_method == NSTEP ||
+      cpi->sf.mv.search_method == PROJECTION) {
     vp9_init3smotion_compensation(&cpi->ss_cfg, y_stride);
   } else if (cpi->sf.mv.search_method == DIAMOND) {
     vp9_init_dsmotion_compensation(&cpi->ss_cfg, y_stride);
@@ -3964,6 +4185,14 @@ static int encode_without_recode_loop(VP9_COMP *cpi, size_t *size,
       cpi->Last_Source->y_height != cpi->Source->y_height)
     cpi->compute_source_sad_onepass = 0;
 
+  // The superblock source sad, scene detection and noise estimation all
+  // compare Source against Last_Source: analyze the pair once when the
+  // per-superblock source sad needs the whole frame anyway.
+  if (cpi->compute_source_sad_onepass && cpi->sf.use_source_sad)
+    vp9_source_analysis_compute(cpi, cpi->Source, cpi->Last_Source);
+  else
+    vp9_source_analysis_reset(&cpi->source_analysis);
+
   if (frame_is_intra_only(cm) || cpi->resize_pending != 0) {
     memset(cpi->consec_zero_mv, 0,
            cm->mi_rows * cm->mi_cols * sizeof(*cpi->consec_zero_mv));
@@ -5456,6 +5685,9 @@ static void encode_frame_to_data_rate(
   set_ext_overrides(cpi);
   vpx_clear_system_state();
 
+  // The source buffers of the previous frame may have been recycled.
+  vp9_source_analysis_reset(&cpi->source_analysis);
+
 #ifdef ENABLE_KF_DENOISE
   // Spatial denoise of key frame.
   if (is_spatial_denoise_enabled(cpi)) spatial_denoise_frame(cpi);
@@ -5758,6 +5990,7 @@ static void encode_frame_to_data_rate(
 
   if (cm->show_frame) {
     vp9_swap_mi_and_prev_mi(cm);
+    cpi->ladder_info_ready = !cm->show_existing_frame;
     if (cpi->use_svc) vp9_inc_frame_in_layer(cpi);
   }
   update_frame_indexes(cm, cm->show_frame);
@@ -5834,6 +6067,14 @@ int vp9_receive_raw_frame(VP9_COMP *cpi, vpx_enc_frame_flags_t frame_flags,
 
   alloc_raw_frame_buffers(cpi);
 
+  // With lag in one-pass realtime mode, compute the temporal statistics used
+  // by vp9_scene_detection_onepass() on the lookahead analysis thread.
+  vp9_lookahead_set_analysis(cpi->lookahead,
+                             cpi->oxcf.pass == 0 &&
+                                 cpi->oxcf.mode == REALTIME &&
+                                 cpi->oxcf.lag_in_frames > 0 &&
+                                 cpi->oxcf.max_threads > 1);
+
   vpx_usec_timer_start(&timer);
 
   if (vp9_lookahead_push(cpi->lookahead, sd, time_stamp, end_time,
@@ -6420,7 +6661,7 @@ static uint32_t motion_compensated_prediction(VP9_COMP *cpi, ThreadData *td,
                                               uint8_t *cur_frame_buf,
                                               uint8_t *ref_frame_buf,
                                               int stride, BLOCK_SIZE bsize,
-                                              MV *mv) {
+                                              const MV *full_mv, MV *mv) {
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   MV_SPEED_FEATURES *const mv_sf = &cpi->sf.mv;
@@ -6445,25 +6686,30 @@ static uint32_t motion_compensated_prediction(VP9_COMP *cpi, ThreadData *td,
   xd->plane[0].pre[0].buf = ref_frame_buf;
   xd->plane[0].pre[0].stride = stride;
 
-  step_param = mv_sf->reduce_first_step_size;
-  step_param = VPXMIN(step_param, MAX_MVSEARCH_STEPS - 2);
+  if (full_mv != NULL) {
+    // The full pixel search was done for the whole frame by the ME pyramid.
+    *mv = *full_mv;
+  } else {
+    step_param = mv_sf->reduce_first_step_size;
+    step_param = VPXMIN(step_param, MAX_MVSEARCH_STEPS - 2);
 
-  vp9_set_mv_search_range(&x->mv_limits, &best_ref_mv1);
+    vp9_set_mv_search_range(&x->mv_limits, &best_ref_mv1);
 
-  vp9_full_pixel_search(cpi, x, bsize, &best_ref_mv1_full, step_param,
-                        search_method, sadpb, cond_cost_list(cpi, cost_list),
-                        &best_ref_mv1, mv, 0, 0);
+    vp9_full_pixel_search(cpi, x, bsize, &best_ref_mv1_full, step_param,
+                          search_method, sadpb, cond_cost_list(cpi, cost_list),
+                          &best_ref_mv1, mv, 0, 0);
 
-  /* restore UMV window */
-  x->mv_limits = tmp_mv_limits;
+    /* restore UMV window */
+    x->mv_limits = tmp_mv_limits;
+  }
 
   // TODO(yunqing): may use higher tap interp filter than 2 taps.
   // Ignore mv costing by sending NULL pointer instead of cost array
   bestsme = cpi->find_fractional_mv_step(
       x, mv, &best_ref_mv1, cpi->common.allow_high_precision_mv, x->errorperbit,
       &cpi->fn_ptr[bsize], 0, mv_sf->subpel_search_level,
-      cond_cost_list(cpi, cost_list), NULL, NULL, &distortion, &sse, NULL, 0, 0,
-      USE_2_TAPS);
+      full_mv != NULL ? NULL : cond_cost_list(cpi, cost_list), NULL, NULL,
+      &distortion, &sse, NULL, 0, 0, USE_2_TAPS);
 
   return bestsme;
 }
@@ -6677,7 +6923,8 @@ static void mode_estimation(VP9_COMP *cpi, MACROBLOCK *x, MACROBLOCKD *xd,
                             int16_t *src_diff, tran_low_t *coeff,
                             tran_low_t *qcoeff, tran_low_t *dqcoeff, int mi_row,
                             int mi_col, BLOCK_SIZE bsize, TX_SIZE tx_size,
-                            YV12_BUFFER_CONFIG *ref_frame[], uint8_t *predictor,
+                            YV12_BUFFER_CONFIG *ref_frame[],
+                            const MotionField *me_fields[], uint8_t *predictor,
                             int64_t *recon_error, int64_t *sse) {
   VP9_COMMON *cm = &cpi->common;
   ThreadData *td = &cpi->td;
@@ -6756,18 +7003,27 @@ static void mode_estimation(VP9_COMP *cpi, MACROBLOCK *x, MACROBLOCKD *xd,
     int_mv mv;
 #if CONFIG_NON_GREEDY_MV
     MotionField *motion_field;
+#else
+    int_mv full_mv;
 #endif
     if (ref_frame[rf_idx] == NULL) continue;
 
 #if CONFIG_NON_GREEDY_MV
     (void)td;
+    (void)me_fields;
     motion_field = vp9_motion_field_info_get_motion_field(
         &cpi->motion_field_info, frame_idx, rf_idx, bsize);
     mv = vp9_motion_field_mi_get_mv(motion_field, mi_row, mi_col);
 #else
-    motion_compensated_prediction(cpi, td, xd->cur_buf->y_buffer + mb_y_offset,
-                                  ref_frame[rf_idx]->y_buffer + mb_y_offset,
-                                  xd->cur_buf->y_stride, bsize, &mv.as_mv);
+    if (me_fields[rf_idx] != NULL) {
+      full_mv = vp9_motion_field_mi_get_mv(me_fields[rf_idx], mi_row, mi_col);
+      full_mv.as_mv.row >>= 3;
+      full_mv.as_mv.col >>= 3;
+    }
+    motion_compensated_prediction(
+        cpi, td, xd->cur_buf->y_buffer + mb_y_offset,
+        ref_frame[rf_idx]->y_buffer + mb_y_offset, xd->cur_buf->y_stride, bsize,
+        me_fields[rf_idx] != NULL ? &full_mv.as_mv : NULL, &mv.as_mv);
 #endif
 
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -7237,6 +7493,7 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
   TplDepFrame *tpl_frame = &cpi->tpl_stats[frame_idx];
   YV12_BUFFER_CONFIG *this_frame = gf_picture[frame_idx].frame;
   YV12_BUFFER_CONFIG *ref_frame[MAX_INTER_REF_FRAMES] = { NULL, NULL, NULL };
+  const MotionField *me_fields[MAX_INTER_REF_FRAMES] = { NULL, NULL, NULL };
 
   VP9_COMMON *cm = &cpi->common;
   struct scale_factors sf;
@@ -7291,6 +7548,16 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     if (rf_idx != -1) ref_frame[idx] = gf_picture[rf_idx].frame;
   }
 
+#if !CONFIG_NON_GREEDY_MV
+  if (cpi->sf.tpl_use_me_pyramid) {
+    for (idx = 0; idx < MAX_INTER_REF_FRAMES; ++idx) {
+      if (ref_frame[idx] == NULL) continue;
+      me_fields[idx] =
+          vp9_me_pyramid_get_field(cpi, this_frame, ref_frame[idx], bsize);
+    }
+  }
+#endif
+
   xd->mi = cm->mi_grid_visible;
   xd->mi[0] = cm->mi;
   xd->cur_buf = this_frame;
@@ -7326,7 +7593,8 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     for (mi_col = 0; mi_col < cm->mi_cols; mi_col += mi_width) {
       mode_estimation(cpi, x, xd, &sf, gf_picture, frame_idx, tpl_frame,
                       src_diff, coeff, qcoeff, dqcoeff, mi_row, mi_col, bsize,
-                      tx_size, ref_frame, predictor, &recon_error, &sse);
+                      tx_size, ref_frame, me_fields, predictor, &recon_error,
+                      &sse);
       // Motion flow dependency dispenser.
       tpl_model_store(tpl_frame->tpl_stats_ptr, mi_row, mi_col, bsize,
                       tpl_frame->stride);
@@ -7498,6 +7766,7 @@ static void free_tpl_buffer(VP9_COMP *cpi) {
     vpx_free(cpi->tpl_stats[frame].tpl_stats_ptr);
     cpi->tpl_stats[frame].is_valid = 0;
   }
+  vp9_me_pyramid_free(&cpi->me_pyramid);
 }
 
 #if CONFIG_RATE_CTRL
@@ -7558,6 +7827,9 @@ static void setup_tpl_stats(VP9_COMP *cpi) {
     if (gf_picture[frame_idx].update_type == USE_BUF_FRAME) continue;
     mc_flow_dispenser(cpi, gf_picture, frame_idx, cpi->tpl_bsize);
   }
+  // The lookahead buffers and the reconstructed frames change before the next
+  // group.
+  vp9_me_pyramid_reset(&cpi->me_pyramid);
 #if CONFIG_NON_GREEDY_MV
   cpi->tpl_ready = 1;
 #if DUMP_TPL_STATS
@@ -7743,6 +8015,16 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
     cpi->un_scaled_source = cpi->Source =
         force_src_buffer ? force_src_buffer : &source->img;
 
+    // The hints of a source frame do not apply to the alt-ref made from it.
+    cpi->frame_motion_hints = NULL;
+    cpi->ladder_info_ready = 0;
+    if (cm->show_frame) {
+      const MOTION_HINTS *const motion_hints =
+          &cpi->motion_hints[source->show_idx % MOTION_HINTS_SLOTS];
+      if (motion_hints->show_idx == source->show_idx)
+        cpi->frame_motion_hints = motion_hints;
+    }
+
 #ifdef ENABLE_KF_DENOISE
     // Copy of raw source for metrics calculation.
     if (is_psnr_calc_enabled(cpi))
@@ -8252,4 +8534,6 @@ void vp9_set_row_mt(VP9_COMP *cpi) {
     cpi->row_mt_bit_exact = 1;
   else
     cpi->row_mt_bit_exact = 0;
+
+  cpi->row_mt_deterministic = cpi->row_mt && cpi->oxcf.row_mt == 2;
 }
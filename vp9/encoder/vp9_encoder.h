@@ -45,10 +45,12 @@
 #include "vp9/encoder/vp9_lookahead.h"
 #include "vp9/encoder/vp9_mbgraph.h"
 #include "vp9/encoder/vp9_mcomp.h"
+#include "vp9/encoder/vp9_me_pyramid.h"
 #include "vp9/encoder/vp9_noise_estimate.h"
 #include "vp9/encoder/vp9_quantize.h"
 #include "vp9/encoder/vp9_ratectrl.h"
 #include "vp9/encoder/vp9_rd.h"
+#include "vp9/encoder/vp9_source_analysis.h"
 #include "vp9/encoder/vp9_speed_features.h"
 #include "vp9/encoder/vp9_svc_layercontext.h"
 #include "vp9/encoder/vp9_tokenize.h"
@@ -504,6 +506,8 @@ typedef struct ARNRFilterData {
   int frame_count;
   int alt_ref_index;
   struct scale_factors sf;
+  // Where to export the 32x32 motion vectors of each frame, if not NULL.
+  ME_PYRAMID_FIELD *exported_fields[MAX_LAG_BUFFERS];
 } ARNRFilterData;
 
 typedef struct EncFrameBuf {
@@ -659,6 +663,29 @@ static INLINE int get_num_unit_4x4(int size) { return (size + 3) >> 2; }
 static INLINE int get_num_unit_16x16(int size) { return (size + 15) >> 4; }
 #endif  // CONFIG_RATE_CTRL
 
+// Enough for every frame held by the lookahead.
+#define MOTION_HINTS_SLOTS (MAX_LAG_BUFFERS + MAX_PRE_FRAMES + 1)
+
+// Range of the square sizes around the prediction block of an 8x8 block.
+typedef struct {
+  uint8_t min_size;  // BLOCK_SIZE
+  uint8_t max_size;  // BLOCK_SIZE
+} PARTITION_HINT;
+
+// Motion hints of a source frame, set through VP9E_SET_MOTION_HINTS or
+// VP9E_SET_LADDER_INFO.
+typedef struct {
+  int show_idx;  // Source frame of the hints, -1 if unused.
+  int rows;
+  int cols;
+  int trusted;
+  vpx_motion_hint_t *hints;
+  // Partition hints, only set from the ladder info.
+  PARTITION_HINT *partition;
+  int use_partition;
+  int alloc_size;
+} MOTION_HINTS;
+
 typedef struct VP9_COMP {
   FRAME_INFO frame_info;
   QUANTS quants;
@@ -686,6 +713,7 @@ typedef struct VP9_COMP {
   BLOCK_SIZE tpl_bsize;
   TplDepFrame tpl_stats[MAX_ARF_GOP_SIZE];
   YV12_BUFFER_CONFIG *tpl_recon_frames[REF_FRAMES];
+  ME_PYRAMID me_pyramid;
   EncFrameBuf enc_frame_buf[REF_FRAMES];
 #if CONFIG_MULTITHREAD
   pthread_mutex_t kmeans_mutex;
@@ -900,6 +928,8 @@ typedef struct VP9_COMP {
 
   NOISE_ESTIMATE noise_estimate;
 
+  SOURCE_ANALYSIS source_analysis;
+
   // Count on how many consecutive times a block uses small/zeromv for encoding.
   uint8_t *consec_zero_mv;
 
@@ -914,7 +944,8 @@ typedef struct VP9_COMP {
   BLOCK_SIZE vbp_bsize_min;
 
   // Multi-threading
-  int num_workers;
+  int num_workers;  // Number of active workers, including the main thread.
+  int allocated_workers;
   VPxWorker *workers;
   struct EncWorkerData *tile_thr_data;
   VP9LfSync lf_row_sync;
@@ -929,6 +960,10 @@ typedef struct VP9_COMP {
 
   int row_mt;
   unsigned int row_mt_bit_exact;
+  // Set when row_mt == 2: the speed features that depend on the number of
+  // threads are chosen as for multi-threaded encoding even with 1 thread, so
+  // that the bitstream does not depend on the thread count.
+  unsigned int row_mt_deterministic;
 
   // Previous Partition Info
   BLOCK_SIZE *prev_partition;
@@ -960,6 +995,14 @@ typedef struct VP9_COMP {
   int multi_layer_arf;
   vpx_roi_map_t roi;
 
+  // Hints of the source frames, indexed by show_idx % MOTION_HINTS_SLOTS.
+  MOTION_HINTS motion_hints[MOTION_HINTS_SLOTS];
+  // Hints of the frame being encoded, NULL if it has none.
+  const MOTION_HINTS *frame_motion_hints;
+  // Whether the mode info of the last encoded frame can be exported through
+  // VP9E_GET_LADDER_INFO.
+  int ladder_info_ready;
+
   LOOPFILTER_CONTROL loopfilter_ctrl;
 #if CONFIG_RATE_CTRL
   ENCODE_COMMAND encode_command;
@@ -1382,6 +1425,27 @@ int vp9_set_roi_map(VP9_COMP *cpi, unsigned char *map, unsigned int rows,
                     unsigned int cols, int delta_q[8], int delta_lf[8],
                     int skip[8], int ref_frame[8]);
 
+int vp9_set_motion_hints(VP9_COMP *cpi, const vpx_motion_hint_t *hints,
+                         unsigned int rows, unsigned int cols, int trusted);
+
+#define MOTION_HINT_NONE 0
+#define MOTION_HINT_CANDIDATE 1
+#define MOTION_HINT_TRUSTED 2
+
+// Returns the kind of motion hint of the frame for the block, and the hinted
+// motion vector in mv, in 1/8 pel.
+int vp9_get_motion_hint(const VP9_COMP *cpi, MV_REFERENCE_FRAME ref_frame,
+                        BLOCK_SIZE bsize, int mi_row, int mi_col, MV *mv);
+
+int vp9_get_ladder_info(const VP9_COMP *cpi, vpx_ladder_info_t *info);
+
+int vp9_set_ladder_info(VP9_COMP *cpi, const vpx_ladder_info_t *info);
+
+// Returns 1 with the range of partition sizes hinted for the superblock, 0
+// if the frame has no partition hints.
+int vp9_get_partition_hint(const VP9_COMP *cpi, int mi_row, int mi_col,
+                           BLOCK_SIZE *min_size, BLOCK_SIZE *max_size);
+
 void vp9_new_framerate(VP9_COMP *cpi, double framerate);
 
 void vp9_set_row_mt(VP9_COMP *cpi);
@@ -77,6 +77,47 @@ static int get_max_tile_cols(VP9_COMP *cpi) {
   return (1 << log2_tile_cols);
 }
 
+// Grows the worker pool to num_workers. The threads of the existing workers
+// are joined since they refer to the old VPxWorker array, but their thread
+// data is carried over.
+static void alloc_enc_workers(VP9_COMP *cpi, int num_workers) {
+  VP9_COMMON *const cm = &cpi->common;
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  VPxWorker *const workers = vpx_malloc(num_workers * sizeof(*workers));
+  EncWorkerData *const tile_thr_data =
+      vpx_calloc(num_workers, sizeof(*tile_thr_data));
+  int i;
+
+  if (workers == NULL || tile_thr_data == NULL) {
+    vpx_free(workers);
+    vpx_free(tile_thr_data);
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Failed to allocate encoder workers");
+  }
+
+  for (i = 0; i < cpi->allocated_workers; i++) {
+    winterface->end(&cpi->workers[i]);
+    tile_thr_data[i].allocated_td = cpi->tile_thr_data[i].allocated_td;
+  }
+  for (i = 0; i < num_workers; i++) {
+    winterface->init(&workers[i]);
+    tile_thr_data[i].cpi = cpi;
+  }
+
+  // The bitstream tile buffers are sized by the pool.
+  vp9_bitstream_encode_tiles_buffer_dealloc(cpi);
+
+  vpx_free(cpi->workers);
+  vpx_free(cpi->tile_thr_data);
+  cpi->workers = workers;
+  cpi->tile_thr_data = tile_thr_data;
+  cpi->allocated_workers = num_workers;
+  cpi->num_workers = 0;
+}
+
+// Sets the number of active workers. The pool only grows: workers beyond
+// num_workers are parked with their thread and thread data kept, so the
+// thread count can change between frames without reallocation.
 static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
   VP9_COMMON *const cm = &cpi->common;
   const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
@@ -90,51 +131,42 @@ static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
   }
   assert(num_workers > 0);
   if (num_workers == cpi->num_workers) return;
-  vp9_loop_filter_dealloc(&cpi->lf_row_sync);
-  vp9_bitstream_encode_tiles_buffer_dealloc(cpi);
-  vp9_encode_free_mt_data(cpi);
-
-  CHECK_MEM_ERROR(cm, cpi->workers,
-                  vpx_malloc(num_workers * sizeof(*cpi->workers)));
-
-  CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
-                  vpx_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
+  if (num_workers > cpi->allocated_workers) alloc_enc_workers(cpi, num_workers);
 
   for (i = 0; i < num_workers; i++) {
     VPxWorker *const worker = &cpi->workers[i];
     EncWorkerData *thread_data = &cpi->tile_thr_data[i];
 
-    ++cpi->num_workers;
-    winterface->init(worker);
-
     if (i < num_workers - 1) {
-      thread_data->cpi = cpi;
-
-      // Allocate thread data.
-      CHECK_MEM_ERROR(cm, thread_data->td,
-                      vpx_memalign(32, sizeof(*thread_data->td)));
-      vp9_zero(*thread_data->td);
-
-      // Set up pc_tree.
-      thread_data->td->leaf_tree = NULL;
-      thread_data->td->pc_tree = NULL;
-      vp9_setup_pc_tree(cm, thread_data->td);
-
-      // Allocate frame counters in thread data.
-      CHECK_MEM_ERROR(cm, thread_data->td->counts,
-                      vpx_calloc(1, sizeof(*thread_data->td->counts)));
+      if (thread_data->allocated_td == NULL) {
+        ThreadData *td;
+        // Allocate thread data.
+        CHECK_MEM_ERROR(cm, thread_data->allocated_td,
+                        vpx_memalign(32, sizeof(*thread_data->allocated_td)));
+        td = thread_data->allocated_td;
+        vp9_zero(*td);
+
+        // Set up pc_tree.
+        td->leaf_tree = NULL;
+        td->pc_tree = NULL;
+        vp9_setup_pc_tree(cm, td);
+
+        // Allocate frame counters in thread data.
+        CHECK_MEM_ERROR(cm, td->counts, vpx_calloc(1, sizeof(*td->counts)));
+      }
+      thread_data->td = thread_data->allocated_td;
 
-      // Create threads
+      // Create the thread, or keep the parked one.
       if (!winterface->reset(worker))
         vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
                            "Tile encoder thread creation failed");
     } else {
       // Main thread acts as a worker and uses the thread data in cpi.
-      thread_data->cpi = cpi;
       thread_data->td = &cpi->td;
     }
     winterface->sync(worker);
   }
+  cpi->num_workers = num_workers;
 }
 
 static void launch_enc_workers(VP9_COMP *cpi, VPxWorkerHook hook, void *data2,
@@ -172,7 +204,7 @@ static void launch_enc_workers(VP9_COMP *cpi, VPxWorkerHook hook, void *data2,
 
 void vp9_encode_free_mt_data(struct VP9_COMP *cpi) {
   int t;
-  for (t = 0; t < cpi->num_workers; ++t) {
+  for (t = 0; t < cpi->allocated_workers; ++t) {
     VPxWorker *const worker = &cpi->workers[t];
     EncWorkerData *const thread_data = &cpi->tile_thr_data[t];
 
@@ -180,15 +212,18 @@ void vp9_encode_free_mt_data(struct VP9_COMP *cpi) {
     vpx_get_worker_interface()->end(worker);
 
     // Deallocate allocated thread data.
-    if (t < cpi->num_workers - 1) {
-      vpx_free(thread_data->td->counts);
-      vp9_free_pc_tree(thread_data->td);
-      vpx_free(thread_data->td);
+    if (thread_data->allocated_td != NULL) {
+      vpx_free(thread_data->allocated_td->counts);
+      vp9_free_pc_tree(thread_data->allocated_td);
+      vpx_free(thread_data->allocated_td);
     }
   }
   vpx_free(cpi->tile_thr_data);
+  cpi->tile_thr_data = NULL;
   vpx_free(cpi->workers);
+  cpi->workers = NULL;
   cpi->num_workers = 0;
+  cpi->allocated_workers = 0;
 }
 
 void vp9_encode_tiles_mt(VP9_COMP *cpi) {
@@ -25,6 +25,10 @@ struct ThreadData;
 typedef struct EncWorkerData {
   struct VP9_COMP *cpi;
   struct ThreadData *td;
+  // Thread data owned by this worker. It is kept while the worker is parked
+  // or runs on the main thread (td == &cpi->td) and reused when the worker
+  // gets its own thread again.
+  struct ThreadData *allocated_td;
   int start;
   int thread_id;
   int tile_completion_status[MAX_NUM_TILE_COLS];
@@ -11,6 +11,9 @@
 #include <stdlib.h>
 
 #include "./vpx_config.h"
+#include "./vpx_dsp_rtcd.h"
+
+#include "vpx_ports/mem.h"
 
 #include "vp9/common/vp9_common.h"
 
@@ -31,6 +34,7 @@ static struct lookahead_entry *pop(struct lookahead_ctx *ctx, int *idx) {
 
 void vp9_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
+    vpx_get_worker_interface()->end(&ctx->analysis_worker);
     if (ctx->buf) {
       int i;
 
@@ -65,6 +69,7 @@ struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
     ctx->max_sz = depth;
     ctx->buf = calloc(depth, sizeof(*ctx->buf));
     ctx->next_show_idx = 0;
+    vpx_get_worker_interface()->init(&ctx->analysis_worker);
     if (!ctx->buf) goto bail;
     for (i = 0; i < depth; i++)
       if (vpx_alloc_frame_buffer(
@@ -81,6 +86,88 @@ bail:
   return NULL;
 }
 
+// Computes the average 64x64 SAD of entry against last, sampling the same
+// superblocks as vp9_scene_detection_onepass().
+static int compute_source_stats(void *arg1, void *arg2) {
+  struct lookahead_entry *const entry = (struct lookahead_entry *)arg1;
+  const struct lookahead_entry *const last =
+      (const struct lookahead_entry *)arg2;
+  struct lookahead_source_stats *const stats = &entry->stats;
+  const int num_mi_cols =
+      ALIGN_POWER_OF_TWO(entry->img.y_crop_width, MI_SIZE_LOG2) >> MI_SIZE_LOG2;
+  const int num_mi_rows =
+      ALIGN_POWER_OF_TWO(entry->img.y_crop_height, MI_SIZE_LOG2) >>
+      MI_SIZE_LOG2;
+  const int sb_cols = (num_mi_cols + MI_BLOCK_SIZE - 1) / MI_BLOCK_SIZE;
+  const int sb_rows = (num_mi_rows + MI_BLOCK_SIZE - 1) / MI_BLOCK_SIZE;
+  const uint8_t *src_y = entry->img.y_buffer;
+  const uint8_t *last_src_y = last->img.y_buffer;
+  const int src_ystride = entry->img.y_stride;
+  const int last_src_ystride = last->img.y_stride;
+  uint64_t avg_sad = 0;
+  int num_samples = 0;
+  int num_zero_temp_sad = 0;
+  int sbi_row, sbi_col;
+
+  for (sbi_row = 0; sbi_row < sb_rows; ++sbi_row) {
+    for (sbi_col = 0; sbi_col < sb_cols; ++sbi_col) {
+      // Checker-board pattern, ignore boundary.
+      if (((sbi_row > 0 && sbi_col > 0) &&
+           (sbi_row < sb_rows - 1 && sbi_col < sb_cols - 1) &&
+           ((sbi_row % 2 == 0 && sbi_col % 2 == 0) ||
+            (sbi_row % 2 != 0 && sbi_col % 2 != 0)))) {
+        const unsigned int tmp_sad =
+            vpx_sad64x64(src_y, src_ystride, last_src_y, last_src_ystride);
+        avg_sad += tmp_sad;
+        num_samples++;
+        if (tmp_sad == 0) num_zero_temp_sad++;
+      }
+      src_y += 64;
+      last_src_y += 64;
+    }
+    src_y += (src_ystride << 6) - (sb_cols << 6);
+    last_src_y += (last_src_ystride << 6) - (sb_cols << 6);
+  }
+  if (num_samples > 0) avg_sad = avg_sad / num_samples;
+
+  stats->sb_cols = sb_cols;
+  stats->sb_rows = sb_rows;
+  stats->avg_sad = avg_sad;
+  stats->num_samples = num_samples;
+  stats->num_zero_temp_sad = num_zero_temp_sad;
+  stats->last_show_idx = last->show_idx;
+  return 1;
+}
+
+void vp9_lookahead_set_analysis(struct lookahead_ctx *ctx, int enable) {
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+
+  if (enable == ctx->analysis_enabled) return;
+  winterface->sync(&ctx->analysis_worker);
+  // Fall back to no analysis if the thread cannot be created.
+  ctx->analysis_enabled = enable && winterface->reset(&ctx->analysis_worker);
+}
+
+const struct lookahead_source_stats *vp9_lookahead_get_source_stats(
+    struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
+    const YV12_BUFFER_CONFIG *last_src) {
+  const struct lookahead_entry *entry = NULL;
+  const struct lookahead_entry *last = NULL;
+  int i;
+
+  if (!ctx->analysis_enabled) return NULL;
+  vpx_get_worker_interface()->sync(&ctx->analysis_worker);
+
+  for (i = 0; i < ctx->max_sz; ++i) {
+    if (&ctx->buf[i].img == src) entry = &ctx->buf[i];
+    if (&ctx->buf[i].img == last_src) last = &ctx->buf[i];
+  }
+  if (entry == NULL || last == NULL ||
+      entry->stats.last_show_idx != last->show_idx)
+    return NULL;
+  return &entry->stats;
+}
+
 #define USE_PARTIAL_COPY 0
 int vp9_lookahead_full(const struct lookahead_ctx *ctx) {
   return ctx->sz + 1 + MAX_PRE_FRAMES > ctx->max_sz;
@@ -94,6 +181,7 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
                        vpx_enc_frame_flags_t flags) {
   struct lookahead_entry *buf;
+  struct lookahead_entry *last = NULL;
 #if USE_PARTIAL_COPY
   int row, col, active_end;
   int mb_rows = (src->y_height + 15) >> 4;
@@ -112,6 +200,13 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
 #endif
 
   if (vp9_lookahead_full(ctx)) return 1;
+  if (ctx->analysis_enabled) {
+    // The analysis of the previous frame may still read the buffer that is
+    // about to be overwritten.
+    vpx_get_worker_interface()->sync(&ctx->analysis_worker);
+    if (ctx->next_show_idx > 0)
+      last = ctx->buf + (ctx->write_idx ? ctx->write_idx : ctx->max_sz) - 1;
+  }
   ctx->sz++;
   buf = pop(ctx, &ctx->write_idx);
 
@@ -194,7 +289,17 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
   buf->ts_end = ts_end;
   buf->flags = flags;
   buf->show_idx = ctx->next_show_idx;
+  buf->stats.last_show_idx = -1;
   ++ctx->next_show_idx;
+
+  if (last != NULL && !(buf->img.flags & YV12_FLAG_HIGHBITDEPTH) &&
+      last->img.y_crop_width == width && last->img.y_crop_height == height) {
+    VPxWorker *const worker = &ctx->analysis_worker;
+    worker->hook = compute_source_stats;
+    worker->data1 = buf;
+    worker->data2 = last;
+    vpx_get_worker_interface()->launch(worker);
+  }
   return 0;
 }
 
@@ -202,6 +307,10 @@ struct lookahead_entry *vp9_lookahead_pop(struct lookahead_ctx *ctx,
                                           int drain) {
   struct lookahead_entry *buf = NULL;
 
+  // The popped frame may be modified by the encoder, so make sure the
+  // analysis stage is done reading it.
+  if (ctx && ctx->analysis_enabled)
+    vpx_get_worker_interface()->sync(&ctx->analysis_worker);
   if (ctx && ctx->sz && (drain || ctx->sz == ctx->max_sz - MAX_PRE_FRAMES)) {
     buf = pop(ctx, &ctx->read_idx);
     ctx->sz--;
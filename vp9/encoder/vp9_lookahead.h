@@ -14,6 +14,7 @@
 #include "vpx_scale/yv12config.h"
 #include "vpx/vpx_encoder.h"
 #include "vpx/vpx_integer.h"
+#include "vpx_util/vpx_thread.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,12 +22,25 @@ extern "C" {
 
 #define MAX_LAG_BUFFERS 25
 
+// Temporal statistics of a source frame relative to the frame pushed before
+// it, sampled over 64x64 blocks in the checker-board pattern used by
+// vp9_scene_detection_onepass().
+struct lookahead_source_stats {
+  int last_show_idx; /* show_idx of the reference frame, -1 if not computed */
+  int sb_cols;
+  int sb_rows;
+  uint64_t avg_sad;
+  int num_samples;
+  int num_zero_temp_sad;
+};
+
 struct lookahead_entry {
   YV12_BUFFER_CONFIG img;
   int64_t ts_start;
   int64_t ts_end;
   int show_idx; /*The show_idx of this frame*/
   vpx_enc_frame_flags_t flags;
+  struct lookahead_source_stats stats;
 };
 
 // The max of past frames we want to keep in the queue.
@@ -40,6 +54,8 @@ struct lookahead_ctx {
   int next_show_idx; /* The show_idx that will be assigned to the next frame
                         being pushed in the queue*/
   struct lookahead_entry *buf; /* Buffer list */
+  int analysis_enabled;        /* Compute source stats on push */
+  VPxWorker analysis_worker;   /* Thread computing the source stats */
 };
 
 /**\brief Initializes the lookahead stage
@@ -114,6 +130,29 @@ struct lookahead_entry *vp9_lookahead_pop(struct lookahead_ctx *ctx, int drain);
 struct lookahead_entry *vp9_lookahead_peek(struct lookahead_ctx *ctx,
                                            int index);
 
+/**\brief Enable or disable the source analysis stage
+ *
+ * When enabled, the temporal statistics of each frame pushed with
+ * vp9_lookahead_push() are computed on a dedicated thread, overlapping with
+ * the encoding of earlier frames.
+ *
+ * \param[in] ctx       Pointer to the lookahead context
+ * \param[in] enable    Flag to enable the analysis stage
+ */
+void vp9_lookahead_set_analysis(struct lookahead_ctx *ctx, int enable);
+
+/**\brief Get the precomputed temporal statistics of a source frame
+ *
+ * \param[in] ctx       Pointer to the lookahead context
+ * \param[in] src       Frame buffer owned by the lookahead queue
+ * \param[in] last_src  Frame buffer the statistics must be relative to
+ *
+ * \retval NULL, if no statistics were computed for this pair of frames
+ */
+const struct lookahead_source_stats *vp9_lookahead_get_source_stats(
+    struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
+    const YV12_BUFFER_CONFIG *last_src);
+
 /**\brief Get the number of frames currently in the lookahead queue
  *
  * \param[in] ctx       Pointer to the lookahead context
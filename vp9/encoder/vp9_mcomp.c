@@ -620,12 +620,102 @@ static const MV search_step_table[12] = {
 };
 /* clang-format on */
 
+#define SUBPEL_COLUMNS 3
+#define SUBPEL_COLUMN_STRIDE 64
+
+// Reference rows filtered horizontally at a sub pixel column. The candidates
+// of a search step in the same column share them and only filter vertically.
+typedef struct {
+  int col;   // In 1/8 pel, INT_MAX if unused.
+  int row0;  // First full pel row held.
+  int rows;
+  // Rows for a 64 high block, the filter taps and one extra row on each side,
+  // rounded up for the kernels that filter 4 rows at a time.
+  DECLARE_ALIGNED(16, uint8_t, buf[SUBPEL_COLUMN_STRIDE * (64 + 16)]);
+} SUBPEL_COLUMN;
+
+typedef struct {
+  SUBPEL_COLUMN cols[SUBPEL_COLUMNS];
+  int next;
+} SUBPEL_COLUMN_CACHE;
+
+static void init_subpel_column_cache(SUBPEL_COLUMN_CACHE *cache) {
+  int i;
+  for (i = 0; i < SUBPEL_COLUMNS; ++i) cache->cols[i].col = INT_MAX;
+  cache->next = 0;
+}
+
+// Returns the horizontally filtered reference for the block at (r, c), in
+// 1/8 pel, starting SUBPEL_TAPS / 2 - 1 rows above it.
+static const uint8_t *get_subpel_column(SUBPEL_COLUMN_CACHE *cache,
+                                        const uint8_t *y, int y_stride,
+                                        const InterpKernel *kernel, int r,
+                                        int c, int w, int h, int *stride) {
+  const int row = (r >> 3) - (SUBPEL_TAPS / 2 - 1);
+  SUBPEL_COLUMN *col;
+  int i;
+
+  if (!sp(c)) {
+    *stride = y_stride;
+    return y + row * y_stride + (c >> 3);
+  }
+
+  *stride = SUBPEL_COLUMN_STRIDE;
+  for (i = 0; i < SUBPEL_COLUMNS; ++i) {
+    col = &cache->cols[i];
+    if (col->col == c && row >= col->row0 &&
+        row + h + SUBPEL_TAPS - 1 <= col->row0 + col->rows)
+      return col->buf + (row - col->row0) * SUBPEL_COLUMN_STRIDE;
+  }
+
+  // Also filter a row above and below for the neighbours of (r, c).
+  col = &cache->cols[cache->next];
+  cache->next = (cache->next + 1) % SUBPEL_COLUMNS;
+  col->col = c;
+  col->row0 = row - 1;
+  col->rows = h + SUBPEL_TAPS + 1;
+  vpx_convolve8_horiz(y + col->row0 * y_stride + (c >> 3), y_stride, col->buf,
+                      SUBPEL_COLUMN_STRIDE, kernel, sp(c) * 2, 16, 0, 16, w,
+                      col->rows);
+  return col->buf + SUBPEL_COLUMN_STRIDE;
+}
+
+// Same as building the prediction with vp9_build_inter_predictor(), but the
+// horizontal filtering comes from the cache.
+static int cached_sub_pel_search(const MV *this_mv, const InterpKernel *kernel,
+                                 const vp9_variance_fn_ptr_t *vfp,
+                                 const uint8_t *const src_address,
+                                 const int src_stride,
+                                 const uint8_t *const pre_address, int y_stride,
+                                 const uint8_t *second_pred, int w, int h,
+                                 SUBPEL_COLUMN_CACHE *cache, uint32_t *sse) {
+  DECLARE_ALIGNED(16, uint8_t, pred[64 * 64]);
+  const uint8_t *filtered;
+  int filtered_stride;
+  const uint8_t *const col = get_subpel_column(
+      cache, pre_address, y_stride, kernel, this_mv->row, this_mv->col, w, h,
+      &filtered_stride);
+  filtered = col + (SUBPEL_TAPS / 2 - 1) * filtered_stride;
+  if (sp(this_mv->row)) {
+    vpx_convolve8_vert(filtered, filtered_stride, pred, w, kernel, 0, 16,
+                       sp(this_mv->row) * 2, 16, w, h);
+    filtered = pred;
+    filtered_stride = w;
+  }
+  if (second_pred != NULL) {
+    DECLARE_ALIGNED(16, uint8_t, comp_pred[64 * 64]);
+    vpx_comp_avg_pred(comp_pred, second_pred, w, h, filtered, filtered_stride);
+    return vfp->vf(comp_pred, w, src_address, src_stride, sse);
+  }
+  return vfp->vf(filtered, filtered_stride, src_address, src_stride, sse);
+}
+
 static int accurate_sub_pel_search(
     const MACROBLOCKD *xd, const MV *this_mv, const struct scale_factors *sf,
     const InterpKernel *kernel, const vp9_variance_fn_ptr_t *vfp,
     const uint8_t *const src_address, const int src_stride,
     const uint8_t *const pre_address, int y_stride, const uint8_t *second_pred,
-    int w, int h, uint32_t *sse) {
+    int w, int h, SUBPEL_COLUMN_CACHE *cache, uint32_t *sse) {
 #if CONFIG_VP9_HIGHBITDEPTH
   uint64_t besterr;
   assert(sf->x_step_q4 == 16 && sf->y_step_q4 == 16);
@@ -646,36 +736,20 @@ static int accurate_sub_pel_search(
           vfp->vf(CONVERT_TO_BYTEPTR(pred16), w, src_address, src_stride, sse);
     }
   } else {
-    DECLARE_ALIGNED(16, uint8_t, pred[64 * 64]);
-    vp9_build_inter_predictor(pre_address, y_stride, pred, w, this_mv, sf, w, h,
-                              0, kernel, MV_PRECISION_Q3, 0, 0);
-    if (second_pred != NULL) {
-      DECLARE_ALIGNED(16, uint8_t, comp_pred[64 * 64]);
-      vpx_comp_avg_pred(comp_pred, second_pred, w, h, pred, w);
-      besterr = vfp->vf(comp_pred, w, src_address, src_stride, sse);
-    } else {
-      besterr = vfp->vf(pred, w, src_address, src_stride, sse);
-    }
+    besterr = cached_sub_pel_search(this_mv, kernel, vfp, src_address,
+                                    src_stride, pre_address, y_stride,
+                                    second_pred, w, h, cache, sse);
   }
   if (besterr >= UINT_MAX) return UINT_MAX;
   return (int)besterr;
 #else
-  int besterr;
-  DECLARE_ALIGNED(16, uint8_t, pred[64 * 64]);
   assert(sf->x_step_q4 == 16 && sf->y_step_q4 == 16);
   assert(w != 0 && h != 0);
   (void)xd;
-
-  vp9_build_inter_predictor(pre_address, y_stride, pred, w, this_mv, sf, w, h,
-                            0, kernel, MV_PRECISION_Q3, 0, 0);
-  if (second_pred != NULL) {
-    DECLARE_ALIGNED(16, uint8_t, comp_pred[64 * 64]);
-    vpx_comp_avg_pred(comp_pred, second_pred, w, h, pred, w);
-    besterr = vfp->vf(comp_pred, w, src_address, src_stride, sse);
-  } else {
-    besterr = vfp->vf(pred, w, src_address, src_stride, sse);
-  }
-  return besterr;
+  (void)sf;
+  return cached_sub_pel_search(this_mv, kernel, vfp, src_address, src_stride,
+                               pre_address, y_stride, second_pred, w, h, cache,
+                               sse);
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 }
 
@@ -690,7 +764,7 @@ static int accurate_sub_pel_search(
       const MV ref_mv = { rr, rc };                                           \
       thismse = accurate_sub_pel_search(xd, &mv, x->me_sf, kernel, vfp, z,    \
                                         src_stride, y, y_stride, second_pred, \
-                                        w, h, &sse);                          \
+                                        w, h, &cache, &sse);                  \
       tmpmse = thismse;                                                       \
       tmpmse += mv_err_cost(&mv, &ref_mv, mvjcost, mvcost, error_per_bit);    \
       if (tmpmse >= INT_MAX) {                                                \
@@ -715,7 +789,7 @@ static int accurate_sub_pel_search(
       const MV ref_mv = { rr, rc };                                           \
       thismse = accurate_sub_pel_search(xd, &mv, x->me_sf, kernel, vfp, z,    \
                                         src_stride, y, y_stride, second_pred, \
-                                        w, h, &sse);                          \
+                                        w, h, &cache, &sse);                  \
       if ((v = mv_err_cost(&mv, &ref_mv, mvjcost, mvcost, error_per_bit) +    \
                thismse) < besterr) {                                          \
         besterr = v;                                                          \
@@ -763,6 +837,7 @@ uint32_t vp9_find_best_sub_pixel_tree(
   unsigned int cost_array[5];
   int kr, kc;
   MvLimits subpel_mv_limits;
+  SUBPEL_COLUMN_CACHE cache;
 
   // TODO(yunqing): need to add 4-tap filter optimization to speed up the
   // encoder.
@@ -793,6 +868,8 @@ uint32_t vp9_find_best_sub_pixel_tree(
 
   (void)cost_list;  // to silence compiler warning
 
+  if (use_accurate_subpel_search) init_subpel_column_cache(&cache);
+
   for (iter = 0; iter < round; ++iter) {
     // Check vertical and horizontal sub-pixel positions.
     for (idx = 0; idx < 4; ++idx) {
@@ -804,9 +881,9 @@ uint32_t vp9_find_best_sub_pixel_tree(
         this_mv.col = tc;
 
         if (use_accurate_subpel_search) {
-          thismse = accurate_sub_pel_search(xd, &this_mv, x->me_sf, kernel, vfp,
-                                            src_address, src_stride, y,
-                                            y_stride, second_pred, w, h, &sse);
+          thismse = accurate_sub_pel_search(
+              xd, &this_mv, x->me_sf, kernel, vfp, src_address, src_stride, y,
+              y_stride, second_pred, w, h, &cache, &sse);
         } else {
           const uint8_t *const pre_address =
               y + (tr >> 3) * y_stride + (tc >> 3);
@@ -843,7 +920,7 @@ uint32_t vp9_find_best_sub_pixel_tree(
       if (use_accurate_subpel_search) {
         thismse = accurate_sub_pel_search(xd, &this_mv, x->me_sf, kernel, vfp,
                                           src_address, src_stride, y, y_stride,
-                                          second_pred, w, h, &sse);
+                                          second_pred, w, h, &cache, &sse);
       } else {
         const uint8_t *const pre_address = y + (tr >> 3) * y_stride + (tc >> 3);
         if (second_pred == NULL)
@@ -948,11 +1025,6 @@ static INLINE int check_bounds(const MvLimits *mv_limits, int row, int col,
          ((col + range) <= mv_limits->col_max);
 }
 
-static INLINE int is_mv_in(const MvLimits *mv_limits, const MV *mv) {
-  return (mv->col >= mv_limits->col_min) && (mv->col <= mv_limits->col_max) &&
-         (mv->row >= mv_limits->row_min) && (mv->row <= mv_limits->row_max);
-}
-
 #define CHECK_BETTER                                                      \
   {                                                                       \
     if (thissad < bestsad) {                                              \
@@ -2210,13 +2282,15 @@ int vp9_diamond_search_sad_c(const MACROBLOCK *x, const search_site_config *cfg,
   return bestsad;
 }
 
-static int vector_match(int16_t *ref, int16_t *src, int bwl) {
+// Returns the offset in [0, range] of the best match of the 1-D src projection
+// in the ref projection, which holds range + (4 << bwl) entries.
+static int vector_match_range(const int16_t *ref, const int16_t *src, int bwl,
+                              int range) {
   int best_sad = INT_MAX;
   int this_sad;
   int d;
   int center, offset = 0;
-  int bw = 4 << bwl;  // redundant variable, to be changed in the experiments.
-  for (d = 0; d <= bw; d += 16) {
+  for (d = 0; d <= range; d += 16) {
     this_sad = vpx_vector_var(&ref[d], src, bwl);
     if (this_sad < best_sad) {
       best_sad = this_sad;
@@ -2228,7 +2302,7 @@ static int vector_match(int16_t *ref, int16_t *src, int bwl) {
   for (d = -8; d <= 8; d += 16) {
     int this_pos = offset + d;
     // check limit
-    if (this_pos < 0 || this_pos > bw) continue;
+    if (this_pos < 0 || this_pos > range) continue;
     this_sad = vpx_vector_var(&ref[this_pos], src, bwl);
     if (this_sad < best_sad) {
       best_sad = this_sad;
@@ -2240,7 +2314,7 @@ static int vector_match(int16_t *ref, int16_t *src, int bwl) {
   for (d = -4; d <= 4; d += 8) {
     int this_pos = offset + d;
     // check limit
-    if (this_pos < 0 || this_pos > bw) continue;
+    if (this_pos < 0 || this_pos > range) continue;
     this_sad = vpx_vector_var(&ref[this_pos], src, bwl);
     if (this_sad < best_sad) {
       best_sad = this_sad;
@@ -2252,7 +2326,7 @@ static int vector_match(int16_t *ref, int16_t *src, int bwl) {
   for (d = -2; d <= 2; d += 4) {
     int this_pos = offset + d;
     // check limit
-    if (this_pos < 0 || this_pos > bw) continue;
+    if (this_pos < 0 || this_pos > range) continue;
     this_sad = vpx_vector_var(&ref[this_pos], src, bwl);
     if (this_sad < best_sad) {
       best_sad = this_sad;
@@ -2264,7 +2338,7 @@ static int vector_match(int16_t *ref, int16_t *src, int bwl) {
   for (d = -1; d <= 1; d += 2) {
     int this_pos = offset + d;
     // check limit
-    if (this_pos < 0 || this_pos > bw) continue;
+    if (this_pos < 0 || this_pos > range) continue;
     this_sad = vpx_vector_var(&ref[this_pos], src, bwl);
     if (this_sad < best_sad) {
       best_sad = this_sad;
@@ -2272,7 +2346,12 @@ static int vector_match(int16_t *ref, int16_t *src, int bwl) {
     }
   }
 
-  return (center - (bw >> 1));
+  return center;
+}
+
+static int vector_match(int16_t *ref, int16_t *src, int bwl) {
+  const int bw = 4 << bwl;
+  return vector_match_range(ref, src, bwl, bw) - (bw >> 1);
 }
 
 static const MV search_pos[4] = {
@@ -2833,6 +2912,99 @@ int vp9_refining_search_8p_c(const MACROBLOCK *x, MV *ref_mv, int error_per_bit,
   return best_sad;
 }
 
+// Runs a full pixel search from the 1-D integral projections of the block:
+// the row and column sums of the source are matched against those of the
+// reference over +/- half the block size around mvp_full, and the best match
+// is refined by a 1-away search. Blocks narrower or shorter than 16 pixels
+// and high bit depth frames fall back to the n-step search.
+static int projection_search(const VP9_COMP *const cpi,
+                             const MACROBLOCK *const x, BLOCK_SIZE bsize,
+                             MV *mvp_full, int step_param, int sadpb,
+                             int *cost_list,
+                             const vp9_variance_fn_ptr_t *fn_ptr,
+                             const MV *ref_mv, MV *dst_mv) {
+  const MvLimits *const mv_limits = &x->mv_limits;
+  const struct buf_2d *const what = &x->plane[0].src;
+  const struct buf_2d *const in_what = &x->e_mbd.plane[0].pre[0];
+  const MV fcenter_mv = { ref_mv->row >> 3, ref_mv->col >> 3 };
+  const int bwl = b_width_log2_lookup[bsize];
+  const int bhl = b_height_log2_lookup[bsize];
+  const int bw = 4 << bwl;
+  const int bh = 4 << bhl;
+  const int norm_factor = 3 + (bw >> 5);
+  DECLARE_ALIGNED(16, int16_t, hbuf[128]);
+  DECLARE_ALIGNED(16, int16_t, vbuf[128]);
+  DECLARE_ALIGNED(16, int16_t, src_hbuf[64]);
+  DECLARE_ALIGNED(16, int16_t, src_vbuf[64]);
+  const uint8_t *ref_buf;
+  MV center, proj_mv;
+  int col_min, col_max, row_min, row_max;
+  unsigned int center_sad, proj_sad;
+  int idx, bestsme;
+  int use_projection = bw >= 16 && bh >= 16;
+
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (x->e_mbd.cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) use_projection = 0;
+#endif
+  if (!use_projection) {
+    return full_pixel_diamond(cpi, x, mvp_full, step_param, sadpb,
+                              MAX_MVSEARCH_STEPS - 1 - step_param, 1,
+                              cost_list, fn_ptr, ref_mv, dst_mv);
+  }
+
+  center = *mvp_full;
+  clamp_mv(&center, mv_limits->col_min, mv_limits->col_max,
+           mv_limits->row_min, mv_limits->row_max);
+  col_min = VPXMAX(center.col - (bw >> 1), mv_limits->col_min);
+  col_max = VPXMIN(center.col + (bw >> 1), mv_limits->col_max);
+  row_min = VPXMAX(center.row - (bh >> 1), mv_limits->row_min);
+  row_max = VPXMIN(center.row + (bh >> 1), mv_limits->row_max);
+
+  // Set up the 1-D reference sets. The column sums are taken over the rows of
+  // center and the row sums over its columns.
+  ref_buf = in_what->buf + center.row * in_what->stride + col_min;
+  for (idx = 0; idx < col_max - col_min + bw; idx += 16)
+    vpx_int_pro_row(&hbuf[idx], ref_buf + idx, in_what->stride, bh);
+
+  ref_buf = in_what->buf + row_min * in_what->stride + center.col;
+  for (idx = 0; idx < row_max - row_min + bh; ++idx) {
+    vbuf[idx] = vpx_int_pro_col(ref_buf, bw) >> norm_factor;
+    ref_buf += in_what->stride;
+  }
+
+  // Set up the 1-D source sets.
+  for (idx = 0; idx < bw; idx += 16)
+    vpx_int_pro_row(&src_hbuf[idx], what->buf + idx, what->stride, bh);
+
+  for (idx = 0; idx < bh; ++idx) {
+    src_vbuf[idx] =
+        vpx_int_pro_col(what->buf + idx * what->stride, bw) >> norm_factor;
+  }
+
+  proj_mv.col =
+      col_min + vector_match_range(hbuf, src_hbuf, bwl, col_max - col_min);
+  proj_mv.row =
+      row_min + vector_match_range(vbuf, src_vbuf, bhl, row_max - row_min);
+
+  // The projections ignore how the rows and columns line up, so keep the
+  // start point if it still matches better.
+  center_sad = fn_ptr->sdf(what->buf, what->stride,
+                           get_buf_from_mv(in_what, &center), in_what->stride) +
+               mvsad_err_cost(x, &center, &fcenter_mv, sadpb);
+  proj_sad = fn_ptr->sdf(what->buf, what->stride,
+                         get_buf_from_mv(in_what, &proj_mv), in_what->stride) +
+             mvsad_err_cost(x, &proj_mv, &fcenter_mv, sadpb);
+  *dst_mv = proj_sad < center_sad ? proj_mv : center;
+
+  vp9_refining_search_sad(x, dst_mv, sadpb, 8, fn_ptr, ref_mv);
+  bestsme = vp9_get_mvpred_var(x, dst_mv, ref_mv, fn_ptr, 1);
+
+  if (cost_list) {
+    calc_int_cost_list(x, ref_mv, sadpb, fn_ptr, dst_mv, cost_list);
+  }
+  return bestsme;
+}
+
 int vp9_full_pixel_search(const VP9_COMP *const cpi, const MACROBLOCK *const x,
                           BLOCK_SIZE bsize, MV *mvp_full, int step_param,
                           int search_method, int error_per_bit, int *cost_list,
@@ -2878,6 +3050,10 @@ int vp9_full_pixel_search(const VP9_COMP *const cpi, const MACROBLOCK *const x,
                                MAX_MVSEARCH_STEPS - 1 - step_param, 1,
                                cost_list, fn_ptr, ref_mv, tmp_mv);
       break;
+    case PROJECTION:
+      var = projection_search(cpi, x, bsize, mvp_full, step_param,
+                              error_per_bit, cost_list, fn_ptr, ref_mv, tmp_mv);
+      break;
     default: assert(0 && "Unknown search method");
   }
 
@@ -2905,7 +3081,8 @@ int vp9_full_pixel_search(const VP9_COMP *const cpi, const MACROBLOCK *const x,
     }
   }
 
-  if (method != NSTEP && method != MESH && rd && var < var_max)
+  if (method != NSTEP && method != MESH && method != PROJECTION && rd &&
+      var < var_max)
     var = vp9_get_mvpred_var(x, tmp_mv, ref_mv, fn_ptr, 1);
 
   return var;
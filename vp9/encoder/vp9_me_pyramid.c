@@ -0,0 +1,410 @@
+/*
+ *  Copyright (c) 2023 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/encoder/vp9_encoder.h"
+#include "vp9/encoder/vp9_me_pyramid.h"
+#include "vp9/encoder/vp9_resize.h"
+
+// Exhaustive search range at the coarsest level, and around the best
+// candidate at the finer levels, in pixels of the level.
+#define COARSE_SEARCH_RANGE 8
+#define REFINE_SEARCH_RANGE 1
+// The smallest block matched at any level.
+#define MIN_WINDOW_SIZE 8
+// Search range around the reversed vector of an exported block whose error
+// per pixel is above EXPORTED_MAX_ERR_PER_PEL, in full pixels.
+#define EXPORTED_SEARCH_RANGE 4
+#define EXPORTED_MAX_ERR_PER_PEL 64
+
+void vp9_me_pyramid_reset(ME_PYRAMID *pyramid) {
+  int i;
+  for (i = 0; i < pyramid->num_fields; ++i) pyramid->fields[i].mf.ready = 0;
+  for (i = 0; i < pyramid->num_exported; ++i)
+    pyramid->exported[i].mf.ready = 0;
+  pyramid->num_frames = 0;
+  pyramid->num_fields = 0;
+  pyramid->num_exported = 0;
+}
+
+void vp9_me_pyramid_free(ME_PYRAMID *pyramid) {
+  int i;
+  for (i = 0; i < ME_PYRAMID_MAX_FRAMES; ++i) {
+    vpx_free(pyramid->frames[i].alloc);
+    pyramid->frames[i].alloc = NULL;
+    pyramid->frames[i].alloc_size = 0;
+  }
+  for (i = 0; i < ME_PYRAMID_MAX_FIELDS; ++i)
+    vp9_free_motion_field(&pyramid->fields[i].mf);
+  for (i = 0; i < ME_PYRAMID_MAX_EXPORTED_FIELDS; ++i) {
+    vp9_free_motion_field(&pyramid->exported[i].mf);
+    vpx_free(pyramid->exported[i].err);
+    pyramid->exported[i].err = NULL;
+  }
+  pyramid->num_frames = 0;
+  pyramid->num_fields = 0;
+  pyramid->num_exported = 0;
+}
+
+// Sets up the motion field of field for a frame of the given size, keeping
+// its memory if the grid is unchanged. Returns 0 if the grid is unchanged.
+static int alloc_field(VP9_COMMON *cm, ME_PYRAMID_FIELD *field,
+                       const YV12_BUFFER_CONFIG *cur, BLOCK_SIZE bsize) {
+  const int block_size = 4 << b_width_log2_lookup[bsize];
+  const int block_rows = (cur->y_crop_height + block_size - 1) / block_size;
+  const int block_cols = (cur->y_crop_width + block_size - 1) / block_size;
+  if (field->mf.mf != NULL && field->mf.bsize == bsize &&
+      field->mf.block_rows == block_rows && field->mf.block_cols == block_cols)
+    return 0;
+  vp9_free_motion_field(&field->mf);
+  if (vp9_alloc_motion_field(&field->mf, bsize, block_rows, block_cols) !=
+      STATUS_OK)
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Failed to allocate motion field");
+  return 1;
+}
+
+static const ME_PYRAMID_FRAME *get_frame(VP9_COMP *cpi, ME_PYRAMID *pyramid,
+                                         const YV12_BUFFER_CONFIG *src) {
+  ME_PYRAMID_FRAME *frame;
+  int size = 0;
+  int level, i;
+
+  for (i = 0; i < pyramid->num_frames; ++i) {
+    if (pyramid->frames[i].src == src) return &pyramid->frames[i];
+  }
+  if (pyramid->num_frames == ME_PYRAMID_MAX_FRAMES) return NULL;
+
+  frame = &pyramid->frames[pyramid->num_frames];
+  frame->width[0] = src->y_crop_width;
+  frame->height[0] = src->y_crop_height;
+  frame->stride[0] = src->y_stride;
+  frame->buf[0] = src->y_buffer;
+  for (level = 1; level <= ME_PYRAMID_LEVELS; ++level) {
+    const int width = (frame->width[level - 1] + 1) >> 1;
+    const int height = (frame->height[level - 1] + 1) >> 1;
+    if (width < MIN_WINDOW_SIZE || height < MIN_WINDOW_SIZE) break;
+    frame->width[level] = width;
+    frame->height[level] = height;
+    frame->stride[level] = width;
+    size += width * height;
+  }
+  frame->num_levels = level;
+
+  if (size > frame->alloc_size) {
+    vpx_free(frame->alloc);
+    frame->alloc_size = 0;
+    CHECK_MEM_ERROR(&cpi->common, frame->alloc, vpx_malloc(size));
+    frame->alloc_size = size;
+  }
+
+  size = 0;
+  for (level = 1; level < frame->num_levels; ++level) {
+    uint8_t *const buf = frame->alloc + size;
+    vp9_resize_plane(frame->buf[level - 1], frame->height[level - 1],
+                     frame->width[level - 1], frame->stride[level - 1], buf,
+                     frame->height[level], frame->width[level],
+                     frame->stride[level]);
+    frame->buf[level] = buf;
+    size += frame->width[level] * frame->height[level];
+  }
+
+  frame->src = src;
+  ++pyramid->num_frames;
+  return frame;
+}
+
+static BLOCK_SIZE window_bsize(int size) {
+  switch (size) {
+    case 8: return BLOCK_8X8;
+    case 16: return BLOCK_16X16;
+    case 32: return BLOCK_32X32;
+    default: assert(size == 64); return BLOCK_64X64;
+  }
+}
+
+typedef struct {
+  const uint8_t *cur;
+  const uint8_t *ref;
+  int cur_stride;
+  int ref_stride;
+  // Motion vector limits that keep the window inside the frame.
+  int row_min, row_max, col_min, col_max;
+  vpx_sad_fn_t sdf;
+} MATCH_WINDOW;
+
+static int window_sad(const MATCH_WINDOW *w, const MV *mv) {
+  if (mv->row < w->row_min || mv->row > w->row_max || mv->col < w->col_min ||
+      mv->col > w->col_max)
+    return INT_MAX;
+  return (int)w->sdf(w->cur, w->cur_stride,
+                     w->ref + mv->row * w->ref_stride + mv->col, w->ref_stride);
+}
+
+static void check_candidate(const MATCH_WINDOW *w, const MV *mv, MV *best_mv,
+                            int *best_sad) {
+  const int sad = window_sad(w, mv);
+  if (sad < *best_sad) {
+    *best_sad = sad;
+    *best_mv = *mv;
+  }
+}
+
+// Exhaustive search within range of center. best_mv and best_sad hold the best
+// match found so far on input.
+static void window_search(const MATCH_WINDOW *w, MV center, int range,
+                          MV *best_mv, int *best_sad) {
+  MV mv;
+  for (mv.row = center.row - range; mv.row <= center.row + range; ++mv.row) {
+    for (mv.col = center.col - range; mv.col <= center.col + range;
+         ++mv.col) {
+      check_candidate(w, &mv, best_mv, best_sad);
+    }
+  }
+}
+
+static void setup_window(const VP9_COMP *cpi, const ME_PYRAMID_FRAME *cur,
+                         const ME_PYRAMID_FRAME *ref, int level, int size,
+                         int x, int y, MATCH_WINDOW *w) {
+  const int width = cur->width[level];
+  const int height = cur->height[level];
+  x = VPXMIN(x, width - size);
+  y = VPXMIN(y, height - size);
+  w->cur_stride = cur->stride[level];
+  w->ref_stride = ref->stride[level];
+  w->cur = cur->buf[level] + y * w->cur_stride + x;
+  w->ref = ref->buf[level] + y * w->ref_stride + x;
+  w->row_min = -y;
+  w->row_max = height - size - y;
+  w->col_min = -x;
+  w->col_max = width - size - x;
+  w->sdf = cpi->fn_ptr[window_bsize(size)].sdf;
+}
+
+static const int neighbors[5][2] = {
+  { 0, 0 }, { -1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 0 }
+};
+
+static void finish_field(MotionField *mf, const MV *mvs) {
+  int i;
+  for (i = 0; i < mf->block_num; ++i) {
+    mf->mf[i].as_mv.row = mvs[i].row * 8;
+    mf->mf[i].as_mv.col = mvs[i].col * 8;
+    mf->set_mv[i] = 1;
+  }
+  mf->ready = 1;
+}
+
+static void estimate_field(VP9_COMP *cpi, const ME_PYRAMID_FRAME *cur,
+                           const ME_PYRAMID_FRAME *ref, int coarsest_level,
+                           int block_size, MotionField *mf, MV *mvs) {
+  const int rows = mf->block_rows;
+  const int cols = mf->block_cols;
+  int level, r, c, i;
+
+  for (level = coarsest_level; level >= 0; --level) {
+    const int size = VPXMAX(block_size >> level, MIN_WINDOW_SIZE);
+    for (r = 0; r < rows; ++r) {
+      for (c = 0; c < cols; ++c) {
+        MV best_mv = { 0, 0 };
+        int best_sad;
+        MATCH_WINDOW w;
+        setup_window(cpi, cur, ref, level, size, (c * block_size) >> level,
+                     (r * block_size) >> level, &w);
+
+        best_sad = window_sad(&w, &best_mv);
+        if (level == coarsest_level) {
+          window_search(&w, best_mv, COARSE_SEARCH_RANGE, &best_mv, &best_sad);
+        } else {
+          // Start from the best of the upscaled vectors of this block and its
+          // neighbors at the coarser level, which were stored in mvs.
+          for (i = 0; i < 5; ++i) {
+            const int nr = r + neighbors[i][0];
+            const int nc = c + neighbors[i][1];
+            MV mv;
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+            mv.row = mvs[nr * cols + nc].row * 2;
+            mv.col = mvs[nr * cols + nc].col * 2;
+            check_candidate(&w, &mv, &best_mv, &best_sad);
+          }
+          window_search(&w, best_mv, REFINE_SEARCH_RANGE, &best_mv, &best_sad);
+        }
+        // The neighbors still need the coarser level vectors in mvs, so the
+        // new ones are kept in the field until the level is complete.
+        mf->mf[r * cols + c].as_mv = best_mv;
+      }
+    }
+
+    for (i = 0; i < rows * cols; ++i) mvs[i] = mf->mf[i].as_mv;
+  }
+
+  finish_field(mf, mvs);
+}
+
+static int round_mv_comp_to_full(int v) {
+  return (v < 0 ? v - 4 : v + 4) / 8;
+}
+
+// Estimates the field at full resolution only, starting from the reversed
+// vectors of the exported field of ref relative to cur.
+static void estimate_field_from_exported(VP9_COMP *cpi,
+                                         const ME_PYRAMID_FRAME *cur,
+                                         const ME_PYRAMID_FRAME *ref,
+                                         const ME_PYRAMID_FIELD *exported,
+                                         int block_size, MotionField *mf,
+                                         MV *mvs) {
+  const MotionField *const emf = &exported->mf;
+  const int rows = mf->block_rows;
+  const int cols = mf->block_cols;
+  const uint32_t max_err =
+      EXPORTED_MAX_ERR_PER_PEL * (uint32_t)(block_size * block_size);
+  int r, c, i;
+
+  assert(emf->block_rows == rows && emf->block_cols == cols);
+  for (r = 0; r < rows; ++r) {
+    for (c = 0; c < cols; ++c) {
+      const int idx = r * cols + c;
+      MV best_mv = { 0, 0 };
+      int best_sad;
+      int range = REFINE_SEARCH_RANGE;
+      MATCH_WINDOW w;
+      setup_window(cpi, cur, ref, 0, block_size, c * block_size,
+                   r * block_size, &w);
+
+      best_sad = window_sad(&w, &best_mv);
+      for (i = 0; i < 5; ++i) {
+        const int nr = r + neighbors[i][0];
+        const int nc = c + neighbors[i][1];
+        const int nidx = nr * cols + nc;
+        MV mv;
+        if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+        if (!emf->set_mv[nidx]) continue;
+        mv.row = -round_mv_comp_to_full(emf->mf[nidx].as_mv.row);
+        mv.col = -round_mv_comp_to_full(emf->mf[nidx].as_mv.col);
+        check_candidate(&w, &mv, &best_mv, &best_sad);
+      }
+      if (!emf->set_mv[idx] || exported->err[idx] > max_err)
+        range = EXPORTED_SEARCH_RANGE;
+      window_search(&w, best_mv, range, &best_mv, &best_sad);
+      mvs[idx] = best_mv;
+    }
+  }
+
+  finish_field(mf, mvs);
+}
+
+static const ME_PYRAMID_FIELD *find_exported(const ME_PYRAMID *pyramid,
+                                             const YV12_BUFFER_CONFIG *cur,
+                                             const YV12_BUFFER_CONFIG *ref,
+                                             BLOCK_SIZE bsize) {
+  int i;
+  for (i = 0; i < pyramid->num_exported; ++i) {
+    const ME_PYRAMID_FIELD *const field = &pyramid->exported[i];
+    if (field->cur == cur && field->ref == ref && field->mf.bsize == bsize &&
+        field->mf.ready)
+      return field;
+  }
+  return NULL;
+}
+
+const MotionField *vp9_me_pyramid_get_field(VP9_COMP *cpi,
+                                            const YV12_BUFFER_CONFIG *cur,
+                                            const YV12_BUFFER_CONFIG *ref,
+                                            BLOCK_SIZE bsize) {
+  VP9_COMMON *const cm = &cpi->common;
+  ME_PYRAMID *const pyramid = &cpi->me_pyramid;
+  const int block_size = 4 << b_width_log2_lookup[bsize];
+  const ME_PYRAMID_FRAME *cur_frame, *ref_frame;
+  const ME_PYRAMID_FIELD *exported;
+  ME_PYRAMID_FIELD *field;
+  int coarsest_level;
+  MV *mvs;
+  int i;
+
+  assert(bsize == BLOCK_8X8 || bsize == BLOCK_16X16 || bsize == BLOCK_32X32 ||
+         bsize == BLOCK_64X64);
+#if CONFIG_VP9_HIGHBITDEPTH
+  if ((cur->flags | ref->flags) & YV12_FLAG_HIGHBITDEPTH) return NULL;
+#endif
+  if (cur->y_crop_width != ref->y_crop_width ||
+      cur->y_crop_height != ref->y_crop_height ||
+      cur->y_crop_width < block_size || cur->y_crop_height < block_size)
+    return NULL;
+
+  for (i = 0; i < pyramid->num_fields; ++i) {
+    field = &pyramid->fields[i];
+    if (field->cur == cur && field->ref == ref && field->mf.bsize == bsize)
+      return &field->mf;
+  }
+  if (pyramid->num_fields == ME_PYRAMID_MAX_FIELDS) return NULL;
+
+  exported = find_exported(pyramid, ref, cur, bsize);
+
+  cur_frame = get_frame(cpi, pyramid, cur);
+  ref_frame = get_frame(cpi, pyramid, ref);
+  if (cur_frame == NULL || ref_frame == NULL) return NULL;
+
+  // Use the coarsest level where the matched window fits in the frame.
+  coarsest_level = cur_frame->num_levels - 1;
+  while (coarsest_level > 0) {
+    const int size = VPXMAX(block_size >> coarsest_level, MIN_WINDOW_SIZE);
+    if (cur_frame->width[coarsest_level] >= size &&
+        cur_frame->height[coarsest_level] >= size)
+      break;
+    --coarsest_level;
+  }
+
+  field = &pyramid->fields[pyramid->num_fields];
+  alloc_field(cm, field, cur, bsize);
+
+  CHECK_MEM_ERROR(cm, mvs, vpx_malloc(field->mf.block_num * sizeof(*mvs)));
+  if (exported != NULL) {
+    estimate_field_from_exported(cpi, cur_frame, ref_frame, exported,
+                                 block_size, &field->mf, mvs);
+  } else {
+    estimate_field(cpi, cur_frame, ref_frame, coarsest_level, block_size,
+                   &field->mf, mvs);
+  }
+  vpx_free(mvs);
+
+  field->cur = cur;
+  field->ref = ref;
+  ++pyramid->num_fields;
+  return &field->mf;
+}
+
+ME_PYRAMID_FIELD *vp9_me_pyramid_export_field(VP9_COMP *cpi,
+                                              const YV12_BUFFER_CONFIG *cur,
+                                              const YV12_BUFFER_CONFIG *ref,
+                                              BLOCK_SIZE bsize) {
+  VP9_COMMON *const cm = &cpi->common;
+  ME_PYRAMID *const pyramid = &cpi->me_pyramid;
+  ME_PYRAMID_FIELD *field;
+
+  if (pyramid->num_exported == ME_PYRAMID_MAX_EXPORTED_FIELDS) return NULL;
+  field = &pyramid->exported[pyramid->num_exported];
+  if (alloc_field(cm, field, cur, bsize) || field->err == NULL) {
+    vpx_free(field->err);
+    CHECK_MEM_ERROR(cm, field->err,
+                    vpx_malloc(field->mf.block_num * sizeof(*field->err)));
+  }
+  memset(field->mf.set_mv, 0,
+         field->mf.block_num * sizeof(*field->mf.set_mv));
+  field->mf.ready = 1;
+  field->cur = cur;
+  field->ref = ref;
+  ++pyramid->num_exported;
+  return field;
+}
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2023 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VP9_ENCODER_VP9_ME_PYRAMID_H_
+#define VPX_VP9_ENCODER_VP9_ME_PYRAMID_H_
+
+#include "vpx/vpx_integer.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/common/vp9_blockd.h"
+#include "vp9/encoder/vp9_lookahead.h"
+#include "vp9/encoder/vp9_non_greedy_mv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of downscaled levels. Level l is the luma plane downscaled by 2^l,
+// level 0 being the frame itself.
+#define ME_PYRAMID_LEVELS 3
+#define ME_PYRAMID_MAX_FRAMES (2 * MAX_LAG_BUFFERS)
+#define ME_PYRAMID_MAX_FIELDS (ME_PYRAMID_MAX_FRAMES * MAX_INTER_REF_FRAMES)
+#define ME_PYRAMID_MAX_EXPORTED_FIELDS MAX_LAG_BUFFERS
+
+typedef struct me_pyramid_frame {
+  const YV12_BUFFER_CONFIG *src;
+  int num_levels;  // Including level 0.
+  int width[ME_PYRAMID_LEVELS + 1];
+  int height[ME_PYRAMID_LEVELS + 1];
+  int stride[ME_PYRAMID_LEVELS + 1];
+  const uint8_t *buf[ME_PYRAMID_LEVELS + 1];
+  uint8_t *alloc;
+  int alloc_size;
+} ME_PYRAMID_FRAME;
+
+typedef struct me_pyramid_field {
+  const YV12_BUFFER_CONFIG *cur;
+  const YV12_BUFFER_CONFIG *ref;
+  MotionField mf;
+  // Prediction error of each block. Only used by the exported fields.
+  uint32_t *err;
+} ME_PYRAMID_FIELD;
+
+// Cache of downscaled luma pyramids and of the full pixel motion fields
+// estimated coarse to fine between pairs of them. Frames are identified by
+// their buffer, so the cache must be reset whenever the buffers may have been
+// rewritten.
+typedef struct me_pyramid {
+  ME_PYRAMID_FRAME frames[ME_PYRAMID_MAX_FRAMES];
+  ME_PYRAMID_FIELD fields[ME_PYRAMID_MAX_FIELDS];
+  // Sub pixel motion fields found by other searches of the group, e.g. the
+  // temporal filter, used as candidates for the estimated fields.
+  ME_PYRAMID_FIELD exported[ME_PYRAMID_MAX_EXPORTED_FIELDS];
+  int num_frames;
+  int num_fields;
+  int num_exported;
+} ME_PYRAMID;
+
+struct VP9_COMP;
+
+// Drops the cached pyramids and motion fields, keeping their memory.
+void vp9_me_pyramid_reset(ME_PYRAMID *pyramid);
+
+// Returns the motion field of cur relative to ref on a grid of bsize blocks,
+// estimating it on the first request. The motion vectors are full pixel, in
+// 1/8 pel units, and keep the whole block inside the frame. Returns NULL if no
+// field can be estimated, e.g. for high bit depth or very small frames.
+// If a field of ref relative to cur was exported, its reversed vectors replace
+// the coarse levels of the search.
+const MotionField *vp9_me_pyramid_get_field(struct VP9_COMP *cpi,
+                                            const YV12_BUFFER_CONFIG *cur,
+                                            const YV12_BUFFER_CONFIG *ref,
+                                            BLOCK_SIZE bsize);
+
+// Returns a field of cur relative to ref on a grid of bsize blocks for the
+// caller to fill in, with no vector set, or NULL if the cache is full. The
+// vectors are in 1/8 pel units and err holds the prediction error of each
+// block.
+ME_PYRAMID_FIELD *vp9_me_pyramid_export_field(struct VP9_COMP *cpi,
+                                              const YV12_BUFFER_CONFIG *cur,
+                                              const YV12_BUFFER_CONFIG *ref,
+                                              BLOCK_SIZE bsize);
+
+void vp9_me_pyramid_free(ME_PYRAMID *pyramid);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VP9_ENCODER_VP9_ME_PYRAMID_H_
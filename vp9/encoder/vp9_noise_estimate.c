@@ -176,6 +176,8 @@ void vp9_update_noise_estimate(VP9_COMP *const cpi) {
     const uint8_t *src_u = cpi->Source->u_buffer;
     const uint8_t *src_v = cpi->Source->v_buffer;
     const int src_uvstride = cpi->Source->uv_stride;
+    const int use_analysis = vp9_source_analysis_valid(
+        &cpi->source_analysis, cpi->Source, last_source);
     int mi_row, mi_col;
     int num_low_motion = 0;
     int frame_low_motion = 1;
@@ -220,8 +222,13 @@ void vp9_update_noise_estimate(VP9_COMP *const cpi) {
               unsigned int sse;
               // Compute variance between co-located blocks from current and
               // last input frames.
-              unsigned int variance = cpi->fn_ptr[bsize].vf(
-                  src_y, src_ystride, last_src_y, last_src_ystride, &sse);
+              unsigned int variance =
+                  use_analysis
+                      ? vp9_source_analysis_var16x16(&cpi->source_analysis,
+                                                     mi_row >> 1, mi_col >> 1,
+                                                     &sse)
+                      : cpi->fn_ptr[bsize].vf(src_y, src_ystride, last_src_y,
+                                              last_src_ystride, &sse);
               unsigned int hist_index = variance / bin_size;
               if (hist_index < MAX_VAR_HIST_BINS)
                 hist[hist_index]++;
@@ -11,28 +11,12 @@
 #ifndef VPX_VP9_ENCODER_VP9_PARTITION_MODELS_H_
 #define VPX_VP9_ENCODER_VP9_PARTITION_MODELS_H_
 
+#include "vp9/encoder/vp9_nn.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define NN_MAX_HIDDEN_LAYERS 10
-#define NN_MAX_NODES_PER_LAYER 128
-
-// Neural net model config. It defines the layout of a neural net model, such as
-// the number of inputs/outputs, number of layers, the number of nodes in each
-// layer, as well as the weights and bias of each node.
-typedef struct {
-  int num_inputs;         // Number of input nodes, i.e. features.
-  int num_outputs;        // Number of output nodes.
-  int num_hidden_layers;  // Number of hidden layers, maximum 10.
-  // Number of nodes for each hidden layer.
-  int num_hidden_nodes[NN_MAX_HIDDEN_LAYERS];
-  // Weight parameters, indexed by layer.
-  const float *weights[NN_MAX_HIDDEN_LAYERS + 1];
-  // Bias parameters, indexed by layer.
-  const float *bias[NN_MAX_HIDDEN_LAYERS + 1];
-} NN_CONFIG;
-
 // Partition search breakout model.
 #define FEATURES 4
 #define Q_CTX 3
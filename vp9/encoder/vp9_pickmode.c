@@ -164,6 +164,8 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   const int ref = mi->ref_frame[0];
   const MV ref_mv = x->mbmi_ext->ref_mvs[ref][0].as_mv;
   MV center_mv;
+  MV hint_mv;
+  int hint_type;
   uint32_t dis;
   int rate_mode;
   const MvLimits tmp_mv_limits = x->mv_limits;
@@ -199,6 +201,28 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   mvp_full.col >>= 3;
   mvp_full.row >>= 3;
 
+  hint_type = vp9_get_motion_hint(cpi, ref, bsize, mi_row, mi_col, &hint_mv);
+  if (hint_type != MOTION_HINT_NONE) {
+    hint_mv.col >>= 3;
+    hint_mv.row >>= 3;
+    if (!is_mv_in(&x->mv_limits, &hint_mv)) hint_type = MOTION_HINT_NONE;
+  }
+
+  if (hint_type == MOTION_HINT_CANDIDATE && !x->sb_use_mv_part) {
+    // Start from the hint when it matches better than the predicted mv.
+    const struct buf_2d *const pre = &xd->plane[0].pre[0];
+    const uint8_t *const src = x->plane[0].src.buf;
+    const int src_stride = x->plane[0].src.stride;
+    MV pred_full = mvp_full;
+    clamp_mv(&pred_full, x->mv_limits.col_min, x->mv_limits.col_max,
+             x->mv_limits.row_min, x->mv_limits.row_max);
+    if (cpi->fn_ptr[bsize].sdf(src, src_stride, get_buf_from_mv(pre, &hint_mv),
+                               pre->stride) <
+        cpi->fn_ptr[bsize].sdf(src, src_stride,
+                               get_buf_from_mv(pre, &pred_full), pre->stride))
+      mvp_full = hint_mv;
+  }
+
   if (!use_base_mv)
     center_mv = ref_mv;
   else
@@ -207,6 +231,11 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   if (x->sb_use_mv_part) {
     tmp_mv->as_mv.row = x->sb_mvrow_part >> 3;
     tmp_mv->as_mv.col = x->sb_mvcol_part >> 3;
+  } else if (hint_type == MOTION_HINT_TRUSTED) {
+    // Skip the full pixel search, the sub pixel search refines the hint.
+    int i;
+    tmp_mv->as_mv = hint_mv;
+    for (i = 0; i < 5; ++i) cost_list[i] = INT_MAX;
   } else {
     vp9_full_pixel_search(
         cpi, x, bsize, &mvp_full, step_param, cpi->sf.mv.search_method, sadpb,
@@ -3088,33 +3088,63 @@ void vp9_scene_detection_onepass(VP9_COMP *cpi) {
         int num_samples = 0;
         int sb_cols = (num_mi_cols + MI_BLOCK_SIZE - 1) / MI_BLOCK_SIZE;
         int sb_rows = (num_mi_rows + MI_BLOCK_SIZE - 1) / MI_BLOCK_SIZE;
+        const struct lookahead_source_stats *stats = NULL;
         if (cpi->oxcf.lag_in_frames > 0) {
           src_y = frames[frame]->y_buffer;
           src_ystride = frames[frame]->y_stride;
           last_src_y = frames[frame + 1]->y_buffer;
           last_src_ystride = frames[frame + 1]->y_stride;
+          stats = vp9_lookahead_get_source_stats(cpi->lookahead, frames[frame],
+                                                 frames[frame + 1]);
         }
         num_zero_temp_sad = 0;
-        for (sbi_row = 0; sbi_row < sb_rows; ++sbi_row) {
-          for (sbi_col = 0; sbi_col < sb_cols; ++sbi_col) {
-            // Checker-board pattern, ignore boundary.
-            if (((sbi_row > 0 && sbi_col > 0) &&
-                 (sbi_row < sb_rows - 1 && sbi_col < sb_cols - 1) &&
-                 ((sbi_row % 2 == 0 && sbi_col % 2 == 0) ||
-                  (sbi_row % 2 != 0 && sbi_col % 2 != 0)))) {
-              tmp_sad = cpi->fn_ptr[bsize].sdf(src_y, src_ystride, last_src_y,
-                                               last_src_ystride);
-              avg_sad += tmp_sad;
-              num_samples++;
-              if (tmp_sad == 0) num_zero_temp_sad++;
+        if (stats != NULL && stats->sb_cols == sb_cols &&
+            stats->sb_rows == sb_rows) {
+          // Already computed by the lookahead analysis stage.
+          avg_sad = stats->avg_sad;
+          num_samples = stats->num_samples;
+          num_zero_temp_sad = stats->num_zero_temp_sad;
+        } else if (cpi->oxcf.lag_in_frames == 0 &&
+                   vp9_source_analysis_valid(&cpi->source_analysis,
+                                             unscaled_src, unscaled_last_src) &&
+                   cpi->source_analysis.cols == sb_cols << 2 &&
+                   cpi->source_analysis.rows == sb_rows << 2) {
+          // Already computed by the frame source analysis.
+          for (sbi_row = 1; sbi_row < sb_rows - 1; ++sbi_row) {
+            for (sbi_col = 1; sbi_col < sb_cols - 1; ++sbi_col) {
+              if ((sbi_row & 1) == (sbi_col & 1)) {
+                unsigned int sse, variance;
+                tmp_sad = vp9_source_analysis_sb(
+                    &cpi->source_analysis, sbi_row, sbi_col, &sse, &variance);
+                avg_sad += tmp_sad;
+                num_samples++;
+                if (tmp_sad == 0) num_zero_temp_sad++;
+              }
             }
-            src_y += 64;
-            last_src_y += 64;
           }
-          src_y += (src_ystride << 6) - (sb_cols << 6);
-          last_src_y += (last_src_ystride << 6) - (sb_cols << 6);
+          if (num_samples > 0) avg_sad = avg_sad / num_samples;
+        } else {
+          for (sbi_row = 0; sbi_row < sb_rows; ++sbi_row) {
+            for (sbi_col = 0; sbi_col < sb_cols; ++sbi_col) {
+              // Checker-board pattern, ignore boundary.
+              if (((sbi_row > 0 && sbi_col > 0) &&
+                   (sbi_row < sb_rows - 1 && sbi_col < sb_cols - 1) &&
+                   ((sbi_row % 2 == 0 && sbi_col % 2 == 0) ||
+                    (sbi_row % 2 != 0 && sbi_col % 2 != 0)))) {
+                tmp_sad = cpi->fn_ptr[bsize].sdf(src_y, src_ystride,
+                                                 last_src_y, last_src_ystride);
+                avg_sad += tmp_sad;
+                num_samples++;
+                if (tmp_sad == 0) num_zero_temp_sad++;
+              }
+              src_y += 64;
+              last_src_y += 64;
+            }
+            src_y += (src_ystride << 6) - (sb_cols << 6);
+            last_src_y += (last_src_ystride << 6) - (sb_cols << 6);
+          }
+          if (num_samples > 0) avg_sad = avg_sad / num_samples;
         }
-        if (num_samples > 0) avg_sad = avg_sad / num_samples;
         // Set high_source_sad flag if we detect very high increase in avg_sad
         // between current and previous frame value(s). Use minimum threshold
         // for cases where there is small change from content that is completely
@@ -925,6 +925,79 @@ static void choose_largest_tx_size(VP9_COMP *cpi, MACROBLOCK *x, int *rate,
                    mi->tx_size, cpi->sf.use_fast_coef_costing, recon);
 }
 
+// Estimates the rate and distortion of the luma residual of an inter block
+// with tx_size from the Hadamard transform and the fast quantizer, as in the
+// real-time mode decision. Returns the rd cost, skip flag cost included.
+static int64_t model_txfm_yrd(MACROBLOCK *x, BLOCK_SIZE bsize, TX_SIZE tx_size,
+                              int s0, int s1) {
+  MACROBLOCKD *const xd = &x->e_mbd;
+  const struct macroblockd_plane *const pd = &xd->plane[0];
+  struct macroblock_plane *const p = &x->plane[0];
+  const int num_4x4_w = num_4x4_blocks_wide_lookup[bsize];
+  const int num_4x4_h = num_4x4_blocks_high_lookup[bsize];
+  const int step = 1 << (tx_size << 1);
+  const int block_step = (1 << tx_size);
+  const int max_blocks_wide =
+      num_4x4_w + (xd->mb_to_right_edge >= 0 ? 0 : xd->mb_to_right_edge >> 5);
+  const int max_blocks_high =
+      num_4x4_h + (xd->mb_to_bottom_edge >= 0 ? 0 : xd->mb_to_bottom_edge >> 5);
+  const int diff_stride = 4 * num_4x4_w;
+  const scan_order *const so = &vp9_default_scan_orders[tx_size];
+  const int shift = tx_size == TX_32X32 ? 0 : 2;
+  int block = 0, r, c;
+  int rate = 0, eob_cost = 0;
+  int64_t dist = 0;
+
+  for (r = 0; r < max_blocks_high; r += block_step) {
+    for (c = 0; c < num_4x4_w; c += block_step) {
+      if (c < max_blocks_wide) {
+        const int16_t *const src_diff =
+            &p->src_diff[(r * diff_stride + c) << 2];
+        tran_low_t *const coeff = BLOCK_OFFSET(p->coeff, block);
+        tran_low_t *const qcoeff = BLOCK_OFFSET(p->qcoeff, block);
+        tran_low_t *const dqcoeff = BLOCK_OFFSET(pd->dqcoeff, block);
+        uint16_t *const eob = &p->eobs[block];
+        switch (tx_size) {
+          case TX_32X32:
+            vpx_hadamard_32x32(src_diff, diff_stride, coeff);
+            vp9_quantize_fp_32x32(coeff, 1024, p->round_fp, p->quant_fp,
+                                  qcoeff, dqcoeff, pd->dequant, eob, so->scan,
+                                  so->iscan);
+            break;
+          case TX_16X16:
+            vpx_hadamard_16x16(src_diff, diff_stride, coeff);
+            vp9_quantize_fp(coeff, 256, p->round_fp, p->quant_fp, qcoeff,
+                            dqcoeff, pd->dequant, eob, so->scan, so->iscan);
+            break;
+          case TX_8X8:
+            vpx_hadamard_8x8(src_diff, diff_stride, coeff);
+            vp9_quantize_fp(coeff, 64, p->round_fp, p->quant_fp, qcoeff,
+                            dqcoeff, pd->dequant, eob, so->scan, so->iscan);
+            break;
+          default:
+            assert(tx_size == TX_4X4);
+            x->fwd_txfm4x4(src_diff, coeff, diff_stride);
+            vp9_quantize_fp(coeff, 16, p->round_fp, p->quant_fp, qcoeff,
+                            dqcoeff, pd->dequant, eob, so->scan, so->iscan);
+            break;
+        }
+        if (*eob == 1)
+          rate += (int)abs(qcoeff[0]);
+        else if (*eob > 1)
+          rate += vpx_satd(qcoeff, step << 4);
+        eob_cost += *eob > 0;
+        dist += vp9_block_error_fp(coeff, dqcoeff, step << 4) >> shift;
+      }
+      block += step;
+    }
+  }
+
+  if (eob_cost == 0) return RDCOST(x->rdmult, x->rddiv, s1, dist);
+  rate <<= (2 + VP9_PROB_COST_SHIFT);
+  rate += (eob_cost << VP9_PROB_COST_SHIFT);
+  return RDCOST(x->rdmult, x->rddiv, rate + s0, dist);
+}
+
 static void choose_tx_size_from_rd(VP9_COMP *cpi, MACROBLOCK *x, int *rate,
                                    int64_t *distortion, int *skip,
                                    int64_t *psse, int64_t ref_best_rd,
@@ -946,6 +1019,7 @@ static void choose_tx_size_from_rd(VP9_COMP *cpi, MACROBLOCK *x, int *rate,
   TX_SIZE best_tx = max_tx_size;
   int start_tx, end_tx;
   const int tx_size_ctx = get_tx_size_context(xd);
+  int searched[TX_SIZES] = { 1, 1, 1, 1 };
 #if CONFIG_VP9_HIGHBITDEPTH
   DECLARE_ALIGNED(16, uint16_t, recon_buf16[TX_SIZES][64 * 64]);
   uint8_t *recon_buf[TX_SIZES];
@@ -975,8 +1049,38 @@ static void choose_tx_size_from_rd(VP9_COMP *cpi, MACROBLOCK *x, int *rate,
     end_tx = chosen_tx_size;
   }
 
+  // Only search the transform sizes with the lowest modeled rd cost.
+  if (cpi->sf.tx_size_search_model > 0 &&
+      start_tx - end_tx + 1 > cpi->sf.tx_size_search_model &&
+      is_inter_block(mi)
+#if CONFIG_VP9_HIGHBITDEPTH
+      && !(xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH)
+#endif
+  ) {
+    int64_t model_rd[TX_SIZES];
+    int i;
+    for (n = start_tx; n >= end_tx; n--) {
+      model_rd[n] = model_txfm_yrd(x, bs, n, s0, s1) +
+                    RDCOST(x->rdmult, x->rddiv,
+                           cpi->tx_size_cost[max_tx_size - 1][tx_size_ctx][n],
+                           0);
+    }
+    for (n = start_tx; n >= end_tx; n--) {
+      int rank = 0;
+      for (i = start_tx; i >= end_tx; i--) {
+        if (model_rd[i] < model_rd[n] || (model_rd[i] == model_rd[n] && i > n))
+          ++rank;
+      }
+      searched[n] = rank < cpi->sf.tx_size_search_model;
+    }
+    n = start_tx;
+    while (!searched[n]) --n;
+    best_tx = n;
+  }
+
   for (n = start_tx; n >= end_tx; n--) {
     const int r_tx_size = cpi->tx_size_cost[max_tx_size - 1][tx_size_ctx][n];
+    if (!searched[n]) continue;
     if (recon) {
       struct buf_2d this_recon;
       this_recon.buf = recon_buf[n];
@@ -2471,6 +2575,62 @@ static int ref_frame_to_gf_rf_idx(int ref_frame) {
 }
 #endif
 
+// Looks up the full pixel motion search results cached for the blocks of the
+// superblock that contain the block or are contained in it. Returns how many
+// there are if they all found the same motion vector, written to mv, or -1.
+static int get_partition_cached_mv(const MV_SEARCH_CACHE *cache, int ref,
+                                   BLOCK_SIZE bsize, int mi_row, int mi_col,
+                                   MV *mv) {
+  const int row = mi_row & MI_MASK;
+  const int col = mi_col & MI_MASK;
+  const int bh = num_8x8_blocks_high_lookup[bsize];
+  const int bw = num_8x8_blocks_wide_lookup[bsize];
+  int count = 0;
+  BLOCK_SIZE size;
+
+  for (size = BLOCK_8X8; size < BLOCK_SIZES; ++size) {
+    const uint64_t valid = cache->valid[ref][size];
+    const int h = num_8x8_blocks_high_lookup[size];
+    const int w = num_8x8_blocks_wide_lookup[size];
+    int r, c;
+    if (!valid) continue;
+    if (h >= bh && w >= bw) {
+      // The block of this size containing the current one.
+      r = row & ~(h - 1);
+      c = col & ~(w - 1);
+      if (valid & ((uint64_t)1 << (r * MI_BLOCK_SIZE + c))) {
+        const MV *this_mv = &cache->mv[ref][size][r * MI_BLOCK_SIZE + c];
+        if (count && (this_mv->row != mv->row || this_mv->col != mv->col))
+          return -1;
+        *mv = *this_mv;
+        ++count;
+      }
+    } else if (h <= bh && w <= bw) {
+      // The blocks of this size within the current one.
+      for (r = row; r < row + bh; r += h) {
+        for (c = col; c < col + bw; c += w) {
+          if (valid & ((uint64_t)1 << (r * MI_BLOCK_SIZE + c))) {
+            const MV *this_mv = &cache->mv[ref][size][r * MI_BLOCK_SIZE + c];
+            if (count && (this_mv->row != mv->row || this_mv->col != mv->col))
+              return -1;
+            *mv = *this_mv;
+            ++count;
+          }
+        }
+      }
+    }
+  }
+  return count;
+}
+
+static void set_partition_cached_mv(MV_SEARCH_CACHE *cache, int ref,
+                                    BLOCK_SIZE bsize, int mi_row, int mi_col,
+                                    const MV *mv) {
+  const int idx = (mi_row & MI_MASK) * MI_BLOCK_SIZE + (mi_col & MI_MASK);
+  cache->valid[ref][bsize] |= (uint64_t)1 << idx;
+  cache->mv[ref][bsize][idx] = *mv;
+}
+
 static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
                                  int mi_row, int mi_col, int_mv *tmp_mv,
                                  int *rate_mv) {
@@ -2490,6 +2650,8 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   const int pw = num_4x4_blocks_wide_lookup[bsize] << 2;
   const int ph = num_4x4_blocks_high_lookup[bsize] << 2;
   MV pred_mv[3];
+  MV hint_mv;
+  int hint_type;
 
   int bestsme = INT_MAX;
 #if CONFIG_NON_GREEDY_MV
@@ -2572,65 +2734,108 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   // after full-pixel motion search.
   vp9_set_mv_search_range(&x->mv_limits, &ref_mv);
 
-  mvp_full = pred_mv[best_predmv_idx];
-  mvp_full.col >>= 3;
-  mvp_full.row >>= 3;
+  hint_type = vp9_get_motion_hint(cpi, ref, bsize, mi_row, mi_col, &hint_mv);
+  if (hint_type != MOTION_HINT_NONE) {
+    hint_mv.col >>= 3;
+    hint_mv.row >>= 3;
+    if (!is_mv_in(&x->mv_limits, &hint_mv)) hint_type = MOTION_HINT_NONE;
+  }
 
+  if (hint_type == MOTION_HINT_TRUSTED ||
+      (cpi->sf.mv.reuse_partition_mvs &&
+       get_partition_cached_mv(&x->mv_search_cache, ref, bsize, mi_row, mi_col,
+                               &tmp_mv->as_mv) >=
+           cpi->sf.mv.reuse_partition_mvs &&
+       is_mv_in(&x->mv_limits, &tmp_mv->as_mv))) {
+    // The motion of the block is trusted from the hints, or the other
+    // partition levels agree on it. Only refine it with the smallest search
+    // steps.
+    mvp_full = hint_type == MOTION_HINT_TRUSTED ? hint_mv : tmp_mv->as_mv;
 #if CONFIG_NON_GREEDY_MV
-  bestsme = vp9_full_pixel_diamond_new(cpi, x, bsize, &mvp_full, step_param,
-                                       lambda, 1, nb_full_mvs, nb_full_mv_num,
-                                       &tmp_mv->as_mv);
+    bestsme = vp9_full_pixel_diamond_new(
+        cpi, x, bsize, &mvp_full, MAX_MVSEARCH_STEPS - 3, lambda, 1,
+        nb_full_mvs, nb_full_mv_num, &tmp_mv->as_mv);
 #else   // CONFIG_NON_GREEDY_MV
-  bestsme = vp9_full_pixel_search(
-      cpi, x, bsize, &mvp_full, step_param, cpi->sf.mv.search_method, sadpb,
-      cond_cost_list(cpi, cost_list), &ref_mv, &tmp_mv->as_mv, INT_MAX, 1);
+    bestsme = vp9_full_pixel_search(
+        cpi, x, bsize, &mvp_full, MAX_MVSEARCH_STEPS - 3,
+        cpi->sf.mv.search_method, sadpb, cond_cost_list(cpi, cost_list),
+        &ref_mv, &tmp_mv->as_mv, INT_MAX, 1);
 #endif  // CONFIG_NON_GREEDY_MV
+  } else {
+    mvp_full = pred_mv[best_predmv_idx];
+    mvp_full.col >>= 3;
+    mvp_full.row >>= 3;
+
+    if (hint_type == MOTION_HINT_CANDIDATE) {
+      // Start from the hint when it matches better than the predicted mv.
+      const struct buf_2d *const pre = &xd->plane[0].pre[0];
+      const int hint_sad = cpi->fn_ptr[bsize].sdf(
+          x->plane[0].src.buf, x->plane[0].src.stride,
+          get_buf_from_mv(pre, &hint_mv), pre->stride);
+      if (hint_sad < x->pred_mv_sad[ref]) mvp_full = hint_mv;
+    }
 
-  if (cpi->sf.enhanced_full_pixel_motion_search) {
-    int i;
-    for (i = 0; i < 3; ++i) {
-      int this_me;
-      MV this_mv;
-      int diff_row;
-      int diff_col;
-      int step;
-
-      if (pred_mv[i].row == INT16_MAX || pred_mv[i].col == INT16_MAX) continue;
-      if (i == best_predmv_idx) continue;
-
-      diff_row = ((int)pred_mv[i].row -
-                  pred_mv[i > 0 ? (i - 1) : best_predmv_idx].row) >>
-                 3;
-      diff_col = ((int)pred_mv[i].col -
-                  pred_mv[i > 0 ? (i - 1) : best_predmv_idx].col) >>
-                 3;
-      if (diff_row == 0 && diff_col == 0) continue;
-      if (diff_row < 0) diff_row = -diff_row;
-      if (diff_col < 0) diff_col = -diff_col;
-      step = get_msb((diff_row + diff_col + 1) >> 1);
-      if (step <= 0) continue;
-
-      mvp_full = pred_mv[i];
-      mvp_full.col >>= 3;
-      mvp_full.row >>= 3;
 #if CONFIG_NON_GREEDY_MV
-      this_me = vp9_full_pixel_diamond_new(
-          cpi, x, bsize, &mvp_full,
-          VPXMAX(step_param, MAX_MVSEARCH_STEPS - step), lambda, 1, nb_full_mvs,
-          nb_full_mv_num, &this_mv);
+    bestsme = vp9_full_pixel_diamond_new(cpi, x, bsize, &mvp_full, step_param,
+                                         lambda, 1, nb_full_mvs, nb_full_mv_num,
+                                         &tmp_mv->as_mv);
+#else   // CONFIG_NON_GREEDY_MV
+    bestsme = vp9_full_pixel_search(
+        cpi, x, bsize, &mvp_full, step_param, cpi->sf.mv.search_method, sadpb,
+        cond_cost_list(cpi, cost_list), &ref_mv, &tmp_mv->as_mv, INT_MAX, 1);
+#endif  // CONFIG_NON_GREEDY_MV
+
+    if (cpi->sf.enhanced_full_pixel_motion_search) {
+      int i;
+      for (i = 0; i < 3; ++i) {
+        int this_me;
+        MV this_mv;
+        int diff_row;
+        int diff_col;
+        int step;
+
+        if (pred_mv[i].row == INT16_MAX || pred_mv[i].col == INT16_MAX)
+          continue;
+        if (i == best_predmv_idx) continue;
+
+        diff_row = ((int)pred_mv[i].row -
+                    pred_mv[i > 0 ? (i - 1) : best_predmv_idx].row) >>
+                   3;
+        diff_col = ((int)pred_mv[i].col -
+                    pred_mv[i > 0 ? (i - 1) : best_predmv_idx].col) >>
+                   3;
+        if (diff_row == 0 && diff_col == 0) continue;
+        if (diff_row < 0) diff_row = -diff_row;
+        if (diff_col < 0) diff_col = -diff_col;
+        step = get_msb((diff_row + diff_col + 1) >> 1);
+        if (step <= 0) continue;
+
+        mvp_full = pred_mv[i];
+        mvp_full.col >>= 3;
+        mvp_full.row >>= 3;
+#if CONFIG_NON_GREEDY_MV
+        this_me = vp9_full_pixel_diamond_new(
+            cpi, x, bsize, &mvp_full,
+            VPXMAX(step_param, MAX_MVSEARCH_STEPS - step), lambda, 1,
+            nb_full_mvs, nb_full_mv_num, &this_mv);
 #else   // CONFIG_NON_GREEDY_MV
-      this_me = vp9_full_pixel_search(
-          cpi, x, bsize, &mvp_full,
-          VPXMAX(step_param, MAX_MVSEARCH_STEPS - step),
-          cpi->sf.mv.search_method, sadpb, cond_cost_list(cpi, cost_list),
-          &ref_mv, &this_mv, INT_MAX, 1);
+        this_me = vp9_full_pixel_search(
+            cpi, x, bsize, &mvp_full,
+            VPXMAX(step_param, MAX_MVSEARCH_STEPS - step),
+            cpi->sf.mv.search_method, sadpb, cond_cost_list(cpi, cost_list),
+            &ref_mv, &this_mv, INT_MAX, 1);
 #endif  // CONFIG_NON_GREEDY_MV
-      if (this_me < bestsme) {
-        tmp_mv->as_mv = this_mv;
-        bestsme = this_me;
+        if (this_me < bestsme) {
+          tmp_mv->as_mv = this_mv;
+          bestsme = this_me;
+        }
       }
     }
   }
+  if (bestsme < INT_MAX) {
+    set_partition_cached_mv(&x->mv_search_cache, ref, bsize, mi_row, mi_col,
+                            &tmp_mv->as_mv);
+  }
 
   x->mv_limits = tmp_mv_limits;
 
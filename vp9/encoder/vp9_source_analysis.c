@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2023 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+
+#include "./vpx_dsp_rtcd.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/encoder/vp9_encoder.h"
+#include "vp9/encoder/vp9_source_analysis.h"
+
+void vp9_source_analysis_reset(SOURCE_ANALYSIS *sa) {
+  sa->src = NULL;
+  sa->last_src = NULL;
+}
+
+void vp9_source_analysis_compute(VP9_COMP *cpi, const YV12_BUFFER_CONFIG *src,
+                                 const YV12_BUFFER_CONFIG *last_src) {
+  VP9_COMMON *const cm = &cpi->common;
+  SOURCE_ANALYSIS *const sa = &cpi->source_analysis;
+  const int cols = mi_cols_aligned_to_sb(cm->mi_cols) >> 1;
+  const int rows = mi_cols_aligned_to_sb(cm->mi_rows) >> 1;
+  const int src_stride = src->y_stride;
+  const int last_src_stride = last_src->y_stride;
+  int row, col;
+
+  vp9_source_analysis_reset(sa);
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (cm->use_highbitdepth) return;
+#endif
+  if (src->y_width != last_src->y_width ||
+      src->y_height != last_src->y_height)
+    return;
+
+  if (cols * rows > sa->alloc_size) {
+    vpx_free(sa->blocks);
+    sa->alloc_size = 0;
+    CHECK_MEM_ERROR(cm, sa->blocks,
+                    vpx_calloc(cols * rows, sizeof(*sa->blocks)));
+    sa->alloc_size = cols * rows;
+  }
+
+  // Blocks overhanging the frame edge read into the border extension, exactly
+  // as the 64x64 superblock computations did.
+  for (row = 0; row < rows; ++row) {
+    const uint8_t *src_y = src->y_buffer + (row << 4) * src_stride;
+    const uint8_t *last_src_y =
+        last_src->y_buffer + (row << 4) * last_src_stride;
+    SOURCE_BLOCK_STATS *const stats = sa->blocks + row * cols;
+    for (col = 0; col < cols; ++col) {
+      stats[col].sad =
+          vpx_sad16x16(src_y, src_stride, last_src_y, last_src_stride);
+      vpx_get16x16var(src_y, src_stride, last_src_y, last_src_stride,
+                      &stats[col].sse, &stats[col].sum);
+      src_y += 16;
+      last_src_y += 16;
+    }
+  }
+
+  sa->cols = cols;
+  sa->rows = rows;
+  sa->src = src;
+  sa->last_src = last_src;
+}
+
+int vp9_source_analysis_valid(const SOURCE_ANALYSIS *sa,
+                              const YV12_BUFFER_CONFIG *src,
+                              const YV12_BUFFER_CONFIG *last_src) {
+  return sa->src != NULL && sa->src == src && sa->last_src == last_src;
+}
+
+unsigned int vp9_source_analysis_sb(const SOURCE_ANALYSIS *sa, int sb_row,
+                                    int sb_col, unsigned int *sse,
+                                    unsigned int *variance) {
+  const SOURCE_BLOCK_STATS *stats =
+      sa->blocks + (sb_row << 2) * sa->cols + (sb_col << 2);
+  unsigned int sad = 0;
+  int sum = 0;
+  int i, j;
+  assert((sb_row << 2) < sa->rows && (sb_col << 2) < sa->cols);
+  *sse = 0;
+  for (i = 0; i < 4; ++i) {
+    for (j = 0; j < 4; ++j) {
+      sad += stats[j].sad;
+      *sse += stats[j].sse;
+      sum += stats[j].sum;
+    }
+    stats += sa->cols;
+  }
+  *variance = *sse - (unsigned int)(((int64_t)sum * sum) >> 12);
+  return sad;
+}
+
+unsigned int vp9_source_analysis_var16x16(const SOURCE_ANALYSIS *sa, int row,
+                                          int col, unsigned int *sse) {
+  const SOURCE_BLOCK_STATS *const stats = sa->blocks + row * sa->cols + col;
+  assert(row < sa->rows && col < sa->cols);
+  *sse = stats->sse;
+  return stats->sse - (unsigned int)(((int64_t)stats->sum * stats->sum) >> 8);
+}
+
+void vp9_source_analysis_free(SOURCE_ANALYSIS *sa) {
+  vpx_free(sa->blocks);
+  sa->blocks = NULL;
+  sa->alloc_size = 0;
+  vp9_source_analysis_reset(sa);
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2023 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VP9_ENCODER_VP9_SOURCE_ANALYSIS_H_
+#define VPX_VP9_ENCODER_VP9_SOURCE_ANALYSIS_H_
+
+#include "vpx/vpx_integer.h"
+#include "vpx_scale/yv12config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Temporal difference statistics of one 16x16 luma block between the source
+// and the last source frame.
+typedef struct source_block_stats {
+  unsigned int sad;
+  unsigned int sse;
+  int sum;
+} SOURCE_BLOCK_STATS;
+
+// Per-frame cache of source vs last source statistics. It is computed once
+// per frame over every 16x16 block of the superblock-aligned frame, and the
+// 64x64 SAD/variance used for the superblock content state, the checkerboard
+// SAD used by one pass scene detection and the 16x16 variance used by noise
+// estimation are all derived from it. The derived values are bit-exact with
+// computing them directly.
+typedef struct source_analysis {
+  const YV12_BUFFER_CONFIG *src;
+  const YV12_BUFFER_CONFIG *last_src;
+  int cols;  // In 16x16 units, a multiple of 4.
+  int rows;  // In 16x16 units, a multiple of 4.
+  int alloc_size;
+  SOURCE_BLOCK_STATS *blocks;
+} SOURCE_ANALYSIS;
+
+struct VP9_COMP;
+
+// Drops the cached statistics. Must be called whenever the cached source
+// buffers may have been recycled.
+void vp9_source_analysis_reset(SOURCE_ANALYSIS *sa);
+
+// Computes the statistics between src and last_src for the current frame size.
+void vp9_source_analysis_compute(struct VP9_COMP *cpi,
+                                 const YV12_BUFFER_CONFIG *src,
+                                 const YV12_BUFFER_CONFIG *last_src);
+
+// Returns 1 if the cache holds the statistics between src and last_src.
+int vp9_source_analysis_valid(const SOURCE_ANALYSIS *sa,
+                              const YV12_BUFFER_CONFIG *src,
+                              const YV12_BUFFER_CONFIG *last_src);
+
+// Returns the 64x64 SAD of the superblock at (sb_row, sb_col), and its sse
+// and variance as vpx_variance64x64() would compute them.
+unsigned int vp9_source_analysis_sb(const SOURCE_ANALYSIS *sa, int sb_row,
+                                    int sb_col, unsigned int *sse,
+                                    unsigned int *variance);
+
+// Returns the variance of the 16x16 block at (row, col) in 16x16 units, as
+// vpx_variance16x16() would compute it.
+unsigned int vp9_source_analysis_var16x16(const SOURCE_ANALYSIS *sa, int row,
+                                          int col, unsigned int *sse);
+
+void vp9_source_analysis_free(SOURCE_ANALYSIS *sa);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VP9_ENCODER_VP9_SOURCE_ANALYSIS_H_
@@ -284,6 +284,7 @@ static void set_good_speed_feature_framesize_independent(VP9_COMP *cpi,
         (cpi->twopass.fr_content_type == FC_GRAPHICS_ANIMATION) ? (1 << 23)
                                                                 : INT_MAX;
     sf->use_accurate_subpel_search = USE_4_TAPS;
+    sf->tx_size_search_model = 1;
   }
 
   if (speed >= 2) {
@@ -310,6 +311,7 @@ static void set_good_speed_feature_framesize_independent(VP9_COMP *cpi,
     sf->recode_tolerance_low = 15;
     sf->recode_tolerance_high = 45;
     sf->enhanced_full_pixel_motion_search = 0;
+    sf->tpl_use_me_pyramid = 1;
     sf->prune_ref_frame_for_rect_partitions = 0;
     sf->rd_ml_partition.prune_rect_thresh[1] = -1;
     sf->rd_ml_partition.prune_rect_thresh[2] = -1;
@@ -334,6 +336,7 @@ static void set_good_speed_feature_framesize_independent(VP9_COMP *cpi,
     sf->tx_size_search_method =
         frame_is_intra_only(cm) ? USE_FULL_RD : USE_LARGESTALL;
     sf->mv.subpel_search_method = SUBPEL_TREE_PRUNED;
+    sf->mv.reuse_partition_mvs = 2;
     sf->adaptive_pred_interp_filter = 0;
     sf->adaptive_mode_search = 1;
     sf->cb_partition_search = !boosted;
@@ -690,7 +693,8 @@ static void set_rt_speed_feature_framesize_independent(
       if (svc->non_reference_frame)
         sf->mv.subpel_search_method = SUBPEL_TREE_PRUNED_EVENMORE;
     }
-    if (cpi->use_svc && cpi->row_mt && cpi->oxcf.max_threads > 1)
+    if (cpi->use_svc && cpi->row_mt &&
+        (cpi->oxcf.max_threads > 1 || cpi->row_mt_deterministic))
       sf->adaptive_rd_thresh_row_mt = 1;
     // Enable partition copy. For SVC only enabled for top spatial resolution
     // layer.
@@ -732,7 +736,8 @@ static void set_rt_speed_feature_framesize_independent(
     else
       sf->nonrd_keyframe = 1;
     if (!cpi->use_svc) cpi->max_copied_frame = 4;
-    if (cpi->row_mt && cpi->oxcf.max_threads > 1)
+    if (cpi->row_mt &&
+        (cpi->oxcf.max_threads > 1 || cpi->row_mt_deterministic))
       sf->adaptive_rd_thresh_row_mt = 1;
     // Enable ML based partition for low res.
     if (!frame_is_intra_only(cm) && cm->width * cm->height <= 352 * 288) {
@@ -879,7 +884,7 @@ void vp9_set_speed_features_framesize_dependent(VP9_COMP *cpi, int speed) {
   // It can be used in realtime when adaptive_rd_thresh_row_mt is enabled since
   // adaptive_rd_thresh is defined per-row for non-rd pickmode.
   if (!sf->adaptive_rd_thresh_row_mt && cpi->row_mt_bit_exact &&
-      oxcf->max_threads > 1)
+      (oxcf->max_threads > 1 || cpi->row_mt_deterministic))
     sf->adaptive_rd_thresh = 0;
 }
 
@@ -904,6 +909,7 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi, int speed) {
   sf->coeff_prob_appx_step = 1;
   sf->mv.auto_mv_step_size = 0;
   sf->mv.fullpel_search_step_param = 6;
+  sf->mv.reuse_partition_mvs = 0;
   sf->comp_inter_joint_search_thresh = BLOCK_4X4;
   sf->tx_size_search_method = USE_FULL_RD;
   sf->use_lp32x32fdct = 0;
@@ -940,6 +946,7 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi, int speed) {
   sf->quant_opt_thresh = 99.0;
   sf->allow_acl = 1;
   sf->enable_tpl_model = oxcf->enable_tpl_model;
+  sf->tpl_use_me_pyramid = 0;
   sf->prune_ref_frame_for_rect_partitions = 0;
   sf->temporal_filter_search_method = MESH;
   sf->allow_skip_txfm_ac_dc = 0;
@@ -987,6 +994,7 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi, int speed) {
   sf->adaptive_rd_thresh = 1;
   sf->tx_size_search_breakout = 1;
   sf->tx_size_search_depth = 2;
+  sf->tx_size_search_model = 0;
 
   sf->exhaustive_searches_thresh =
       (cpi->twopass.fr_content_type == FC_GRAPHICS_ANIMATION) ? (1 << 20)
@@ -1051,6 +1059,6 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi, int speed) {
   // It can be used in realtime when adaptive_rd_thresh_row_mt is enabled since
   // adaptive_rd_thresh is defined per-row for non-rd pickmode.
   if (!sf->adaptive_rd_thresh_row_mt && cpi->row_mt_bit_exact &&
-      oxcf->max_threads > 1)
+      (oxcf->max_threads > 1 || cpi->row_mt_deterministic))
     sf->adaptive_rd_thresh = 0;
 }
@@ -58,7 +58,10 @@ typedef enum {
   SQUARE = 4,
   FAST_HEX = 5,
   FAST_DIAMOND = 6,
-  MESH = 7
+  MESH = 7,
+  // Matches the 1-D integral projections of the block, see
+  // vp9_int_pro_motion_estimation().
+  PROJECTION = 8
 } SEARCH_METHODS;
 
 typedef enum {
@@ -210,6 +213,12 @@ typedef struct MV_SPEED_FEATURES {
 
   // This variable sets the step_param used in full pel motion search.
   int fullpel_search_step_param;
+
+  // If nonzero, the full pel motion search of a block only refines the
+  // motion vector found by the searches of the blocks containing it or
+  // contained in it, at the other partition levels of the superblock, when at
+  // least this many of them agree on it.
+  int reuse_partition_mvs;
 } MV_SPEED_FEATURES;
 
 typedef struct PARTITION_SEARCH_BREAKOUT_THR {
@@ -302,6 +311,11 @@ typedef struct SPEED_FEATURES {
   // Temporal dependency model based encoding mode optimization
   int enable_tpl_model;
 
+  // Take the full pixel motion vectors of the temporal dependency model from
+  // the hierarchical motion fields of the ME pyramid, leaving only the sub
+  // pixel search per block.
+  int tpl_use_me_pyramid;
+
   // Use transform domain distortion. Use pixel domain distortion in speed 0
   // and certain situations in higher speed to improve the RD model precision.
   int allow_txfm_domain_distortion;
@@ -319,6 +333,11 @@ typedef struct SPEED_FEATURES {
   // How many levels of tx size to search, starting from the largest.
   int tx_size_search_depth;
 
+  // If nonzero, the full rd search of the transform size of inter blocks is
+  // limited to this many sizes, those with the lowest rd cost modeled from
+  // the Hadamard transform of the residual.
+  int tx_size_search_model;
+
   // Low precision 32x32 fdct keeps everything in 16 bits and thus is less
   // precise but significantly faster than the non lp version.
   int use_lp32x32fdct;
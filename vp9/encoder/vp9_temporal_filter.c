@@ -762,6 +762,8 @@ void vp9_temporal_filter_iterate_row_c(VP9_COMP *cpi, ThreadData *td,
             cpi, td, frames[alt_ref_index]->y_buffer + mb_y_offset,
             frames[frame]->y_buffer + mb_y_offset, frames[frame]->y_stride,
             &ref_mv, blk_mvs, blk_bestsme);
+        ME_PYRAMID_FIELD *const exported =
+            arnr_filter_data->exported_fields[frame];
 
         int err16 =
             blk_bestsme[0] + blk_bestsme[1] + blk_bestsme[2] + blk_bestsme[3];
@@ -771,6 +773,13 @@ void vp9_temporal_filter_iterate_row_c(VP9_COMP *cpi, ThreadData *td,
           if (max_err < blk_bestsme[k]) max_err = blk_bestsme[k];
         }
 
+        if (exported != NULL) {
+          const int idx = mb_row * exported->mf.block_cols + mb_col;
+          exported->mf.mf[idx].as_mv = ref_mv;
+          exported->mf.set_mv[idx] = 1;
+          exported->err[idx] = (uint32_t)err;
+        }
+
         if (((err * 15 < (err16 << 4)) && max_err - min_err < 10000) ||
             ((err * 14 < (err16 << 4)) && max_err - min_err < 5000)) {
           use_32x32 = 1;
@@ -1193,6 +1202,22 @@ void vp9_temporal_filter(VP9_COMP *cpi, int distance) {
     }
   }
 
+  // The TPL model of the group starts its search for the reverse motion from
+  // the vectors found here. They are exported for the filtered ARF, which the
+  // model uses in place of the source.
+  memset(arnr_filter_data->exported_fields, 0,
+         sizeof(arnr_filter_data->exported_fields));
+  if (cpi->sf.enable_tpl_model && cpi->sf.tpl_use_me_pyramid &&
+      !cpi->use_svc && cpi->twopass.gf_group.index == 1 &&
+      cpi->twopass.gf_group.update_type[1] == ARF_UPDATE) {
+    vp9_me_pyramid_reset(&cpi->me_pyramid);
+    for (frame = 0; frame < frames_to_blur; ++frame) {
+      if (frame == frames_to_blur_backward || frames[frame] == NULL) continue;
+      arnr_filter_data->exported_fields[frame] = vp9_me_pyramid_export_field(
+          cpi, &cpi->alt_ref_buffer, frames[frame], TF_BLOCK);
+    }
+  }
+
   // Initialize errorperbit and sabperbit.
   rdmult = vp9_compute_rd_mult_based_on_qindex(cpi, ARNR_FILT_QINDEX);
   set_error_per_bit(&cpi->td.mb, rdmult);
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2023 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <emmintrin.h>  // SSE2
+
+#include "./vp9_rtcd.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vp9/encoder/vp9_nn.h"
+
+// Computes 4 nodes at a time, one per lane. Each lane accumulates its products
+// in the same order as vp9_nn_predict_c() and no multiply-add is fused, so the
+// outputs are bit-exact with the C version.
+static void nn_layer_sse2(const float *input, int num_inputs,
+                          const float *weights, const float *bias,
+                          int num_outputs, int relu, float *output) {
+  const __m128 zero = _mm_setzero_ps();
+  int node = 0;
+
+  for (; node + 4 <= num_outputs; node += 4) {
+    const float *const w0 = weights + node * num_inputs;
+    const float *const w1 = w0 + num_inputs;
+    const float *const w2 = w1 + num_inputs;
+    const float *const w3 = w2 + num_inputs;
+    __m128 acc = zero;
+    int i = 0;
+
+    for (; i + 4 <= num_inputs; i += 4) {
+      // Transpose so that each register holds the weights of one input.
+      __m128 r0 = _mm_loadu_ps(w0 + i);
+      __m128 r1 = _mm_loadu_ps(w1 + i);
+      __m128 r2 = _mm_loadu_ps(w2 + i);
+      __m128 r3 = _mm_loadu_ps(w3 + i);
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      acc = _mm_add_ps(acc, _mm_mul_ps(r0, _mm_set1_ps(input[i + 0])));
+      acc = _mm_add_ps(acc, _mm_mul_ps(r1, _mm_set1_ps(input[i + 1])));
+      acc = _mm_add_ps(acc, _mm_mul_ps(r2, _mm_set1_ps(input[i + 2])));
+      acc = _mm_add_ps(acc, _mm_mul_ps(r3, _mm_set1_ps(input[i + 3])));
+    }
+    for (; i < num_inputs; ++i) {
+      const __m128 w = _mm_setr_ps(w0[i], w1[i], w2[i], w3[i]);
+      acc = _mm_add_ps(acc, _mm_mul_ps(w, _mm_set1_ps(input[i])));
+    }
+
+    acc = _mm_add_ps(acc, _mm_loadu_ps(bias + node));
+    if (relu) acc = _mm_max_ps(acc, zero);
+    _mm_storeu_ps(output + node, acc);
+  }
+
+  for (; node < num_outputs; ++node) {
+    const float *const w = weights + node * num_inputs;
+    float val = 0.0f;
+    int i;
+    for (i = 0; i < num_inputs; ++i) val += w[i] * input[i];
+    val += bias[node];
+    if (relu) val = VPXMAX(val, 0.0f);
+    output[node] = val;
+  }
+}
+
+void vp9_nn_predict_sse2(const float *features, const NN_CONFIG *nn_config,
+                         float *output) {
+  float buf[2][NN_MAX_NODES_PER_LAYER];
+  const float *input_nodes = features;
+  int num_input_nodes = nn_config->num_inputs;
+  const int num_layers = nn_config->num_hidden_layers;
+  int layer;
+  assert(num_layers <= NN_MAX_HIDDEN_LAYERS);
+
+  for (layer = 0; layer < num_layers; ++layer) {
+    const int num_output_nodes = nn_config->num_hidden_nodes[layer];
+    float *const output_nodes = buf[layer & 1];
+    assert(num_output_nodes < NN_MAX_NODES_PER_LAYER);
+    nn_layer_sse2(input_nodes, num_input_nodes, nn_config->weights[layer],
+                  nn_config->bias[layer], num_output_nodes, 1, output_nodes);
+    num_input_nodes = num_output_nodes;
+    input_nodes = output_nodes;
+  }
+
+  nn_layer_sse2(input_nodes, num_input_nodes, nn_config->weights[num_layers],
+                nn_config->bias[num_layers], nn_config->num_outputs, 0, output);
+}
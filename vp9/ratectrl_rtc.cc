@@ -19,39 +19,15 @@
 
 namespace libvpx {
 
-std::unique_ptr<VP9RateControlRTC> VP9RateControlRTC::Create(
-    const VP9RateControlRtcConfig &cfg) {
-  std::unique_ptr<VP9RateControlRTC> rc_api(new (std::nothrow)
-                                                VP9RateControlRTC());
-  if (!rc_api) return nullptr;
-  rc_api->cpi_ = static_cast<VP9_COMP *>(vpx_memalign(32, sizeof(*cpi_)));
-  if (!rc_api->cpi_) {
-    rc_api.reset();
-    return nullptr;
-  }
-  vp9_zero(*rc_api->cpi_);
-
-  rc_api->InitRateControl(cfg);
-  if (cfg.aq_mode) {
-    VP9_COMP *const cpi = rc_api->cpi_;
-    cpi->segmentation_map = static_cast<uint8_t *>(
-        vpx_calloc(cpi->common.mi_rows * cpi->common.mi_cols,
-                   sizeof(*cpi->segmentation_map)));
-    if (!cpi->segmentation_map) {
-      rc_api.reset();
-      return nullptr;
-    }
-    cpi->cyclic_refresh =
-        vp9_cyclic_refresh_alloc(cpi->common.mi_rows, cpi->common.mi_cols);
-    cpi->cyclic_refresh->content_mode = 0;
-  }
-  return rc_api;
-}
-
-void VP9RateControlRTC::InitRateControl(const VP9RateControlRtcConfig &rc_cfg) {
-  VP9_COMMON *cm = &cpi_->common;
-  VP9EncoderConfig *oxcf = &cpi_->oxcf;
-  RATE_CONTROL *const rc = &cpi_->rc;
+static void UpdateRateControlConfig(VP9_COMP *cpi,
+                                    const VP9RateControlRtcConfig &rc_cfg);
+
+// The caller initializes the minq tables with vp9_rc_init_minq_luts().
+static void InitRateControlState(VP9_COMP *cpi,
+                                 const VP9RateControlRtcConfig &rc_cfg) {
+  VP9_COMMON *cm = &cpi->common;
+  VP9EncoderConfig *oxcf = &cpi->oxcf;
+  RATE_CONTROL *const rc = &cpi->rc;
   cm->profile = PROFILE_0;
   cm->bit_depth = VPX_BITS_8;
   cm->show_frame = 1;
@@ -65,27 +41,26 @@ void VP9RateControlRTC::InitRateControl(const VP9RateControlRtcConfig &rc_cfg) {
   cm->current_video_frame = 0;
   rc->kf_boost = DEFAULT_KF_BOOST;
 
-  UpdateRateControl(rc_cfg);
+  UpdateRateControlConfig(cpi, rc_cfg);
   vp9_set_mb_mi(cm, cm->width, cm->height);
 
-  cpi_->use_svc = (cpi_->svc.number_spatial_layers > 1 ||
-                   cpi_->svc.number_temporal_layers > 1)
+  cpi->use_svc = (cpi->svc.number_spatial_layers > 1 ||
+                   cpi->svc.number_temporal_layers > 1)
                       ? 1
                       : 0;
 
   rc->rc_1_frame = 0;
   rc->rc_2_frame = 0;
-  vp9_rc_init_minq_luts();
   vp9_rc_init(oxcf, 0, rc);
   rc->constrain_gf_key_freq_onepass_vbr = 0;
-  cpi_->sf.use_nonrd_pick_mode = 1;
+  cpi->sf.use_nonrd_pick_mode = 1;
 }
 
-void VP9RateControlRTC::UpdateRateControl(
-    const VP9RateControlRtcConfig &rc_cfg) {
-  VP9_COMMON *cm = &cpi_->common;
-  VP9EncoderConfig *oxcf = &cpi_->oxcf;
-  RATE_CONTROL *const rc = &cpi_->rc;
+static void UpdateRateControlConfig(VP9_COMP *cpi,
+                                    const VP9RateControlRtcConfig &rc_cfg) {
+  VP9_COMMON *cm = &cpi->common;
+  VP9EncoderConfig *oxcf = &cpi->oxcf;
+  RATE_CONTROL *const rc = &cpi->rc;
 
   cm->width = rc_cfg.width;
   cm->height = rc_cfg.height;
@@ -107,17 +82,17 @@ void VP9RateControlRTC::UpdateRateControl(
   oxcf->temporal_layering_mode = (VP9E_TEMPORAL_LAYERING_MODE)(
       (rc_cfg.ts_number_layers > 1) ? rc_cfg.ts_number_layers : 0);
 
-  cpi_->oxcf.rc_max_intra_bitrate_pct = rc_cfg.max_intra_bitrate_pct;
-  cpi_->oxcf.rc_max_inter_bitrate_pct = rc_cfg.max_inter_bitrate_pct;
-  cpi_->framerate = rc_cfg.framerate;
-  cpi_->svc.number_spatial_layers = rc_cfg.ss_number_layers;
-  cpi_->svc.number_temporal_layers = rc_cfg.ts_number_layers;
+  cpi->oxcf.rc_max_intra_bitrate_pct = rc_cfg.max_intra_bitrate_pct;
+  cpi->oxcf.rc_max_inter_bitrate_pct = rc_cfg.max_inter_bitrate_pct;
+  cpi->framerate = rc_cfg.framerate;
+  cpi->svc.number_spatial_layers = rc_cfg.ss_number_layers;
+  cpi->svc.number_temporal_layers = rc_cfg.ts_number_layers;
   vp9_set_mb_mi(cm, cm->width, cm->height);
-  for (int sl = 0; sl < cpi_->svc.number_spatial_layers; ++sl) {
-    for (int tl = 0; tl < cpi_->svc.number_temporal_layers; ++tl) {
+  for (int sl = 0; sl < cpi->svc.number_spatial_layers; ++sl) {
+    for (int tl = 0; tl < cpi->svc.number_temporal_layers; ++tl) {
       const int layer =
-          LAYER_IDS_TO_IDX(sl, tl, cpi_->svc.number_temporal_layers);
-      LAYER_CONTEXT *lc = &cpi_->svc.layer_context[layer];
+          LAYER_IDS_TO_IDX(sl, tl, cpi->svc.number_temporal_layers);
+      LAYER_CONTEXT *lc = &cpi->svc.layer_context[layer];
       RATE_CONTROL *const lrc = &lc->rc;
       oxcf->layer_target_bitrate[layer] =
           1000 * rc_cfg.layer_target_bitrate[layer];
@@ -129,28 +104,29 @@ void VP9RateControlRTC::UpdateRateControl(
       oxcf->ts_rate_decimator[tl] = rc_cfg.ts_rate_decimator[tl];
     }
   }
-  vp9_set_rc_buffer_sizes(cpi_);
-  vp9_new_framerate(cpi_, cpi_->framerate);
-  if (cpi_->svc.number_temporal_layers > 1 ||
-      cpi_->svc.number_spatial_layers > 1) {
-    if (cm->current_video_frame == 0) vp9_init_layer_context(cpi_);
-    vp9_update_layer_context_change_config(cpi_,
-                                           (int)cpi_->oxcf.target_bandwidth);
+  vp9_set_rc_buffer_sizes(cpi);
+  vp9_new_framerate(cpi, cpi->framerate);
+  if (cpi->svc.number_temporal_layers > 1 ||
+      cpi->svc.number_spatial_layers > 1) {
+    if (cm->current_video_frame == 0) vp9_init_layer_context(cpi);
+    vp9_update_layer_context_change_config(cpi,
+                                           (int)cpi->oxcf.target_bandwidth);
   }
-  vp9_check_reset_rc_flag(cpi_);
+  vp9_check_reset_rc_flag(cpi);
 }
 
-void VP9RateControlRTC::ComputeQP(const VP9FrameParamsQpRTC &frame_params) {
-  VP9_COMMON *const cm = &cpi_->common;
+static void ComputeFrameQP(VP9_COMP *cpi,
+                           const VP9FrameParamsQpRTC &frame_params) {
+  VP9_COMMON *const cm = &cpi->common;
   int width, height;
-  cpi_->svc.spatial_layer_id = frame_params.spatial_layer_id;
-  cpi_->svc.temporal_layer_id = frame_params.temporal_layer_id;
-  if (cpi_->svc.number_spatial_layers > 1) {
-    const int layer = LAYER_IDS_TO_IDX(cpi_->svc.spatial_layer_id,
-                                       cpi_->svc.temporal_layer_id,
-                                       cpi_->svc.number_temporal_layers);
-    LAYER_CONTEXT *lc = &cpi_->svc.layer_context[layer];
-    get_layer_resolution(cpi_->oxcf.width, cpi_->oxcf.height,
+  cpi->svc.spatial_layer_id = frame_params.spatial_layer_id;
+  cpi->svc.temporal_layer_id = frame_params.temporal_layer_id;
+  if (cpi->svc.number_spatial_layers > 1) {
+    const int layer = LAYER_IDS_TO_IDX(cpi->svc.spatial_layer_id,
+                                       cpi->svc.temporal_layer_id,
+                                       cpi->svc.number_temporal_layers);
+    LAYER_CONTEXT *lc = &cpi->svc.layer_context[layer];
+    get_layer_resolution(cpi->oxcf.width, cpi->oxcf.height,
                          lc->scaling_factor_num, lc->scaling_factor_den, &width,
                          &height);
     cm->width = width;
@@ -158,51 +134,107 @@ void VP9RateControlRTC::ComputeQP(const VP9FrameParamsQpRTC &frame_params) {
   }
   vp9_set_mb_mi(cm, cm->width, cm->height);
   cm->frame_type = frame_params.frame_type;
-  cpi_->refresh_golden_frame = (cm->frame_type == KEY_FRAME) ? 1 : 0;
-  cpi_->sf.use_nonrd_pick_mode = 1;
-  if (cpi_->svc.number_spatial_layers == 1 &&
-      cpi_->svc.number_temporal_layers == 1) {
+  cpi->refresh_golden_frame = (cm->frame_type == KEY_FRAME) ? 1 : 0;
+  cpi->sf.use_nonrd_pick_mode = 1;
+  if (cpi->svc.number_spatial_layers == 1 &&
+      cpi->svc.number_temporal_layers == 1) {
     int target = 0;
-    if (cpi_->oxcf.rc_mode == VPX_CBR) {
-      if (cpi_->oxcf.aq_mode == CYCLIC_REFRESH_AQ)
-        vp9_cyclic_refresh_update_parameters(cpi_);
+    if (cpi->oxcf.rc_mode == VPX_CBR) {
+      if (cpi->oxcf.aq_mode == CYCLIC_REFRESH_AQ)
+        vp9_cyclic_refresh_update_parameters(cpi);
       if (frame_is_intra_only(cm))
-        target = vp9_calc_iframe_target_size_one_pass_cbr(cpi_);
+        target = vp9_calc_iframe_target_size_one_pass_cbr(cpi);
       else
-        target = vp9_calc_pframe_target_size_one_pass_cbr(cpi_);
-    } else if (cpi_->oxcf.rc_mode == VPX_VBR) {
+        target = vp9_calc_pframe_target_size_one_pass_cbr(cpi);
+    } else if (cpi->oxcf.rc_mode == VPX_VBR) {
       if (cm->frame_type == KEY_FRAME) {
-        cpi_->rc.this_key_frame_forced = cm->current_video_frame != 0;
-        cpi_->rc.frames_to_key = cpi_->oxcf.key_freq;
+        cpi->rc.this_key_frame_forced = cm->current_video_frame != 0;
+        cpi->rc.frames_to_key = cpi->oxcf.key_freq;
       }
-      vp9_set_gf_update_one_pass_vbr(cpi_);
-      if (cpi_->oxcf.aq_mode == CYCLIC_REFRESH_AQ)
-        vp9_cyclic_refresh_update_parameters(cpi_);
+      vp9_set_gf_update_one_pass_vbr(cpi);
+      if (cpi->oxcf.aq_mode == CYCLIC_REFRESH_AQ)
+        vp9_cyclic_refresh_update_parameters(cpi);
       if (frame_is_intra_only(cm))
-        target = vp9_calc_iframe_target_size_one_pass_vbr(cpi_);
+        target = vp9_calc_iframe_target_size_one_pass_vbr(cpi);
       else
-        target = vp9_calc_pframe_target_size_one_pass_vbr(cpi_);
+        target = vp9_calc_pframe_target_size_one_pass_vbr(cpi);
     }
-    vp9_rc_set_frame_target(cpi_, target);
-    vp9_update_buffer_level_preencode(cpi_);
+    vp9_rc_set_frame_target(cpi, target);
+    vp9_update_buffer_level_preencode(cpi);
   } else {
-    vp9_update_temporal_layer_framerate(cpi_);
-    vp9_restore_layer_context(cpi_);
-    vp9_rc_get_svc_params(cpi_);
+    vp9_update_temporal_layer_framerate(cpi);
+    vp9_restore_layer_context(cpi);
+    vp9_rc_get_svc_params(cpi);
   }
   int bottom_index, top_index;
-  cpi_->common.base_qindex =
-      vp9_rc_pick_q_and_bounds(cpi_, &bottom_index, &top_index);
+  cpi->common.base_qindex =
+      vp9_rc_pick_q_and_bounds(cpi, &bottom_index, &top_index);
+
+  if (cpi->oxcf.aq_mode == CYCLIC_REFRESH_AQ) vp9_cyclic_refresh_setup(cpi);
+}
 
-  if (cpi_->oxcf.aq_mode == CYCLIC_REFRESH_AQ) vp9_cyclic_refresh_setup(cpi_);
+static int PickLoopfilterLevel(VP9_COMP *cpi) {
+  struct loopfilter *const lf = &cpi->common.lf;
+  vp9_pick_filter_level(nullptr, cpi, LPF_PICK_FROM_Q);
+  return lf->filter_level;
+}
+
+static void UpdateAfterEncode(VP9_COMP *cpi, uint64_t encoded_frame_size) {
+  vp9_rc_postencode_update(cpi, encoded_frame_size);
+  if (cpi->svc.number_spatial_layers > 1 ||
+      cpi->svc.number_temporal_layers > 1)
+    vp9_save_layer_context(cpi);
+  cpi->common.current_video_frame++;
+}
+
+
+std::unique_ptr<VP9RateControlRTC> VP9RateControlRTC::Create(
+    const VP9RateControlRtcConfig &cfg) {
+  std::unique_ptr<VP9RateControlRTC> rc_api(new (std::nothrow)
+                                                VP9RateControlRTC());
+  if (!rc_api) return nullptr;
+  rc_api->cpi_ = static_cast<VP9_COMP *>(vpx_memalign(32, sizeof(*cpi_)));
+  if (!rc_api->cpi_) {
+    rc_api.reset();
+    return nullptr;
+  }
+  vp9_zero(*rc_api->cpi_);
+
+  rc_api->InitRateControl(cfg);
+  if (cfg.aq_mode) {
+    VP9_COMP *const cpi = rc_api->cpi_;
+    cpi->segmentation_map = static_cast<uint8_t *>(
+        vpx_calloc(cpi->common.mi_rows * cpi->common.mi_cols,
+                   sizeof(*cpi->segmentation_map)));
+    if (!cpi->segmentation_map) {
+      rc_api.reset();
+      return nullptr;
+    }
+    cpi->cyclic_refresh =
+        vp9_cyclic_refresh_alloc(cpi->common.mi_rows, cpi->common.mi_cols);
+    cpi->cyclic_refresh->content_mode = 0;
+  }
+  return rc_api;
+}
+
+void VP9RateControlRTC::InitRateControl(const VP9RateControlRtcConfig &rc_cfg) {
+  vp9_rc_init_minq_luts();
+  InitRateControlState(cpi_, rc_cfg);
+}
+
+void VP9RateControlRTC::UpdateRateControl(
+    const VP9RateControlRtcConfig &rc_cfg) {
+  UpdateRateControlConfig(cpi_, rc_cfg);
+}
+
+void VP9RateControlRTC::ComputeQP(const VP9FrameParamsQpRTC &frame_params) {
+  ComputeFrameQP(cpi_, frame_params);
 }
 
 int VP9RateControlRTC::GetQP() const { return cpi_->common.base_qindex; }
 
 int VP9RateControlRTC::GetLoopfilterLevel() const {
-  struct loopfilter *const lf = &cpi_->common.lf;
-  vp9_pick_filter_level(nullptr, cpi_, LPF_PICK_FROM_Q);
-  return lf->filter_level;
+  return PickLoopfilterLevel(cpi_);
 }
 
 signed char *VP9RateControlRTC::GetCyclicRefreshMap() const {
@@ -214,11 +246,7 @@ int *VP9RateControlRTC::GetDeltaQ() const {
 }
 
 void VP9RateControlRTC::PostEncodeUpdate(uint64_t encoded_frame_size) {
-  vp9_rc_postencode_update(cpi_, encoded_frame_size);
-  if (cpi_->svc.number_spatial_layers > 1 ||
-      cpi_->svc.number_temporal_layers > 1)
-    vp9_save_layer_context(cpi_);
-  cpi_->common.current_video_frame++;
+  UpdateAfterEncode(cpi_, encoded_frame_size);
 }
 
 }  // namespace libvpx
@@ -263,7 +263,7 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
         "kf_min_dist not supported in auto mode, use 0 "
         "or kf_max_dist instead.");
 
-  RANGE_CHECK(extra_cfg, row_mt, 0, 1);
+  RANGE_CHECK(extra_cfg, row_mt, 0, 2);
   RANGE_CHECK(extra_cfg, motion_vector_unit_test, 0, 2);
   RANGE_CHECK(extra_cfg, enable_auto_alt_ref, 0, MAX_ARF_LAYERS);
   RANGE_CHECK(extra_cfg, cpu_used, -9, 9);
@@ -608,7 +608,9 @@ static vpx_codec_err_t set_encoder_config(
   // The further fix can be done by adding synchronizations after a tile row
   // is encoded. But this will hurt multi-threaded encoder performance. So,
   // it is recommended to use tile-rows=0 while encoding with threads > 1.
-  if (oxcf->max_threads > 1 && oxcf->tile_columns > 0)
+  // Deterministic row-mt applies the same rule for any number of threads.
+  if ((oxcf->max_threads > 1 || extra_cfg->row_mt == 2) &&
+      oxcf->tile_columns > 0)
     oxcf->tile_rows = 0;
   else
     oxcf->tile_rows = extra_cfg->tile_rows;
@@ -1642,6 +1644,46 @@ static vpx_codec_err_t ctrl_set_roi_map(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_INVALID_PARAM;
 }
 
+static vpx_codec_err_t ctrl_set_motion_hints(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_motion_hints_t *const motion_hints =
+      va_arg(args, vpx_motion_hints_t *);
+
+  if (motion_hints) {
+    if (!vp9_set_motion_hints(ctx->cpi, motion_hints->hints,
+                              motion_hints->rows, motion_hints->cols,
+                              motion_hints->trusted))
+      return VPX_CODEC_OK;
+
+    return VPX_CODEC_INVALID_PARAM;
+  }
+  return VPX_CODEC_INVALID_PARAM;
+}
+
+static vpx_codec_err_t ctrl_get_ladder_info(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  vpx_ladder_info_t *const info = va_arg(args, vpx_ladder_info_t *);
+
+  if (info) {
+    if (!vp9_get_ladder_info(ctx->cpi, info)) return VPX_CODEC_OK;
+
+    return VPX_CODEC_INVALID_PARAM;
+  }
+  return VPX_CODEC_INVALID_PARAM;
+}
+
+static vpx_codec_err_t ctrl_set_ladder_info(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  vpx_ladder_info_t *const info = va_arg(args, vpx_ladder_info_t *);
+
+  if (info) {
+    if (!vp9_set_ladder_info(ctx->cpi, info)) return VPX_CODEC_OK;
+
+    return VPX_CODEC_INVALID_PARAM;
+  }
+  return VPX_CODEC_INVALID_PARAM;
+}
+
 static vpx_codec_err_t ctrl_set_active_map(vpx_codec_alg_priv_t *ctx,
                                            va_list args) {
   vpx_active_map_t *const map = va_arg(args, vpx_active_map_t *);
@@ -1960,6 +2002,8 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP8_SET_POSTPROC, ctrl_set_previewpp },
   { VP9E_SET_ROI_MAP, ctrl_set_roi_map },
   { VP8E_SET_ACTIVEMAP, ctrl_set_active_map },
+  { VP9E_SET_MOTION_HINTS, ctrl_set_motion_hints },
+  { VP9E_SET_LADDER_INFO, ctrl_set_ladder_info },
   { VP8E_SET_SCALEMODE, ctrl_set_scale_mode },
   { VP8E_SET_CPUUSED, ctrl_set_cpuused },
   { VP8E_SET_ENABLEAUTOALTREF, ctrl_set_enable_auto_alt_ref },
@@ -2015,6 +2059,7 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP9_GET_REFERENCE, ctrl_get_reference },
   { VP9E_GET_SVC_LAYER_ID, ctrl_get_svc_layer_id },
   { VP9E_GET_ACTIVEMAP, ctrl_get_active_map },
+  { VP9E_GET_LADDER_INFO, ctrl_get_ladder_info },
   { VP9E_GET_LEVEL, ctrl_get_level },
   { VP9E_GET_SVC_REF_FRAME_CONFIG, ctrl_get_svc_ref_frame_config },
 
@@ -80,6 +80,9 @@ vpx_codec_err_t vpx_codec_enc_init_multi_ver(
   else if ((flags & VPX_CODEC_USE_OUTPUT_PARTITION) &&
            !(iface->caps & VPX_CODEC_CAP_OUTPUT_PARTITION))
     res = VPX_CODEC_INCAPABLE;
+  else if ((flags & VPX_CODEC_USE_MR_PIPELINE) &&
+           !(iface->caps & VPX_CODEC_CAP_MR_PIPELINE))
+    res = VPX_CODEC_INCAPABLE;
   else {
     int i;
 #if CONFIG_MULTI_RES_ENCODING
@@ -212,11 +215,15 @@ vpx_codec_err_t vpx_codec_encode(vpx_codec_ctx_t *ctx, const vpx_image_t *img,
        * Encode multi-levels in reverse order. For example,
        * if mr_total_resolutions = 3, first encode level 2,
        * then encode level 1, and finally encode level 0.
+       * With VPX_CODEC_USE_MR_PIPELINE every level gets the one image, the
+       * lower levels are queued and level 0 runs them all.
        */
+      const int img_step =
+          (ctx->init_flags & VPX_CODEC_USE_MR_PIPELINE) ? 0 : 1;
       int i;
 
       ctx += num_enc - 1;
-      if (img) img += num_enc - 1;
+      if (img) img += img_step * (num_enc - 1);
 
       for (i = num_enc - 1; i >= 0; i--) {
         if ((res = ctx->iface->enc.encode(get_alg_priv(ctx), img, pts, duration,
@@ -224,7 +231,7 @@ vpx_codec_err_t vpx_codec_encode(vpx_codec_ctx_t *ctx, const vpx_image_t *img,
           break;
 
         ctx--;
-        if (img) img--;
+        if (img) img -= img_step;
       }
       ctx++;
     }
@@ -568,7 +568,8 @@ enum vp8e_enc_control_id {
 
   /*!\brief Codec control function to set row level multi-threading.
    *
-   * 0 : off, 1 : on
+   * 0 : off, 1 : on, 2 : on, and the bitstream does not depend on the
+   * number of threads (g_threads), including 1
    *
    * Supported in codecs: VP9
    */
@@ -757,6 +758,46 @@ enum vp8e_enc_control_id {
    * Supported in codecs: VP8
    */
   VP8E_SET_RTC_EXTERNAL_RATECTRL,
+
+  /*!\brief Codec control function to pass motion hints to the encoder.
+   *
+   * The hints belong to the frame passed to the next vpx_codec_encode() call
+   * and are used by its motion search, see #vpx_motion_hints_t. Hints set
+   * again before that call replace them, and a NULL hint array drops them.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_MOTION_HINTS,
+
+  /*!\brief Codec control function to get the mode decisions of the last
+   * frame, for the dependent encoders of an encoding ladder.
+   *
+   * The analysis encoder of the ladder encodes the source first. After a
+   * vpx_codec_encode() call that encoded a new shown frame, this control
+   * exports the motion vectors and prediction block sizes of that frame,
+   * see #vpx_ladder_info_t. The hints of a frame that was dropped or shown
+   * from an earlier alt-ref are not available. The caller allocates the
+   * blocks and sets rows and cols to the size of the analysis frame.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_GET_LADDER_INFO,
+
+  /*!\brief Codec control function to pass the mode decisions of the
+   * analysis encoder of an encoding ladder to a dependent encoder.
+   *
+   * The mode decisions belong to the frame passed to the next
+   * vpx_codec_encode() call, which must be the source frame of
+   * VP9E_GET_LADDER_INFO, possibly at another resolution. They are scaled to
+   * the size of the dependent encoder, the motion vectors are used as trusted
+   * motion hints (see VP9E_SET_MOTION_HINTS) and the block sizes limit the
+   * partition search. Golden and alt-ref hints are only meaningful when the
+   * encoders of the ladder share their golden frame structure, and running
+   * them without lag keeps the frames of all encoders aligned.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_LADDER_INFO,
 };
 
 /*!\brief vpx 1-D scaling mode
@@ -834,6 +875,65 @@ typedef struct vpx_active_map {
   unsigned int cols; /**< number of cols */
 } vpx_active_map_t;
 
+/*!\brief  vpx motion hint
+ *
+ * Motion of an 8x8 block relative to one of the reference frames, e.g. taken
+ * from the decoder when transcoding.
+ *
+ */
+typedef struct vpx_motion_hint {
+  int16_t mv_row; /**< Vertical motion in 1/8 pel. */
+  int16_t mv_col; /**< Horizontal motion in 1/8 pel. */
+  /*! Reference frame of the motion: 1 last, 2 golden, 3 altref. 0 means the
+   * block has no hint. */
+  int8_t ref_frame;
+} vpx_motion_hint_t;
+
+/*!\brief  vpx motion hints
+ *
+ * These defines the data structures for the motion hints of a frame
+ *
+ */
+typedef struct vpx_motion_hints {
+  /*! One hint for each 8x8 block, in raster order. */
+  vpx_motion_hint_t *hints;
+  unsigned int rows; /**< Number of rows, (height + 7) / 8 */
+  unsigned int cols; /**< Number of cols, (width + 7) / 8 */
+  /*! 0: the motion search starts from a hint when it matches better than
+   * the predicted motion vectors. 1: the hints are trusted and the motion
+   * search only refines them, or skips full pixel search in real-time mode.
+   */
+  int trusted;
+} vpx_motion_hints_t;
+
+/*!\brief  vpx ladder block
+ *
+ * Mode decision of an 8x8 block, exported by the analysis encoder of an
+ * encoding ladder.
+ *
+ */
+typedef struct vpx_ladder_block {
+  /*! Motion of the block, with ref_frame 0 for intra blocks. */
+  vpx_motion_hint_t motion;
+  uint8_t width;  /**< Width of the prediction block, in pixels */
+  uint8_t height; /**< Height of the prediction block, in pixels */
+} vpx_ladder_block_t;
+
+/*!\brief  vpx ladder info
+ *
+ * These defines the data structures for the mode decisions of a frame of
+ * the analysis encoder of an encoding ladder.
+ *
+ */
+typedef struct vpx_ladder_info {
+  /*! One block for each 8x8 block of the analysis frame, in raster order. */
+  vpx_ladder_block_t *blocks;
+  unsigned int rows;   /**< Number of rows, (height + 7) / 8 */
+  unsigned int cols;   /**< Number of cols, (width + 7) / 8 */
+  unsigned int width;  /**< Width of the analysis frame */
+  unsigned int height; /**< Height of the analysis frame */
+} vpx_ladder_info_t;
+
 /*!\brief  vpx image scaling mode
  *
  * This defines the data structure for image scaling mode
@@ -1085,6 +1185,12 @@ VPX_CTRL_USE_TYPE(VP9E_GET_LAST_QUANTIZER_SVC_LAYERS, int *)
 #define VPX_CTRL_VP9E_GET_LAST_QUANTIZER_SVC_LAYERS
 VPX_CTRL_USE_TYPE(VP8E_SET_RTC_EXTERNAL_RATECTRL, int)
 #define VPX_CTRL_VP8E_SET_RTC_EXTERNAL_RATECTRL
+VPX_CTRL_USE_TYPE(VP9E_SET_MOTION_HINTS, vpx_motion_hints_t *)
+#define VPX_CTRL_VP9E_SET_MOTION_HINTS
+VPX_CTRL_USE_TYPE(VP9E_GET_LADDER_INFO, vpx_ladder_info_t *)
+#define VPX_CTRL_VP9E_GET_LADDER_INFO
+VPX_CTRL_USE_TYPE(VP9E_SET_LADDER_INFO, vpx_ladder_info_t *)
+#define VPX_CTRL_VP9E_SET_LADDER_INFO
 
 /*!\endcond */
 /*! @} - end defgroup vp8_encoder */
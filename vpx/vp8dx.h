@@ -158,6 +158,22 @@ enum vp8_dec_control_id {
    */
   VP9D_SET_LOOP_FILTER_OPT,
 
+  /*!\brief Codec control function to estimate the missing motion vectors of
+   * a lossy frame row by row while it is decoded.
+   *
+   * 0 : off, the vectors are estimated for the whole frame before it is
+   *     decoded.
+   * 1 : on, each macroblock is concealed from the last frame and from the
+   *     macroblocks decoded before it, so that the multithreaded decoder
+   *     conceals its rows in parallel.
+   *
+   * Only used when the decoder is initialized with
+   * VPX_CODEC_USE_ERROR_CONCEALMENT.
+   *
+   * Supported in codecs: VP8
+   */
+  VP8D_SET_ROW_EC,
+
   VP8_DECODER_CTRL_ID_MAX
 };
 
@@ -217,6 +233,8 @@ VPX_CTRL_USE_TYPE(VP9D_SET_ROW_MT, int)
 #define VPX_CTRL_VP9_DECODE_SET_ROW_MT
 VPX_CTRL_USE_TYPE(VP9D_SET_LOOP_FILTER_OPT, int)
 #define VPX_CTRL_VP9_SET_LOOP_FILTER_OPT
+VPX_CTRL_USE_TYPE(VP8D_SET_ROW_EC, int)
+#define VPX_CTRL_VP8D_SET_ROW_EC
 
 /*!\endcond */
 /*! @} - end defgroup vp8_decoder */
@@ -79,6 +79,11 @@ extern "C" {
  */
 #define VPX_CODEC_CAP_OUTPUT_PARTITION 0x20000
 
+/*! Can scale the source of a multi-resolution encoder itself and encode the
+ *  resolutions in parallel, see #VPX_CODEC_USE_MR_PIPELINE.
+ */
+#define VPX_CODEC_CAP_MR_PIPELINE 0x40000
+
 /*! \brief Initialization-time Feature Enabling
  *
  *  Certain codec features must be known at initialization time, to allow
@@ -90,6 +95,15 @@ extern "C" {
 /*!\brief Make the encoder output one  partition at a time. */
 #define VPX_CODEC_USE_OUTPUT_PARTITION 0x20000
 #define VPX_CODEC_USE_HIGHBITDEPTH 0x40000 /**< Use high bitdepth */
+/*!\brief Feed all the resolutions of vpx_codec_enc_init_multi() from one
+ *
+ * vpx_codec_encode() takes a single image of the highest resolution, each
+ * lower resolution is downscaled from the next higher one by the encoder. The
+ * resolutions are encoded in parallel, a lower one passes its mode and motion
+ * hints up as soon as each macroblock row is coded. Requires 8 bit I420 or
+ * YV12 input and g_lag_in_frames == 0.
+ */
+#define VPX_CODEC_USE_MR_PIPELINE 0x80000
 
 /*!\brief Generic fixed size buffer structure
  *
@@ -1002,6 +1016,9 @@ vpx_fixed_buf_t *vpx_codec_get_global_headers(vpx_codec_ctx_t *ctx);
  * any held buffers. Encoding is complete when vpx_codec_encode() is called
  * and vpx_codec_get_cx_data() returns no data.
  *
+ * A multi-resolution encoder takes one image per resolution, highest first,
+ * or only the highest resolution with #VPX_CODEC_USE_MR_PIPELINE.
+ *
  * \param[in]    ctx       Pointer to this instance's context
  * \param[in]    img       Image data to encode, NULL to flush.
  * \param[in]    pts       Presentation time stamp, in timebase units.
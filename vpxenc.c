@@ -42,6 +42,7 @@
 #include "vpx/vpx_integer.h"
 #include "vpx_ports/mem_ops.h"
 #include "vpx_ports/vpx_timer.h"
+#include "vpx_util/vpx_thread.h"
 #include "./rate_hist.h"
 #include "./vpxstats.h"
 #include "./warnings.h"
@@ -161,6 +162,14 @@ static const arg_def_t disable_warnings =
 static const arg_def_t disable_warning_prompt =
     ARG_DEF("y", "disable-warning-prompt", 0,
             "Display warnings, but do not prompt user to continue.");
+static const arg_def_t segment_length =
+    ARG_DEF(NULL, "segment-length", 1,
+            "Encode the input as independent segments of n frames, each "
+            "starting with a key frame");
+#define MAX_SEGMENT_JOBS 64
+static const arg_def_t segment_jobs =
+    ARG_DEF(NULL, "segment-jobs", 1,
+            "Number of segments encoded in parallel (default 1)");
 
 #if CONFIG_VP9_HIGHBITDEPTH
 static const arg_def_t test16bitinternalarg = ARG_DEF(
@@ -190,6 +199,8 @@ static const arg_def_t *main_args[] = { &help,
                                         &rate_hist_n,
                                         &disable_warnings,
                                         &disable_warning_prompt,
+                                        &segment_length,
+                                        &segment_jobs,
                                         &recontest,
                                         NULL };
 
@@ -520,7 +531,8 @@ static const arg_def_t target_level = ARG_DEF(
 
 static const arg_def_t row_mt =
     ARG_DEF(NULL, "row-mt", 1,
-            "Enable row based non-deterministic multi-threading in VP9");
+            "Enable row based multi-threading in VP9 (0: off, 1: on, 2: on "
+            "with output independent of the thread count)");
 
 static const arg_def_t disable_loopfilter =
     ARG_DEF(NULL, "disable-loopfilter", 1,
@@ -804,7 +816,15 @@ static void parse_global_config(struct VpxEncoderConfig *global, char **argv) {
       global->disable_warnings = 1;
     else if (arg_match(&arg, &disable_warning_prompt, argi))
       global->disable_warning_prompt = 1;
-    else
+    else if (arg_match(&arg, &segment_length, argi))
+      global->segment_length = arg_parse_uint(&arg);
+    else if (arg_match(&arg, &segment_jobs, argi)) {
+      global->segment_jobs = arg_parse_uint(&arg);
+
+      if (global->segment_jobs < 1 || global->segment_jobs > MAX_SEGMENT_JOBS)
+        die("Error: Invalid number of segment jobs (%d)\n",
+            global->segment_jobs);
+    } else
       argj++;
   }
 
@@ -835,6 +855,10 @@ static void parse_global_config(struct VpxEncoderConfig *global, char **argv) {
     warn("Enforcing one-pass encoding in realtime mode\n");
     global->passes = 1;
   }
+
+  if (global->segment_jobs == 0) global->segment_jobs = 1;
+  if (global->segment_jobs > 1 && !global->segment_length)
+    warn("option --segment-jobs ignored without --segment-length.\n");
 }
 
 static struct stream_state *new_stream(struct VpxEncoderConfig *global,
@@ -1672,6 +1696,307 @@ static void print_time(const char *label, int64_t etl) {
   }
 }
 
+/* A frame packet produced by a segment encoder, buffered until the segment
+ * can be written to the output in order.
+ */
+struct segment_packet {
+  vpx_codec_pts_t pts;
+  unsigned long duration;
+  vpx_codec_frame_flags_t flags;
+  size_t offset;
+  size_t sz;
+};
+
+/* Per-job state for segmented encoding. Each job owns a private copy of the
+ * stream, including its own encoder instance, and one input reader per pass
+ * so that every pass can read its frames front to back without seeking.
+ */
+struct segment_job {
+  struct stream_state stream;
+  struct VpxEncoderConfig *global;
+  struct VpxInputContext input[2];
+  int frames_read[2];
+  vpx_image_t raw;
+  int start;
+  int end;
+  int frames_encoded;
+  uint8_t *buf;
+  size_t buf_sz;
+  size_t buf_alloc_sz;
+  struct segment_packet *pkts;
+  int num_pkts;
+  int pkts_alloc;
+};
+
+static void buffer_segment_packet(struct segment_job *job,
+                                  const vpx_codec_cx_pkt_t *pkt) {
+  struct segment_packet *out;
+
+  if (job->buf_sz + pkt->data.frame.sz > job->buf_alloc_sz) {
+    size_t new_sz = 2 * job->buf_alloc_sz + pkt->data.frame.sz;
+    uint8_t *new_buf = realloc(job->buf, new_sz);
+    if (!new_buf) fatal("Failed to allocate segment output buffer.");
+    job->buf = new_buf;
+    job->buf_alloc_sz = new_sz;
+  }
+  if (job->num_pkts == job->pkts_alloc) {
+    const int new_alloc = 2 * job->pkts_alloc + 64;
+    struct segment_packet *new_pkts =
+        realloc(job->pkts, new_alloc * sizeof(*new_pkts));
+    if (!new_pkts) fatal("Failed to allocate segment packet list.");
+    job->pkts = new_pkts;
+    job->pkts_alloc = new_alloc;
+  }
+
+  out = &job->pkts[job->num_pkts++];
+  out->pts = pkt->data.frame.pts;
+  out->duration = pkt->data.frame.duration;
+  out->flags = pkt->data.frame.flags;
+  out->offset = job->buf_sz;
+  out->sz = pkt->data.frame.sz;
+  memcpy(job->buf + job->buf_sz, pkt->data.frame.buf, pkt->data.frame.sz);
+  job->buf_sz += pkt->data.frame.sz;
+}
+
+/* Thread-safe counterpart of get_cx_data(): packets are kept in the job
+ * rather than written to the output file.
+ */
+static void get_segment_cx_data(struct segment_job *job, int *got_data) {
+  struct stream_state *const stream = &job->stream;
+  const vpx_codec_cx_pkt_t *pkt;
+  vpx_codec_iter_t iter = NULL;
+
+  *got_data = 0;
+  while ((pkt = vpx_codec_get_cx_data(&stream->encoder, &iter))) {
+    switch (pkt->kind) {
+      case VPX_CODEC_CX_FRAME_PKT:
+        buffer_segment_packet(job, pkt);
+        *got_data = 1;
+        break;
+      case VPX_CODEC_STATS_PKT:
+        stats_write(&stream->stats, pkt->data.twopass_stats.buf,
+                    pkt->data.twopass_stats.sz);
+        *got_data = 1;
+        break;
+      case VPX_CODEC_PSNR_PKT:
+        if (job->global->show_psnr) {
+          int i;
+
+          stream->psnr_sse_total += pkt->data.psnr.sse[0];
+          stream->psnr_samples_total += pkt->data.psnr.samples[0];
+          for (i = 0; i < 4; i++)
+            stream->psnr_totals[i] += pkt->data.psnr.psnr[i];
+          stream->psnr_count++;
+        }
+        break;
+      default: break;
+    }
+  }
+}
+
+/* Runs one pass over the job's current segment. Returns the number of frames
+ * encoded, which is less than the segment length at the end of the input.
+ */
+static int encode_segment_pass(struct segment_job *job, int pass) {
+  struct stream_state *const stream = &job->stream;
+  struct VpxInputContext *const input = &job->input[pass];
+  int *const frames_read = &job->frames_read[pass];
+  int frames = 0;
+  int got_data;
+
+  /* Frames in front of the segment belong to other jobs. */
+  while (*frames_read < job->start) {
+    if (!read_frame(input, &job->raw)) return 0;
+    ++*frames_read;
+  }
+  if (!read_frame(input, &job->raw)) return 0;
+  ++*frames_read;
+
+  setup_pass(stream, job->global, pass);
+  initialize_encoder(stream, job->global);
+
+  for (;;) {
+    encode_frame(stream, job->global, &job->raw, *frames_read);
+    update_quantizer_histogram(stream);
+    get_segment_cx_data(job, &got_data);
+    ++frames;
+    if (*frames_read >= job->end || !read_frame(input, &job->raw)) break;
+    ++*frames_read;
+  }
+
+  do {
+    encode_frame(stream, job->global, NULL, *frames_read);
+    get_segment_cx_data(job, &got_data);
+  } while (got_data);
+
+  vpx_codec_destroy(&stream->encoder);
+  return frames;
+}
+
+static THREADFN encode_segment_worker(void *arg) {
+  struct segment_job *const job = (struct segment_job *)arg;
+  const int passes = job->global->passes;
+  int pass;
+
+  job->num_pkts = 0;
+  job->buf_sz = 0;
+  job->frames_encoded = 0;
+  if (job->start >= job->end) return THREAD_RETURN(NULL);
+
+  for (pass = 0; pass < passes; ++pass) {
+    /* Only the last pass produces frame packets. */
+    job->num_pkts = 0;
+    job->buf_sz = 0;
+    job->frames_encoded = encode_segment_pass(job, pass);
+    if (!job->frames_encoded) break;
+  }
+  if (job->frames_encoded) stats_close(&job->stream.stats, passes - 1);
+  return THREAD_RETURN(NULL);
+}
+
+static void write_segment(struct stream_state *stream,
+                          const struct segment_job *job) {
+  const struct vpx_codec_enc_cfg *const cfg = &stream->config.cfg;
+  int i;
+
+  for (i = 0; i < job->num_pkts; ++i) {
+    const struct segment_packet *const seg_pkt = &job->pkts[i];
+    vpx_codec_cx_pkt_t pkt;
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.kind = VPX_CODEC_CX_FRAME_PKT;
+    pkt.data.frame.buf = job->buf + seg_pkt->offset;
+    pkt.data.frame.sz = seg_pkt->sz;
+    pkt.data.frame.pts = seg_pkt->pts;
+    pkt.data.frame.duration = seg_pkt->duration;
+    pkt.data.frame.flags = seg_pkt->flags;
+    pkt.data.frame.partition_id = -1;
+
+    stream->frames_out++;
+    update_rate_histogram(stream->rate_hist, cfg, &pkt);
+#if CONFIG_WEBM_IO
+    if (stream->config.write_webm) {
+      write_webm_block(&stream->webm_ctx, cfg, &pkt);
+    }
+#endif
+    if (!stream->config.write_webm) {
+      ivf_write_frame_header(stream->file, pkt.data.frame.pts,
+                             pkt.data.frame.sz);
+      (void)fwrite(pkt.data.frame.buf, 1, pkt.data.frame.sz, stream->file);
+    }
+    stream->nbytes += pkt.data.frame.sz;
+  }
+}
+
+/* Encodes the input as consecutive segments of global->segment_length frames
+ * with global->segment_jobs independent encoders running concurrently. Every
+ * segment is a complete one- or two-pass encode that begins with a key frame,
+ * so the segments are concatenated in order into the stream's output file.
+ * Returns the number of input frames read, including skipped frames.
+ */
+static int encode_segments(struct stream_state *stream,
+                           struct VpxEncoderConfig *global,
+                           const struct VpxInputContext *input,
+                           uint64_t *cx_time) {
+  const int num_jobs = global->segment_jobs;
+  const int length = global->segment_length;
+  struct segment_job *jobs = calloc(num_jobs, sizeof(*jobs));
+  struct vpx_usec_timer timer;
+  int segment = 0;
+  int frames = 0;
+  int done = 0;
+  int i, j, pass;
+
+  if (!jobs) fatal("Failed to allocate segment jobs.");
+
+  vpx_usec_timer_start(&timer);
+  for (i = 0; i < num_jobs; ++i) {
+    struct segment_job *const job = &jobs[i];
+
+    job->stream = *stream;
+    job->stream.next = NULL;
+    job->stream.file = NULL;
+    job->stream.img = NULL;
+    job->stream.config.stats_fn = NULL;
+    job->global = global;
+    for (pass = 0; pass < global->passes; ++pass) {
+      job->input[pass] = *input;
+      open_input_file(&job->input[pass]);
+    }
+    // The Y4M reader does its own allocation.
+    if (input->file_type != FILE_TYPE_Y4M)
+      vpx_img_alloc(&job->raw, input->fmt, input->width, input->height, 32);
+  }
+
+  while (!done) {
+#if CONFIG_MULTITHREAD
+    pthread_t threads[MAX_SEGMENT_JOBS];
+#endif
+
+    for (i = 0; i < num_jobs; ++i) {
+      struct segment_job *const job = &jobs[i];
+
+      job->start = global->skip_frames + (segment + i) * length;
+      job->end = job->start + length;
+      if (global->limit && job->end > global->limit) job->end = global->limit;
+    }
+
+#if CONFIG_MULTITHREAD
+    for (i = 0; i < num_jobs; ++i) {
+      if (pthread_create(&threads[i], NULL, encode_segment_worker, &jobs[i]))
+        fatal("Failed to create segment encoding thread.");
+    }
+    for (i = 0; i < num_jobs; ++i) pthread_join(threads[i], NULL);
+#else
+    for (i = 0; i < num_jobs; ++i) encode_segment_worker(&jobs[i]);
+#endif
+
+    for (i = 0; i < num_jobs && !done; ++i) {
+      const struct segment_job *const job = &jobs[i];
+
+      write_segment(stream, job);
+      frames += job->frames_encoded;
+      done = job->frames_encoded < length || job->end == global->limit;
+    }
+    segment += num_jobs;
+
+    vpx_usec_timer_mark(&timer);
+    *cx_time = vpx_usec_timer_elapsed(&timer);
+    if (!global->quiet) {
+      const float fps = usec_to_fps(*cx_time, frames);
+      fprintf(stderr,
+              "\rSegment %4d frame %4d/%-4d %7" PRId64 "B %7" PRId64
+              " %s %.2f %s \033[K",
+              segment, frames, stream->frames_out, (int64_t)stream->nbytes,
+              *cx_time > 9999999 ? *cx_time / 1000 : *cx_time,
+              *cx_time > 9999999 ? "ms" : "us", fps >= 1.0 ? fps : fps * 60,
+              fps >= 1.0 ? "fps" : "fpm");
+    }
+  }
+
+  for (i = 0; i < num_jobs; ++i) {
+    struct segment_job *const job = &jobs[i];
+
+    stream->psnr_sse_total += job->stream.psnr_sse_total;
+    stream->psnr_samples_total += job->stream.psnr_samples_total;
+    for (j = 0; j < 4; ++j)
+      stream->psnr_totals[j] += job->stream.psnr_totals[j];
+    stream->psnr_count += job->stream.psnr_count;
+    for (j = 0; j < 64; ++j) stream->counts[j] += job->stream.counts[j];
+
+    for (pass = 0; pass < global->passes; ++pass)
+      close_input_file(&job->input[pass]);
+    if (job->stream.img) vpx_img_free(job->stream.img);
+    vpx_img_free(&job->raw);
+    free(job->buf);
+    free(job->pkts);
+  }
+  free(jobs);
+
+  stream->cx_time = *cx_time;
+  return global->skip_frames + frames;
+}
+
 int main(int argc, const char **argv_) {
   int pass;
   vpx_image_t raw;
@@ -1756,6 +2081,29 @@ int main(int argc, const char **argv_) {
   /* Decide if other chroma subsamplings than 4:2:0 are supported */
   if (global.codec->fourcc == VP9_FOURCC) input.only_i420 = 0;
 
+  if (global.segment_length) {
+    /* Segments are encoded by independent encoders that each read the input
+     * file on their own, and their output is concatenated by this thread.
+     */
+    if (stream_cnt > 1)
+      die("Error: --segment-length supports a single output stream\n");
+    if (global.pass)
+      die("Error: --segment-length cannot be combined with --pass\n");
+    if (streams->config.stats_fn)
+      die("Error: --segment-length cannot be combined with --fpf\n");
+    if (global.out_part)
+      die("Error: --segment-length cannot be combined with -P\n");
+    if (global.test_decode != TEST_DECODE_OFF)
+      die("Error: --segment-length cannot be combined with --test-decode\n");
+    if (!strcmp(input.filename, "-"))
+      die("Error: --segment-length requires a named input file\n");
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (streams->config.use_16bit_internal)
+      die("Error: --segment-length does not support 16 bit internal "
+          "buffers\n");
+#endif
+  }
+
   for (pass = global.pass ? global.pass - 1 : 0; pass < global.passes; pass++) {
     int frames_in = 0, seen_frames = 0;
     int64_t estimated_time_left = -1;
@@ -1850,10 +2198,17 @@ int main(int argc, const char **argv_) {
                          &stream->config.cfg, &global.framerate));
     }
 
-    FOREACH_STREAM(setup_pass(stream, &global, pass));
+    if (global.segment_length) {
+      /* All passes run inside the segment encoders. */
+      streams->config.cfg.g_pass =
+          global.passes == 2 ? VPX_RC_LAST_PASS : VPX_RC_ONE_PASS;
+    } else {
+      FOREACH_STREAM(setup_pass(stream, &global, pass));
+    }
     FOREACH_STREAM(
         open_output_file(stream, &global, &input.pixel_aspect_ratio));
-    FOREACH_STREAM(initialize_encoder(stream, &global));
+    if (!global.segment_length)
+      FOREACH_STREAM(initialize_encoder(stream, &global));
 
 #if CONFIG_VP9_HIGHBITDEPTH
     if (strcmp(global.codec->name, "vp9") == 0) {
@@ -1874,7 +2229,15 @@ int main(int argc, const char **argv_) {
     }
 #endif
 
-    frame_avail = 1;
+    if (global.segment_length) {
+      frames_in = encode_segments(streams, &global, &input, &cx_time);
+      seen_frames =
+          frames_in > global.skip_frames ? frames_in - global.skip_frames : 0;
+      frame_avail = 0;
+      if (!global.quiet) fprintf(stderr, "\n");
+    } else {
+      frame_avail = 1;
+    }
     got_data = 0;
 
     while (frame_avail || got_data) {
@@ -1995,7 +2358,8 @@ int main(int argc, const char **argv_) {
           stderr,
           "\rPass %d/%d frame %4d/%-4d %7" PRId64 "B %7" PRId64 "b/f %7" PRId64
           "b/s %7" PRId64 " %s (%.2f fps)\033[K\n",
-          pass + 1, global.passes, frames_in, stream->frames_out,
+          global.segment_length ? global.passes : pass + 1, global.passes,
+          frames_in, stream->frames_out,
           (int64_t)stream->nbytes,
           seen_frames ? (int64_t)(stream->nbytes * 8 / seen_frames) : 0,
           seen_frames
@@ -2016,7 +2380,8 @@ int main(int argc, const char **argv_) {
       }
     }
 
-    FOREACH_STREAM(vpx_codec_destroy(&stream->encoder));
+    if (!global.segment_length)
+      FOREACH_STREAM(vpx_codec_destroy(&stream->encoder));
 
     if (global.test_decode != TEST_DECODE_OFF) {
       FOREACH_STREAM(vpx_codec_destroy(&stream->decoder));
@@ -2031,7 +2396,7 @@ int main(int argc, const char **argv_) {
 
     FOREACH_STREAM(stats_close(&stream->stats, global.passes - 1));
 
-    if (global.pass) break;
+    if (global.pass || global.segment_length) break;
   }
 
   if (global.show_q_hist_buckets)
@@ -56,6 +56,8 @@ struct VpxEncoderConfig {
   int disable_warnings;
   int disable_warning_prompt;
   int experimental_bitstream;
+  int segment_length;
+  int segment_jobs;
 };
 
 #ifdef __cplusplus